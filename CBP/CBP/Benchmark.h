@@ -0,0 +1,46 @@
+#pragma once
+
+namespace CBP
+{
+    // input generation shared by the benchmarks and self tests, identical on every run
+    class BenchmarkRandom
+    {
+    public:
+
+        explicit BenchmarkRandom(std::uint32_t a_seed) :
+            m_seed(a_seed)
+        {
+        }
+
+        // [0, 1)
+        SKMP_FORCEINLINE float Unit()
+        {
+            m_seed = m_seed * 1664525U + 1013904223U;
+            return static_cast<float>(m_seed >> 8) / 16777216.0f;
+        }
+
+        // [-1, 1)
+        SKMP_FORCEINLINE float Signed()
+        {
+            return Unit() * 2.0f - 1.0f;
+        }
+
+    private:
+
+        std::uint32_t m_seed;
+    };
+
+    // rounds up to a non-zero multiple of a_multiple (SIMD width or chunk size)
+    SKMP_FORCEINLINE std::size_t BenchmarkCount(std::uint32_t a_count, std::size_t a_multiple)
+    {
+        return std::max<std::size_t>((static_cast<std::size_t>(a_count) + a_multiple - 1) / a_multiple, 1) * a_multiple;
+    }
+
+    // keeps the compiler from dropping the timed loops
+    template <class T>
+    SKMP_FORCEINLINE void BenchmarkSink(T a_value)
+    {
+        volatile T result = a_value;
+        (void)result;
+    }
+}
@@ -17,8 +17,11 @@ namespace CBP
 {
     IBoneCast IBoneCast::m_Instance;
 
+    std::shared_ptr<const BoneCastPack> IBoneCastIO::m_pack;
+    std::mutex IBoneCastIO::m_packLock;
+
     IBoneCast::IBoneCast() :
-        m_cache(m_iio, 1024 * 1024 * 64)
+        m_cache(m_iio, m_store, 1024 * 1024 * 64)
     {
     }
 
@@ -796,16 +799,221 @@ namespace CBP
         
     }
 
+    void IBoneCast::HashGeometry(const ColliderDataStorage& a_data, std::string& a_out)
+    {
+        boost::uuids::detail::sha1 sha1;
+
+        for (unsigned int i = 0; i < a_data.m_numVertices; i++) {
+            sha1.process_bytes(a_data.m_vertices[i].v.m_floats, sizeof(float) * 3);
+        }
+
+        sha1.process_bytes(a_data.m_weights.data(), a_data.m_weights.size() * sizeof(float));
+        sha1.process_bytes(a_data.m_indices.data(), a_data.m_indices.size() * sizeof(unsigned int));
+        sha1.process_bytes(std::addressof(a_data.m_numTriangles), sizeof(a_data.m_numTriangles));
+
+        std::uint32_t hash[5]{ 0 };
+        sha1.get_digest(hash);
+
+        char buf[41];
+
+        _snprintf_s(buf, _TRUNCATE, "%.8X%.8X%.8X%.8X%.8X", hash[0], hash[1], hash[2], hash[3], hash[4]);
+
+        a_out = buf;
+    }
+
+    void BoneCastContentStore::ShareVertices(ColliderDataStorage& a_data)
+    {
+        if (!a_data.m_vertices)
+            return;
+
+        if (a_data.m_contentHash.empty())
+            IBoneCast::HashGeometry(a_data, a_data.m_contentHash);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto& entry = m_data.try_emplace(a_data.m_contentHash).first->second;
+
+        if (auto vertices = entry.vertices.lock())
+        {
+            if (vertices != a_data.m_vertices)
+            {
+                a_data.m_vertices = std::move(vertices);
+                m_sharedVertices++;
+            }
+        }
+        else
+        {
+            entry.vertices = a_data.m_vertices;
+        }
+
+        PruneExpired();
+    }
+
+    auto BoneCastContentStore::FindProcessed(
+        const std::string& a_hash,
+        float a_weightThreshold,
+        float a_simplifyTarget,
+        float a_simplifyTargetError)
+        -> std::shared_ptr<const ColliderData>
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto it = m_data.find(a_hash);
+        if (it == m_data.end())
+            return {};
+
+        for (auto& e : it->second.processed)
+        {
+            if (e.weightThreshold == a_weightThreshold &&
+                e.simplifyTarget == a_simplifyTarget &&
+                e.simplifyTargetError == a_simplifyTargetError)
+            {
+                auto data = e.data.lock();
+                if (data)
+                    m_sharedProcessed++;
+
+                return data;
+            }
+        }
+
+        return {};
+    }
+
+    void BoneCastContentStore::AddProcessed(
+        const std::string& a_hash,
+        float a_weightThreshold,
+        float a_simplifyTarget,
+        float a_simplifyTargetError,
+        const std::shared_ptr<const ColliderData>& a_data)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto& processed = m_data.try_emplace(a_hash).first->second.processed;
+
+        for (auto& e : processed)
+        {
+            if (e.weightThreshold == a_weightThreshold &&
+                e.simplifyTarget == a_simplifyTarget &&
+                e.simplifyTargetError == a_simplifyTargetError)
+            {
+                e.data = a_data;
+                return;
+            }
+        }
+
+        processed.emplace_back(processed_t{
+            a_weightThreshold,
+            a_simplifyTarget,
+            a_simplifyTargetError,
+            a_data });
+    }
+
+    auto BoneCastContentStore::GetStats() -> stats_t
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return stats_t{ m_sharedVertices, m_sharedProcessed, m_data.size() };
+    }
+
+    void BoneCastContentStore::PruneExpired()
+    {
+        // amortized, only sweeps once the map has doubled since the last pass
+        if (m_data.size() < m_pruneThreshold)
+            return;
+
+        for (auto it = m_data.begin(); it != m_data.end();)
+        {
+            auto& processed = it->second.processed;
+
+            processed.erase(std::remove_if(processed.begin(), processed.end(),
+                [](auto& a_e) { return a_e.data.expired(); }), processed.end());
+
+            if (it->second.vertices.expired() && processed.empty())
+                it = m_data.erase(it);
+            else
+                ++it;
+        }
+
+        m_pruneThreshold = std::max(m_data.size() * 2, MIN_PRUNE_THRESHOLD);
+    }
+
+    bool IBoneCast::UpdateGeometryShared(
+        ColliderDataStoragePair& a_in,
+        float a_weightThreshold,
+        float a_simplifyTarget,
+        float a_simplifyTargetError)
+    {
+        auto& store = m_Instance.m_store;
+
+        store.ShareVertices(a_in.first);
+
+        auto& hash = a_in.first.m_contentHash;
+
+        if (auto data = store.FindProcessed(hash, a_weightThreshold, a_simplifyTarget, a_simplifyTargetError))
+        {
+            a_in.SetVerticesShared(data->m_vertices == a_in.first.m_vertices);
+            a_in.second = std::move(data);
+
+            return true;
+        }
+
+        if (!UpdateGeometry(a_in, a_weightThreshold, a_simplifyTarget, a_simplifyTargetError))
+            return false;
+
+        store.AddProcessed(hash, a_weightThreshold, a_simplifyTarget, a_simplifyTargetError, a_in.second);
+
+        return true;
+    }
+
     BoneCastCache::BoneCastCache(
         IBoneCastIO& a_iio,
+        BoneCastContentStore& a_store,
         std::size_t a_maxSize)
         :
         m_maxSize(a_maxSize),
         m_totalSize(0),
-        m_iio(a_iio)
+        m_iio(a_iio),
+        m_store(a_store)
     {
     }
 
+    void BoneCastCache::LinkFront(CacheEntry& a_entry)
+    {
+        a_entry.m_prev = nullptr;
+        a_entry.m_next = m_head;
+
+        if (m_head)
+            m_head->m_prev = std::addressof(a_entry);
+        else
+            m_tail = std::addressof(a_entry);
+
+        m_head = std::addressof(a_entry);
+    }
+
+    void BoneCastCache::Unlink(CacheEntry& a_entry)
+    {
+        if (a_entry.m_prev)
+            a_entry.m_prev->m_next = a_entry.m_next;
+        else
+            m_head = a_entry.m_next;
+
+        if (a_entry.m_next)
+            a_entry.m_next->m_prev = a_entry.m_prev;
+        else
+            m_tail = a_entry.m_prev;
+
+        a_entry.m_prev = nullptr;
+        a_entry.m_next = nullptr;
+    }
+
+    void BoneCastCache::Touch(CacheEntry& a_entry)
+    {
+        if (m_head == std::addressof(a_entry))
+            return;
+
+        Unlink(a_entry);
+        LinkFront(a_entry);
+    }
+
     template <class T, BoneCastCache::is_data_type<T>>
     auto BoneCastCache::Add(
         Game::VMHandle a_handle,
@@ -814,31 +1022,94 @@ namespace CBP
     {
         EvictOverflow();
 
+        m_store.ShareVertices(a_data.first);
+
         auto key = std::make_pair(a_handle, a_nodeName);
 
         iterator it = m_data.find(key);
 
         if (it != m_data.end()) {
-            m_totalSize -= it->second.m_size;
+            Uncharge(it->second);
             it->second.m_data = std::forward<T>(a_data);
-            it->second.m_lastAccess = IPerfCounter::Query();
+            Touch(it->second);
         }
         else {
             it = m_data.try_emplace(std::move(key), std::forward<T>(a_data)).first;
+            it->second.m_key = std::addressof(it->first);
+            LinkFront(it->second);
         }
 
-        it->second.m_size = it->second.m_data.UpdateSize();
-
-        m_totalSize += it->second.m_size;
+        Charge(it->second);
 
         return it;
     }
 
     void BoneCastCache::UpdateSize(CacheEntry& a_in)
     {
-        m_totalSize -= a_in.m_size;
-        a_in.m_size = a_in.m_data.UpdateSize();
-        m_totalSize += a_in.m_size;
+        // the old blocks are either still referenced elsewhere or released before a new one could reuse their address
+        Uncharge(a_in);
+        Charge(a_in);
+    }
+
+    std::size_t BoneCastCache::AcquireShared(const void* a_block, std::size_t a_size)
+    {
+        if (!a_block)
+            return 0;
+
+        auto& e = m_shared.try_emplace(a_block, sharedBlock_t{ 0, a_size }).first->second;
+
+        return e.refs++ == 0 ? e.size : 0;
+    }
+
+    std::size_t BoneCastCache::ReleaseShared(const void* a_block)
+    {
+        if (!a_block)
+            return 0;
+
+        auto it = m_shared.find(a_block);
+        if (it == m_shared.end())
+            return 0;
+
+        if (--it->second.refs > 0)
+            return 0;
+
+        auto size = it->second.size;
+        m_shared.erase(it);
+
+        return size;
+    }
+
+    void BoneCastCache::Charge(CacheEntry& a_entry)
+    {
+        auto& data = a_entry.m_data;
+
+        data.UpdateSize();
+
+        std::size_t vertexSize = data.first.m_numVertices * sizeof(MeshPoint);
+
+        a_entry.m_size = sizeof(ColliderDataStoragePair) + data.first.GetSize() - vertexSize;
+        a_entry.m_chargedVertices = data.first.m_vertices.get();
+        a_entry.m_chargedData = data.second.get();
+
+        m_totalSize += a_entry.m_size;
+        m_totalSize += AcquireShared(a_entry.m_chargedVertices, vertexSize);
+        m_totalSize += AcquireShared(a_entry.m_chargedData, data.second->GetSize(data.HasSharedVertices()));
+    }
+
+    std::size_t BoneCastCache::Uncharge(CacheEntry& a_entry)
+    {
+        auto size =
+            a_entry.m_size +
+            ReleaseShared(a_entry.m_chargedVertices) +
+            ReleaseShared(a_entry.m_chargedData);
+
+        a_entry.m_size = 0;
+        a_entry.m_chargedVertices = nullptr;
+        a_entry.m_chargedData = nullptr;
+
+        m_totalSize -= size;
+
+        return size;
     }
 
     bool BoneCastCache::Remove(
@@ -858,21 +1129,26 @@ namespace CBP
     void BoneCastCache::Remove(
         const T& a_it)
     {
-        std::size_t size = a_it->second.m_size;
+        auto& entry = const_cast<CacheEntry&>(a_it->second);
+
+        Uncharge(entry);
+        Unlink(entry);
         m_data.erase(a_it);
-        m_totalSize -= size;
     }
 
     void BoneCastCache::EvictOverflow()
     {
         while (m_data.size() > 1 && m_totalSize > m_maxSize)
         {
-            auto it = std::min_element(m_data.begin(), m_data.end(),
-                [](auto& a, auto& b) {
-                    return a.second.m_lastAccess < b.second.m_lastAccess;
-                });
+            auto entry = m_tail;
+
+            m_stats.evictions++;
+            m_stats.evictedBytes += Uncharge(*entry);
+
+            Unlink(*entry);
 
-            Remove(it);
+            // not erase(key), the key lives in the node being destroyed
+            m_data.erase(m_data.find(*entry->m_key));
         }
     }
 
@@ -883,14 +1159,24 @@ namespace CBP
         bool a_read,
         T& a_result)
     {
+        constexpr bool peek = std::is_same_v<T, const_iterator>;
+
         auto it = m_data.find(std::make_pair(a_handle, a_nodeName));
         if (it != m_data.end())
         {
-            it->second.m_lastAccess = IPerfCounter::Query();
+            if constexpr (!peek)
+            {
+                m_stats.hits++;
+                Touch(it->second);
+            }
+
             a_result = std::move(it);
             return true;
         }
 
+        if constexpr (!peek)
+            m_stats.misses++;
+
         if (!a_read)
             return false;
 
@@ -956,7 +1242,7 @@ namespace CBP
 
         if (a_result->second.m_data != a_nodeConfig) {
 
-            bool res = UpdateGeometry(
+            bool res = UpdateGeometryShared(
                 a_result->second.m_data,
                 a_nodeConfig.fp.f32.bcWeightThreshold,
                 a_nodeConfig.fp.f32.bcSimplifyTarget,
@@ -1037,6 +1323,11 @@ namespace CBP
             }
         }
 
+        auto key = std::make_pair(a_handle, a_nodeName);
+
+        m_Instance.m_pending.erase(key);
+        m_Instance.m_failed.erase(key);
+
         auto& cache = GetCache();
         auto r = cache.Add(a_handle, a_nodeName, std::move(cacheEntry));
 
@@ -1057,6 +1348,261 @@ namespace CBP
         return true;
     }
 
+    void IBoneCast::StartWorkers(std::uint32_t a_numThreads)
+    {
+        auto& inst = m_Instance;
+
+        if (!inst.m_workers.empty())
+            return;
+
+        auto numThreads = std::min(a_numThreads, MAX_WORKERS);
+        if (!numThreads)
+            return;
+
+        inst.m_shutdown = false;
+
+        for (std::uint32_t i = 0; i < numThreads; i++) {
+            inst.m_workers.emplace_back(&IBoneCast::WorkerProc, std::addressof(inst));
+        }
+
+        inst.Message("%u bonecast worker thread(s)", numThreads);
+    }
+
+    void IBoneCast::StopWorkers()
+    {
+        auto& inst = m_Instance;
+
+        if (inst.m_workers.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(inst.m_mutex);
+            inst.m_shutdown = true;
+        }
+
+        inst.m_cond.notify_all();
+
+        for (auto& e : inst.m_workers)
+            e.join();
+
+        inst.m_workers.clear();
+
+        inst.m_queue.clear();
+        inst.m_completed.clear();
+        inst.m_pending.clear();
+        inst.m_numPending.store(0, std::memory_order_relaxed);
+    }
+
+    bool IBoneCast::Queue(
+        Game::VMHandle a_handle,
+        const stl::fixed_string& a_nodeName,
+        const configNode_t& a_nodeConfig,
+        const ColliderDataStorage* a_source)
+    {
+        auto& inst = m_Instance;
+
+        auto key = std::make_pair(a_handle, a_nodeName);
+
+        if (inst.m_failed.contains(key))
+            return false;
+
+        if (inst.m_pending.contains(key))
+            return true;
+
+        auto job = std::make_unique<asyncJob_t>();
+
+        job->key = key;
+        job->serial = ++inst.m_serial;
+        job->weightThreshold = a_nodeConfig.fp.f32.bcWeightThreshold;
+        job->simplifyTarget = a_nodeConfig.fp.f32.bcSimplifyTarget;
+        job->simplifyTargetError = a_nodeConfig.fp.f32.bcSimplifyTargetError;
+        job->hasSource = a_source != nullptr;
+        job->read = false;
+        job->updated = false;
+
+        if (a_source)
+            job->data.first = *a_source;
+
+        job->data = a_nodeConfig;
+
+        inst.m_pending.emplace(std::move(key), job->serial);
+        inst.m_numPending.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(inst.m_mutex);
+            inst.m_queue.emplace_back(std::move(job));
+        }
+
+        inst.m_cond.notify_one();
+
+        return true;
+    }
+
+    bool IBoneCast::IsPending(
+        Game::VMHandle a_handle,
+        const stl::fixed_string& a_nodeName)
+    {
+        return m_Instance.m_pending.contains(std::make_pair(a_handle, a_nodeName));
+    }
+
+    std::size_t IBoneCast::ProcessCompleted(std::vector<Game::VMHandle>& a_out)
+    {
+        auto& inst = m_Instance;
+
+        decltype(inst.m_completed) completed;
+
+        {
+            std::lock_guard<std::mutex> lock(inst.m_mutex);
+
+            if (inst.m_completed.empty())
+                return 0;
+
+            completed.swap(inst.m_completed);
+        }
+
+        auto& cache = GetCache();
+
+        for (auto& e : completed)
+        {
+            inst.m_numPending.fetch_sub(1, std::memory_order_relaxed);
+
+            auto it = inst.m_pending.find(e->key);
+            if (it == inst.m_pending.end() || it->second != e->serial)
+                continue;
+
+            inst.m_pending.erase(it);
+
+            if (e->read)
+            {
+                if (!e->updated) {
+                    e->data.second = std::make_unique<ColliderData>();
+                }
+
+                auto r = cache.Add(e->key.first, e->key.second, std::move(e->data));
+                r->second.m_updateID.Update();
+            }
+            else
+            {
+                inst.m_failed.emplace(e->key);
+            }
+
+            a_out.emplace_back(e->key.first);
+        }
+
+        cache.EvictOverflow();
+
+        return completed.size();
+    }
+
+    void IBoneCast::WorkerProc()
+    {
+        // own instance, m_lastException isn't shared
+        IBoneCastIO iio;
+
+        for (;;)
+        {
+            std::unique_ptr<asyncJob_t> job;
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+
+                m_cond.wait(lock, [&] {
+                    return m_shutdown || !m_queue.empty();
+                });
+
+                if (m_shutdown)
+                    return;
+
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            RunJob(iio, *job);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.emplace_back(std::move(job));
+        }
+    }
+
+    void IBoneCast::RunJob(IBoneCastIO& a_iio, asyncJob_t& a_job)
+    {
+        if (!a_job.hasSource)
+        {
+            if (!a_iio.Read(a_job.key.first, a_job.key.second, a_job.data))
+            {
+                a_iio.Error("%s: [%.8X] read failed [%s]: %s",
+                    __FUNCTION__,
+                    a_job.key.first.GetFormID().get(),
+                    a_job.key.second.c_str(),
+                    a_iio.GetLastException().what());
+
+                return;
+            }
+        }
+
+        a_job.read = true;
+        a_job.updated = UpdateGeometryShared(
+            a_job.data,
+            a_job.weightThreshold,
+            a_job.simplifyTarget,
+            a_job.simplifyTargetError);
+    }
+
+    bool IBoneCast::BuildPack(boneCastPackResult_t& a_out)
+    {
+        Release();
+
+        return m_Instance.m_iio.BuildPack(a_out);
+    }
+
+    void IBoneCastIO::ReadArchive(
+        const fs::path& a_path,
+        ColliderDataStoragePair& a_out)
+    {
+        std::ifstream ifs;
+
+        ifs.open(a_path, std::ifstream::in | std::ifstream::binary);
+        if (!ifs.is_open())
+            throw std::system_error(errno, std::system_category(), a_path.string());
+
+        switch (BoneCastContainer::Probe(ifs))
+        {
+        case BoneCastContainer::Type::Geometry:
+            BoneCastContainer::Read(ifs, a_out.first);
+            a_out.UpdateSize();
+            return;
+        case BoneCastContainer::Type::Reference:
+        {
+            std::string hash;
+            BoneCastContainer::ReadReference(ifs, hash);
+
+            ifs.close();
+
+            auto contentPath = a_path.parent_path() / CONTENT_DIR / hash;
+
+            ifs.open(contentPath, std::ifstream::in | std::ifstream::binary);
+            if (!ifs.is_open())
+                throw std::system_error(errno, std::system_category(), contentPath.string());
+
+            BoneCastContainer::Read(ifs, a_out.first);
+            a_out.first.m_contentHash = std::move(hash);
+            a_out.UpdateSize();
+        }
+        return;
+        }
+
+        using namespace boost::iostreams;
+        using namespace boost::archive;
+
+        filtering_streambuf<input> in;
+        in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 256));
+        in.push(ifs);
+
+        binary_iarchive ia(in);
+
+        ia >> a_out;
+    }
+
     bool IBoneCastIO::Read(
         Game::VMHandle a_handle,
         const stl::fixed_string& a_nodeName,
@@ -1071,22 +1617,19 @@ namespace CBP
 
             auto path = driverConf.paths.boneCastData / key;
 
-            std::ifstream ifs;
-
-            ifs.open(path, std::ifstream::in | std::ifstream::binary);
-            if (!ifs.is_open())
-                throw std::system_error(errno, std::system_category(), path.string());
-
-            using namespace boost::iostreams;
-            using namespace boost::archive;
-
-            filtering_streambuf<input> in;
-            in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 256));
-            in.push(ifs);
+            if (auto pack = GetPack())
+            {
+                std::error_code ec;
+                auto sourceTime = fs::last_write_time(path, ec).time_since_epoch().count();
 
-            binary_iarchive ia(in);
+                if (pack->Find(key, ec ? nullptr : std::addressof(sourceTime), a_out.first))
+                {
+                    a_out.UpdateSize();
+                    return true;
+                }
+            }
 
-            ia >> a_out;
+            ReadArchive(path, a_out);
 
             return true;
         }
@@ -1097,59 +1640,344 @@ namespace CBP
         }
     }
 
-    bool IBoneCastIO::Write(
-        Game::VMHandle a_handle,
-        const stl::fixed_string& a_nodeName,
-        const ColliderDataStoragePair& a_in)
+    bool IBoneCastIO::RunCodecBenchmark(std::vector<boneCastCodecBenchmark_t>& a_out)
     {
+        a_out.clear();
+
         try
         {
-            auto& driverConf = DCBP::GetDriverConfig();
+            auto& dir = DCBP::GetDriverConfig().paths.boneCastData;
 
-            std::string key;
-            MakeKey(a_handle, a_nodeName, key);
+            std::vector<ColliderDataStoragePair> samples;
+            std::unordered_set<std::string> seen;
+            std::uint64_t rawBytes(0);
 
-            auto path = driverConf.paths.boneCastData / key;
+            for (auto& e : fs::directory_iterator(dir))
+            {
+                if (!e.is_regular_file() || e.path().has_extension())
+                    continue;
 
-            Serialization::CreateRootPath(path);
+                try
+                {
+                    auto& data = samples.emplace_back();
+                    ReadArchive(e.path(), data);
 
-            auto tmpPath(path);
-            tmpPath += ".tmp";
+                    // references to geometry already sampled
+                    if (!data.first.m_contentHash.empty() &&
+                        !seen.emplace(data.first.m_contentHash).second)
+                    {
+                        samples.pop_back();
+                        continue;
+                    }
 
-            try
+                    rawBytes +=
+                        std::uint64_t(data.first.m_numVertices) * sizeof(MeshPoint) +
+                        data.first.m_weights.size() * sizeof(float) +
+                        data.first.m_indices.size() * sizeof(unsigned int);
+                }
+                catch (const std::exception&)
+                {
+                    samples.pop_back();
+                }
+            }
+
+            if (samples.empty())
+                throw std::exception("no bonecast archives found");
+
+            std::vector<std::string> encoded(samples.size());
+
+            auto run = [&](const char* a_name, auto a_write, auto a_read)
             {
+                auto& result = a_out.emplace_back();
+
+                result.name = a_name;
+                result.rawBytes = rawBytes;
+                result.storedBytes = 0;
+
+                auto start = IPerfCounter::Query();
+
+                for (std::size_t i = 0; i < samples.size(); i++)
                 {
-                    std::ofstream ofs;
+                    std::ostringstream os(std::ios::binary);
+                    a_write(os, samples[i]);
+                    encoded[i] = std::move(os).str();
+                }
+
+                auto t1 = IPerfCounter::Query();
+
+                for (std::size_t i = 0; i < samples.size(); i++)
+                {
+                    std::istringstream is(encoded[i], std::ios::binary);
+                    ColliderDataStoragePair tmp;
+                    a_read(is, tmp);
+                }
+
+                auto t2 = IPerfCounter::Query();
+
+                for (auto& e : encoded)
+                    result.storedBytes += e.size();
 
-                    ofs.open(
-                        tmpPath,
-                        std::ofstream::out |
-                        std::ofstream::binary |
-                        std::ofstream::trunc,
-                        _SH_DENYWR);
+                result.writeTime = IPerfCounter::delta_us(start, t1);
+                result.readTime = IPerfCounter::delta_us(t1, t2);
+            };
 
-                    if (!ofs.is_open())
-                        throw std::system_error(errno, std::system_category(), tmpPath.string());
+            for (std::underlying_type_t<BoneCastCodec> i = 0; i < std::underlying_type_t<BoneCastCodec>(BoneCastCodec::Max); i++)
+            {
+                auto codec = static_cast<BoneCastCodec>(i);
+
+                run(BoneCastContainer::GetCodecName(codec),
+                    [&](std::ostream& a_os, const ColliderDataStoragePair& a_in) {
+                        BoneCastContainer::Write(a_os, a_in.first, codec);
+                    },
+                    [](std::istream& a_is, ColliderDataStoragePair& a_data) {
+                        BoneCastContainer::Read(a_is, a_data.first);
+                    });
+            }
 
-                    using namespace boost::iostreams;
-                    using namespace boost::archive;
+            using namespace boost::iostreams;
+            using namespace boost::archive;
 
+            run("Legacy (boost, gzip)",
+                [](std::ostream& a_os, const ColliderDataStoragePair& a_in) {
                     filtering_streambuf<output> out;
                     out.push(gzip_compressor(gzip_params(zlib::best_speed), 1024 * 256));
-                    out.push(ofs);
+                    out.push(a_os);
 
                     binary_oarchive oa(out);
-
                     oa << a_in;
+                },
+                [](std::istream& a_is, ColliderDataStoragePair& a_data) {
+                    filtering_streambuf<input> in;
+                    in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 256));
+                    in.push(a_is);
+
+                    binary_iarchive ia(in);
+                    ia >> a_data;
+                });
+
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            m_lastException = e;
+            return false;
+        }
+    }
+
+    void IBoneCastIO::LoadPack()
+    {
+        auto& dir = DCBP::GetDriverConfig().paths.boneCastData;
+        auto path = dir / BoneCastPack::FILE_NAME;
+
+        // replaced packs, fails silently for any still mapped
+        try
+        {
+            for (auto& e : fs::directory_iterator(dir))
+            {
+                auto& p = e.path();
+
+                if (e.is_regular_file() &&
+                    p.extension() == BoneCastPack::OLD_EXTENSION &&
+                    p.filename().string().starts_with(BoneCastPack::FILE_NAME))
+                {
+                    std::error_code ec;
+                    fs::remove(p, ec);
                 }
+            }
+        }
+        catch (const std::exception&)
+        {
+        }
 
-                fs::rename(tmpPath, path);
+        std::shared_ptr<BoneCastPack> pack;
+
+        std::error_code ec;
+        if (fs::exists(path, ec))
+        {
+            pack = std::make_shared<BoneCastPack>();
+
+            except::descriptor error;
+            if (pack->Open(path, error))
+            {
+                Message("Mapped bonecast pack: %zu entries, %zu kb",
+                    pack->GetNumEntries(), pack->GetSize() / std::size_t(1024));
             }
-            catch (const std::exception& e)
+            else
             {
-                Serialization::SafeCleanup(tmpPath);
-                throw e;
+                Error("%s: %s", __FUNCTION__, error.what());
+                pack.reset();
             }
+        }
+
+        std::lock_guard<std::mutex> lock(m_packLock);
+        m_pack = std::move(pack);
+    }
+
+    void IBoneCastIO::ClosePack()
+    {
+        std::lock_guard<std::mutex> lock(m_packLock);
+        m_pack.reset();
+    }
+
+    auto IBoneCastIO::GetPack() -> std::shared_ptr<const BoneCastPack>
+    {
+        std::lock_guard<std::mutex> lock(m_packLock);
+        return m_pack;
+    }
+
+    bool IBoneCastIO::BuildPack(boneCastPackResult_t& a_out)
+    {
+        a_out = boneCastPackResult_t{};
+
+        bool result;
+
+        try
+        {
+            auto& dir = DCBP::GetDriverConfig().paths.boneCastData;
+
+            BoneCastPackWriter writer(dir / BoneCastPack::FILE_NAME);
+
+            std::unordered_set<std::string> packed;
+
+            for (auto& e : fs::directory_iterator(dir))
+            {
+                if (!e.is_regular_file())
+                    continue;
+
+                auto& path = e.path();
+
+                // skips the pack itself and leftover .tmp files
+                if (path.has_extension())
+                    continue;
+
+                auto key = path.filename().string();
+                if (key.size() != BoneCastPack::KEY_SIZE)
+                    continue;
+
+                ColliderDataStoragePair data;
+
+                try
+                {
+                    ReadArchive(path, data);
+                }
+                catch (const std::exception& ex)
+                {
+                    Warning("%s: %s: %s", __FUNCTION__, key.c_str(), ex.what());
+                    a_out.numFailed++;
+                    continue;
+                }
+
+                // legacy archives, the writer stores each distinct geometry once
+                if (data.first.m_contentHash.empty())
+                    IBoneCast::HashGeometry(data.first, data.first.m_contentHash);
+
+                writer.Add(key, e.last_write_time().time_since_epoch().count(), data.first);
+
+                packed.emplace(std::move(key));
+            }
+
+            // carry over entries whose loose files were deleted after packing
+            if (auto old = GetPack())
+            {
+                old->VisitEntries([&](const std::string& a_key, long long a_sourceTime) {
+
+                    if (packed.contains(a_key))
+                        return;
+
+                    ColliderDataStorage data;
+
+                    if (old->Find(a_key, nullptr, data))
+                    {
+                        writer.Add(a_key, a_sourceTime, data);
+                        a_out.numCarried++;
+                    }
+                });
+            }
+
+            ClosePack();
+
+            writer.Finish();
+
+            a_out.numEntries = writer.GetNumEntries();
+
+            result = true;
+        }
+        catch (const std::exception& e)
+        {
+            m_lastException = e;
+            result = false;
+        }
+
+        LoadPack();
+
+        return result;
+    }
+
+    template <class Tf>
+    static void WriteFileAtomic(const fs::path& a_path, Tf a_func)
+    {
+        Serialization::CreateRootPath(a_path);
+
+        auto tmpPath(a_path);
+        tmpPath += ".tmp";
+
+        try
+        {
+            {
+                std::ofstream ofs;
+
+                ofs.open(
+                    tmpPath,
+                    std::ofstream::out |
+                    std::ofstream::binary |
+                    std::ofstream::trunc,
+                    _SH_DENYWR);
+
+                if (!ofs.is_open())
+                    throw std::system_error(errno, std::system_category(), tmpPath.string());
+
+                a_func(ofs);
+            }
+
+            fs::rename(tmpPath, a_path);
+        }
+        catch (const std::exception& e)
+        {
+            Serialization::SafeCleanup(tmpPath);
+            throw e;
+        }
+    }
+
+    bool IBoneCastIO::Write(
+        Game::VMHandle a_handle,
+        const stl::fixed_string& a_nodeName,
+        const ColliderDataStoragePair& a_in)
+    {
+        try
+        {
+            auto& driverConf = DCBP::GetDriverConfig();
+
+            std::string key;
+            MakeKey(a_handle, a_nodeName, key);
+
+            std::string hash(a_in.first.m_contentHash);
+            if (hash.empty())
+                IBoneCast::HashGeometry(a_in.first, hash);
+
+            // identical geometry is only stored once, stale content files are left alone
+            auto contentPath = driverConf.paths.boneCastData / CONTENT_DIR / hash;
+
+            std::error_code ec;
+            if (!fs::exists(contentPath, ec))
+            {
+                WriteFileAtomic(contentPath, [&](std::ofstream& a_ofs) {
+                    BoneCastContainer::Write(a_ofs, a_in.first, driverConf.boneCastCodec);
+                });
+            }
+
+            WriteFileAtomic(driverConf.paths.boneCastData / key, [&](std::ofstream& a_ofs) {
+                BoneCastContainer::WriteReference(a_ofs, hash);
+            });
 
             return true;
         }
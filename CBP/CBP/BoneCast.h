@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ColliderData.h"
+#include "BoneCastPack.h"
+#include "BoneCastContainer.h"
 
 #include "Data/PluginInfo.h"
 
@@ -54,12 +56,78 @@ namespace CBP
     class IBoneCast;
     class IBoneCastIO;
 
+    // geometry shared by every actor/node with identical extracted data, keyed by content hash.
+    // Holds weak references only, entries go away with the last cache entry or collider using them
+    class BoneCastContentStore
+    {
+        struct processed_t
+        {
+            float weightThreshold;
+            float simplifyTarget;
+            float simplifyTargetError;
+
+            std::weak_ptr<const ColliderData> data;
+        };
+
+        // only the vertex array is shared, weights and indices stay in each cache entry (and are
+        // copied out of the pack) since the weight filter reads them on every threshold change.
+        // They're charged to the cache per entry
+        struct entry_t
+        {
+            std::weak_ptr<MeshPoint[]> vertices;
+            std::vector<processed_t> processed;
+        };
+
+    public:
+
+        static constexpr std::size_t MIN_PRUNE_THRESHOLD = 64;
+
+        struct stats_t
+        {
+            std::uint64_t sharedVertices;
+            std::uint64_t sharedProcessed;
+            std::size_t numEntries;
+        };
+
+        // hashes a_data if it hasn't been and swaps in a live vertex array with the same content
+        void ShareVertices(ColliderDataStorage& a_data);
+
+        [[nodiscard]] std::shared_ptr<const ColliderData> FindProcessed(
+            const std::string& a_hash,
+            float a_weightThreshold,
+            float a_simplifyTarget,
+            float a_simplifyTargetError);
+
+        void AddProcessed(
+            const std::string& a_hash,
+            float a_weightThreshold,
+            float a_simplifyTarget,
+            float a_simplifyTargetError,
+            const std::shared_ptr<const ColliderData>& a_data);
+
+        [[nodiscard]] stats_t GetStats();
+
+    private:
+
+        void PruneExpired();
+
+        std::mutex m_lock;
+
+        std::unordered_map<std::string, entry_t> m_data;
+        std::size_t m_pruneThreshold{ MIN_PRUNE_THRESHOLD };
+
+        std::uint64_t m_sharedVertices{ 0 };
+        std::uint64_t m_sharedProcessed{ 0 };
+    };
+
     class BoneCastCache
     {
     public:
 
         struct CacheEntry
         {
+            friend class BoneCastCache;
+
             CacheEntry() = delete;
 
             template <class T>
@@ -67,8 +135,7 @@ namespace CBP
                 const T& a_data)
                 :
                 m_size(0),
-                m_data(a_data),
-                m_lastAccess(IPerfCounter::Query())
+                m_data(a_data)
             {
             }
 
@@ -77,16 +144,34 @@ namespace CBP
                 T&& a_data)
                 :
                 m_size(0),
-                m_data(std::move(a_data)),
-                m_lastAccess(IPerfCounter::Query())
+                m_data(std::move(a_data))
             {
             }
 
             ColliderDataStoragePair m_data;
 
+            // bytes charged to this entry alone, shared vertex arrays and ColliderData aren't included
             std::size_t m_size;
-            long long m_lastAccess;
             BoneCacheUpdateID m_updateID;
+
+        private:
+
+            // blocks this entry holds a reference on in m_shared
+            const void* m_chargedVertices{ nullptr };
+            const void* m_chargedData{ nullptr };
+
+            // intrusive LRU list, map nodes don't move so the links stay valid across rehashes
+            CacheEntry* m_prev{ nullptr };
+            CacheEntry* m_next{ nullptr };
+            const bonecast_cache_key_t* m_key{ nullptr };
+        };
+
+        struct stats_t
+        {
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t evictions;
+            std::uint64_t evictedBytes;
         };
 
     public:
@@ -111,13 +196,14 @@ namespace CBP
     public:
 
         BoneCastCache() = delete;
-        BoneCastCache(IBoneCastIO& a_iio, std::size_t a_maxSize);
+        BoneCastCache(IBoneCastIO& a_iio, BoneCastContentStore& a_store, std::size_t a_maxSize);
 
         BoneCastCache(const BoneCastCache&) = delete;
         BoneCastCache(BoneCastCache&&) = delete;
         BoneCastCache& operator=(const BoneCastCache&) = delete;
         BoneCastCache& operator=(BoneCastCache&&) = delete;
 
+        // const_iterator lookups are peeks, they don't refresh the entry or count towards the stats
         template <class T, is_iterator_type<T> = 0>
         [[nodiscard]] bool Get(
             Game::VMHandle a_actor,
@@ -145,22 +231,77 @@ namespace CBP
         SKMP_FORCEINLINE void Release()
         {
             m_data.swap(decltype(m_data)());
+            m_shared.swap(decltype(m_shared)());
             m_totalSize = 0;
+            m_head = nullptr;
+            m_tail = nullptr;
         }
 
         [[nodiscard]] SKMP_FORCEINLINE auto GetSize() const noexcept {
             return m_totalSize;
         }
 
+        [[nodiscard]] SKMP_FORCEINLINE auto GetNumEntries() const noexcept {
+            return m_data.size();
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE const auto& GetStats() const noexcept {
+            return m_stats;
+        }
+
     private:
 
+        struct sharedBlock_t
+        {
+            std::size_t refs;
+            std::size_t size;
+        };
+
+        SKMP_FORCEINLINE void LinkFront(CacheEntry& a_entry);
+        SKMP_FORCEINLINE void Unlink(CacheEntry& a_entry);
+        SKMP_FORCEINLINE void Touch(CacheEntry& a_entry);
+
+        // a block shared by several entries is charged once, by whichever holds it first
+        void Charge(CacheEntry& a_entry);
+        std::size_t Uncharge(CacheEntry& a_entry);
+
+        SKMP_FORCEINLINE std::size_t AcquireShared(const void* a_block, std::size_t a_size);
+        SKMP_FORCEINLINE std::size_t ReleaseShared(const void* a_block);
+
         data_storage_t m_data;
 
+        // keyed by address, a block stays allocated while any entry references it
+        std::unordered_map<const void*, sharedBlock_t> m_shared;
+
+        CacheEntry* m_head{ nullptr };
+        CacheEntry* m_tail{ nullptr };
+
         std::size_t m_maxSize;
         std::size_t m_totalSize;
 
+        stats_t m_stats{};
+
         IBoneCastIO& m_iio;
+        BoneCastContentStore& m_store;
+
+    };
 
+    struct boneCastPackResult_t
+    {
+        std::uint32_t numEntries;
+        std::uint32_t numFailed;
+        std::uint32_t numCarried;  // taken from the previous pack, no loose file
+    };
+
+    struct boneCastCodecBenchmark_t
+    {
+        const char* name;
+
+        std::uint64_t rawBytes;
+        std::uint64_t storedBytes;
+
+        long long writeTime;
+        long long readTime;
     };
 
     class IBoneCastIO :
@@ -168,6 +309,10 @@ namespace CBP
     {
     public:
 
+        // content addressed geometry, per actor/node files only reference it
+        static constexpr const char* CONTENT_DIR = "content";
+
+        // tries the pack first, loose archives sampled after it was built take precedence
         bool Read(
             Game::VMHandle a_handle,
             const stl::fixed_string& a_nodeName,
@@ -186,8 +331,25 @@ namespace CBP
             return m_lastException;
         }
 
+        // (re)maps the pack if there is one
+        void LoadPack();
+        static void ClosePack();
+
+        [[nodiscard]] static std::shared_ptr<const BoneCastPack> GetPack();
+
+        // packs every loose archive. Fails to replace the old pack while anything still points into it
+        bool BuildPack(boneCastPackResult_t& a_out);
+
+        // encodes and decodes every loose archive in memory with each codec and the old boost/gzip format
+        bool RunCodecBenchmark(std::vector<boneCastCodecBenchmark_t>& a_out);
+
     private:
 
+        // resolves references, sets m_contentHash when it knows it
+        static void ReadArchive(
+            const fs::path& a_path,
+            ColliderDataStoragePair& a_out);
+
         [[nodiscard]] void MakeKey(
             Game::VMHandle a_handle,
             const stl::fixed_string& a_nodeName,
@@ -199,6 +361,10 @@ namespace CBP
         //mutable ICriticalSection m_rwLock;
 
         except::descriptor m_lastException;
+
+        // shared by the worker instances
+        static std::shared_ptr<const BoneCastPack> m_pack;
+        static std::mutex m_packLock;
     };
 
 
@@ -213,6 +379,24 @@ namespace CBP
             bool m_isBoneTri;
         };
 
+        struct asyncJob_t
+        {
+            bonecast_cache_key_t key;
+            std::uint64_t serial;
+
+            float weightThreshold;
+            float simplifyTarget;
+            float simplifyTargetError;
+
+            // source geometry copied from the cache, read from disk otherwise
+            bool hasSource;
+            bool read;
+            bool updated;
+
+            // config meta is set when queued
+            ColliderDataStoragePair data;
+        };
+
         struct SKMP_ALIGN_AUTO Vertex
         {
             SKMP_DECLARE_ALIGNED_ALLOCATOR_AUTO();
@@ -234,6 +418,8 @@ namespace CBP
 
     public:
 
+        static constexpr std::uint32_t MAX_WORKERS = 4;
+
         [[nodiscard]] static bool Get(
             Game::VMHandle a_handle,
             const stl::fixed_string& a_nodeName,
@@ -272,6 +458,14 @@ namespace CBP
             return m_Instance.m_cache.GetSize();
         }
 
+        [[nodiscard]] SKMP_FORCEINLINE static auto GetCacheEntries() {
+            return m_Instance.m_cache.GetNumEntries();
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE static const auto& GetCacheStats() {
+            return m_Instance.m_cache.GetStats();
+        }
+
         [[nodiscard]] static bool ExtractGeometry(
             Actor* a_actor,
             const BSFixedString& a_nodeName,
@@ -280,12 +474,66 @@ namespace CBP
 
         SKMP_FORCEINLINE static void Release() {
             m_Instance.m_cache.Release();
+            m_Instance.m_failed.clear();
+        }
+
+        SKMP_FORCEINLINE static void LoadPack() {
+            m_Instance.m_iio.LoadPack();
+        }
+
+        // releases the cache so nothing keeps the old pack mapped
+        [[nodiscard]] static bool BuildPack(boneCastPackResult_t& a_out);
+
+        [[nodiscard]] SKMP_FORCEINLINE static bool RunCodecBenchmark(std::vector<boneCastCodecBenchmark_t>& a_out) {
+            return m_Instance.m_iio.RunCodecBenchmark(a_out);
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE static const auto& GetLastIOException() {
+            return m_Instance.m_iio.GetLastException();
+        }
+
+        // xyz only, the w lane of MeshPoint is never initialized
+        static void HashGeometry(const ColliderDataStorage& a_data, std::string& a_out);
+
+        [[nodiscard]] SKMP_FORCEINLINE static auto GetContentStats() {
+            return m_Instance.m_store.GetStats();
+        }
+
+        // 0 threads keeps reads and simplification on the caller
+        static void StartWorkers(std::uint32_t a_numThreads);
+        static void StopWorkers();
+
+        [[nodiscard]] SKMP_FORCEINLINE static bool IsAsync() {
+            return !m_Instance.m_workers.empty();
+        }
+
+        // read (when a_source is null) and simplify on a worker, results land in the cache
+        // through ProcessCompleted. False when the last read of this node failed
+        [[nodiscard]] static bool Queue(
+            Game::VMHandle a_handle,
+            const stl::fixed_string& a_nodeName,
+            const configNode_t& a_nodeConfig,
+            const ColliderDataStorage* a_source);
+
+        [[nodiscard]] static bool IsPending(
+            Game::VMHandle a_handle,
+            const stl::fixed_string& a_nodeName);
+
+        // moves finished jobs into the cache and appends their actors to a_out, returns the job count.
+        // Same thread as Get/Queue
+        static std::size_t ProcessCompleted(std::vector<Game::VMHandle>& a_out);
+
+        [[nodiscard]] SKMP_FORCEINLINE static std::size_t GetNumPending() {
+            return m_Instance.m_numPending.load(std::memory_order_relaxed);
         }
 
     private:
 
         IBoneCast();
 
+        void WorkerProc();
+        void RunJob(IBoneCastIO& a_iio, asyncJob_t& a_job);
+
         [[nodiscard]] SKMP_FORCEINLINE static auto& GetCache() {
             return m_Instance.m_cache;
         }
@@ -339,9 +587,34 @@ namespace CBP
             float a_simplifyTarget,
             float a_simplifyTargetError);
 
+        // UpdateGeometry, unless the same content was already simplified with the same settings
+        [[nodiscard]] static bool UpdateGeometryShared(
+            ColliderDataStoragePair& a_in,
+            float a_weightThreshold,
+            float a_simplifyTarget,
+            float a_simplifyTargetError);
+
+        BoneCastContentStore m_store;
         BoneCastCache m_cache;
         IBoneCastIO m_iio;
 
+        std::vector<std::thread> m_workers;
+        bool m_shutdown{ false };
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+
+        std::deque<std::unique_ptr<asyncJob_t>> m_queue;
+        std::vector<std::unique_ptr<asyncJob_t>> m_completed;
+
+        // guarded by the driver lock like the cache. Sampling a node drops its pending
+        // serial so a job reading the old file can't overwrite the fresh entry
+        std::unordered_map<bonecast_cache_key_t, std::uint64_t> m_pending;
+        std::unordered_set<bonecast_cache_key_t> m_failed;
+        std::uint64_t m_serial{ 0 };
+
+        std::atomic<std::size_t> m_numPending{ 0 };
+
         static IBoneCast m_Instance;
     };
 
@@ -0,0 +1,241 @@
+#include "pch.h"
+
+#include "BoneCastContainer.h"
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+namespace CBP
+{
+    auto BoneCastContainer::Probe(std::istream& a_in)
+        -> Type
+    {
+        auto pos = a_in.tellg();
+
+        std::uint32_t magic(0);
+        a_in.read(reinterpret_cast<char*>(std::addressof(magic)), sizeof(magic));
+
+        a_in.clear();
+        a_in.seekg(pos);
+
+        switch (magic)
+        {
+        case MAGIC:
+            return Type::Geometry;
+        case REFERENCE_MAGIC:
+            return Type::Reference;
+        default:
+            return Type::Legacy;
+        }
+    }
+
+    const char* BoneCastContainer::GetCodecName(BoneCastCodec a_codec)
+    {
+        switch (a_codec)
+        {
+        case BoneCastCodec::None:
+            return "None";
+        case BoneCastCodec::Deflate:
+            return "Deflate";
+        default:
+            return "Unknown";
+        }
+    }
+
+    void BoneCastContainer::WriteBlock(
+        std::ostream& a_out,
+        const void* a_data,
+        std::size_t a_size,
+        BoneCastCodec a_codec)
+    {
+        blockHeader_t header{};
+        header.codec = a_codec;
+
+        switch (a_codec)
+        {
+        case BoneCastCodec::None:
+        {
+            header.storedSize = a_size;
+
+            a_out.write(reinterpret_cast<const char*>(std::addressof(header)), sizeof(header));
+            a_out.write(static_cast<const char*>(a_data), a_size);
+        }
+        break;
+        case BoneCastCodec::Deflate:
+        {
+            using namespace boost::iostreams;
+
+            std::vector<char> buffer;
+            buffer.reserve(a_size / 2);
+
+            {
+                filtering_ostream out;
+                out.push(zlib_compressor(zlib_params(zlib::best_speed)));
+                out.push(back_inserter(buffer));
+
+                out.write(static_cast<const char*>(a_data), a_size);
+            }
+
+            header.storedSize = buffer.size();
+
+            a_out.write(reinterpret_cast<const char*>(std::addressof(header)), sizeof(header));
+            a_out.write(buffer.data(), buffer.size());
+        }
+        break;
+        default:
+            throw std::exception("unsupported codec");
+        }
+    }
+
+    void BoneCastContainer::ReadBlock(
+        std::istream& a_in,
+        void* a_data,
+        std::size_t a_size,
+        std::vector<char>& a_buffer)
+    {
+        blockHeader_t header;
+
+        a_in.read(reinterpret_cast<char*>(std::addressof(header)), sizeof(header));
+        if (!a_in)
+            throw std::exception("truncated block header");
+
+        switch (header.codec)
+        {
+        case BoneCastCodec::None:
+        {
+            if (header.storedSize != a_size)
+                throw std::exception("block size mismatch");
+
+            a_in.read(static_cast<char*>(a_data), a_size);
+            if (!a_in)
+                throw std::exception("truncated block");
+        }
+        break;
+        case BoneCastCodec::Deflate:
+        {
+            using namespace boost::iostreams;
+
+            a_buffer.resize(header.storedSize);
+
+            a_in.read(a_buffer.data(), a_buffer.size());
+            if (!a_in)
+                throw std::exception("truncated block");
+
+            filtering_istream in;
+            in.push(zlib_decompressor());
+            in.push(array_source(a_buffer.data(), a_buffer.size()));
+
+            in.read(static_cast<char*>(a_data), a_size);
+
+            if (static_cast<std::size_t>(in.gcount()) != a_size)
+                throw std::exception("block size mismatch");
+        }
+        break;
+        default:
+            throw std::exception("unsupported codec");
+        }
+    }
+
+    void BoneCastContainer::Write(
+        std::ostream& a_out,
+        const ColliderDataStorage& a_in,
+        BoneCastCodec a_codec)
+    {
+        header_t header;
+
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.numVertices = a_in.m_numVertices;
+        header.numTriangles = a_in.m_numTriangles;
+        header.numWeights = static_cast<std::uint32_t>(a_in.m_weights.size());
+        header.numIndices = static_cast<std::uint32_t>(a_in.m_indices.size());
+
+        a_out.write(reinterpret_cast<const char*>(std::addressof(header)), sizeof(header));
+
+        stl::vector_simd<MeshPoint> vertices;
+        a_in.CopyVerticesZeroW(vertices);
+
+        WriteBlock(a_out, vertices.data(), std::size_t(header.numVertices) * sizeof(MeshPoint), a_codec);
+        WriteBlock(a_out, a_in.m_weights.data(), std::size_t(header.numWeights) * sizeof(float), a_codec);
+        WriteBlock(a_out, a_in.m_indices.data(), std::size_t(header.numIndices) * sizeof(unsigned int), a_codec);
+
+        if (!a_out)
+            throw std::exception("write failed");
+    }
+
+    void BoneCastContainer::Read(
+        std::istream& a_in,
+        ColliderDataStorage& a_out)
+    {
+        header_t header;
+
+        a_in.read(reinterpret_cast<char*>(std::addressof(header)), sizeof(header));
+        if (!a_in)
+            throw std::exception("truncated header");
+
+        if (header.magic != MAGIC)
+            throw std::exception("bad magic");
+
+        if (header.version != VERSION)
+            throw std::exception("unsupported version");
+
+        std::vector<char> buffer;
+
+        auto vertices = std::make_unique_for_overwrite<MeshPoint[]>(header.numVertices);
+
+        ReadBlock(a_in, vertices.get(), std::size_t(header.numVertices) * sizeof(MeshPoint), buffer);
+
+        a_out.m_weights.resize(header.numWeights);
+        ReadBlock(a_in, a_out.m_weights.data(), std::size_t(header.numWeights) * sizeof(float), buffer);
+
+        a_out.m_indices.resize(header.numIndices);
+        ReadBlock(a_in, a_out.m_indices.data(), std::size_t(header.numIndices) * sizeof(unsigned int), buffer);
+
+        a_out.m_vertices = std::move(vertices);
+        a_out.m_numVertices = header.numVertices;
+        a_out.m_numTriangles = header.numTriangles;
+    }
+
+    void BoneCastContainer::WriteReference(
+        std::ostream& a_out,
+        const std::string& a_hash)
+    {
+        if (a_hash.size() != HASH_SIZE)
+            throw std::exception("bad hash length");
+
+        referenceHeader_t header;
+
+        header.magic = REFERENCE_MAGIC;
+        header.version = VERSION;
+        std::memcpy(header.hash, a_hash.data(), HASH_SIZE);
+
+        a_out.write(reinterpret_cast<const char*>(std::addressof(header)), sizeof(header));
+
+        if (!a_out)
+            throw std::exception("write failed");
+    }
+
+    void BoneCastContainer::ReadReference(
+        std::istream& a_in,
+        std::string& a_hash)
+    {
+        referenceHeader_t header;
+
+        a_in.read(reinterpret_cast<char*>(std::addressof(header)), sizeof(header));
+        if (!a_in)
+            throw std::exception("truncated header");
+
+        if (header.magic != REFERENCE_MAGIC)
+            throw std::exception("bad magic");
+
+        if (header.version != VERSION)
+            throw std::exception("unsupported version");
+
+        // ends up in a path
+        if (!std::all_of(header.hash, header.hash + HASH_SIZE, [](char a_c) { return std::isxdigit(static_cast<unsigned char>(a_c)) != 0; }))
+            throw std::exception("bad hash");
+
+        a_hash.assign(header.hash, HASH_SIZE);
+    }
+}
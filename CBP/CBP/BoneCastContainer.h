@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ColliderData.h"
+
+namespace CBP
+{
+    enum class BoneCastCodec : std::uint8_t
+    {
+        None = 0,
+        Deflate = 1,
+
+        Max
+    };
+
+    // loose bonecast archive: header followed by the vertex, weight and index arrays as raw
+    // little-endian blocks, each compressed on its own. Blocks decode straight into the
+    // destination arrays. Per actor/node files are references to a geometry file named by
+    // its content hash
+    class BoneCastContainer
+    {
+        static constexpr std::uint32_t MAGIC = 0x43444342; // 'BCDC'
+        static constexpr std::uint32_t REFERENCE_MAGIC = 0x46524342; // 'BCRF'
+        static constexpr std::uint32_t VERSION = 1;
+
+        // hex SHA1, IBoneCast::HashGeometry
+        static constexpr std::size_t HASH_SIZE = 40;
+
+        struct header_t
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t numVertices;
+            std::int32_t numTriangles;
+            std::uint32_t numWeights;
+            std::uint32_t numIndices;
+        };
+
+        struct blockHeader_t
+        {
+            BoneCastCodec codec;
+            std::uint8_t pad[7];
+            std::uint64_t storedSize;
+        };
+
+        struct referenceHeader_t
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            char hash[HASH_SIZE];
+        };
+
+        static_assert(std::endian::native == std::endian::little);
+        static_assert(sizeof(MeshPoint) == 16);
+
+    public:
+
+        enum class Type
+        {
+            Legacy,     // gzip'd boost archive
+            Geometry,
+            Reference
+        };
+
+        // leaves the stream where it was
+        [[nodiscard]] static Type Probe(std::istream& a_in);
+
+        // throw on failure
+        static void Write(std::ostream& a_out, const ColliderDataStorage& a_in, BoneCastCodec a_codec);
+        static void Read(std::istream& a_in, ColliderDataStorage& a_out);
+
+        static void WriteReference(std::ostream& a_out, const std::string& a_hash);
+        static void ReadReference(std::istream& a_in, std::string& a_hash);
+
+        [[nodiscard]] static const char* GetCodecName(BoneCastCodec a_codec);
+
+    private:
+
+        static void WriteBlock(std::ostream& a_out, const void* a_data, std::size_t a_size, BoneCastCodec a_codec);
+        static void ReadBlock(std::istream& a_in, void* a_data, std::size_t a_size, std::vector<char>& a_buffer);
+    };
+}
@@ -0,0 +1,263 @@
+#include "pch.h"
+
+#include "BoneCastPack.h"
+#include "Common/Serialization.h"
+
+namespace CBP
+{
+    BoneCastPack::~BoneCastPack() noexcept
+    {
+        if (m_view)
+            ::UnmapViewOfFile(m_view);
+
+        if (m_mapping)
+            ::CloseHandle(m_mapping);
+
+        if (m_file != INVALID_HANDLE_VALUE)
+            ::CloseHandle(m_file);
+    }
+
+    bool BoneCastPack::Open(const fs::path& a_path, except::descriptor& a_error)
+    {
+        try
+        {
+            m_file = ::CreateFileW(
+                a_path.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_DELETE,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                nullptr);
+
+            if (m_file == INVALID_HANDLE_VALUE)
+                throw std::system_error(::GetLastError(), std::system_category(), a_path.string());
+
+            LARGE_INTEGER size;
+            if (!::GetFileSizeEx(m_file, std::addressof(size)))
+                throw std::system_error(::GetLastError(), std::system_category(), a_path.string());
+
+            if (size.QuadPart < static_cast<LONGLONG>(sizeof(header_t)))
+                throw std::exception("pack too small");
+
+            m_size = static_cast<std::size_t>(size.QuadPart);
+
+            m_mapping = ::CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_mapping)
+                throw std::system_error(::GetLastError(), std::system_category(), a_path.string());
+
+            m_view = static_cast<const std::uint8_t*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (!m_view)
+                throw std::system_error(::GetLastError(), std::system_category(), a_path.string());
+
+            auto header = reinterpret_cast<const header_t*>(m_view);
+
+            if (header->magic != MAGIC)
+                throw std::exception("bad magic");
+
+            if (header->version != VERSION)
+                throw std::exception("unsupported version");
+
+            if (header->indexOffset > m_size ||
+                (m_size - header->indexOffset) / sizeof(entry_t) < header->numEntries)
+            {
+                throw std::exception("index out of range");
+            }
+
+            auto entries = reinterpret_cast<const entry_t*>(m_view + header->indexOffset);
+
+            auto inRange = [&](std::uint64_t a_offset, std::uint64_t a_count, std::size_t a_elemSize) {
+                return a_offset <= m_size && (m_size - a_offset) / a_elemSize >= a_count;
+            };
+
+            m_index.reserve(header->numEntries);
+
+            for (std::uint32_t i = 0; i < header->numEntries; i++)
+            {
+                auto& e = entries[i];
+
+                if (!inRange(e.vertexOffset, e.numVertices, sizeof(MeshPoint)) ||
+                    !inRange(e.weightOffset, e.numWeights, sizeof(float)) ||
+                    !inRange(e.indexOffset, e.numIndices, sizeof(unsigned int)) ||
+                    e.vertexOffset % BLOCK_ALIGNMENT != 0)
+                {
+                    throw std::exception("entry out of range");
+                }
+
+                m_index.emplace(std::string(e.key, KEY_SIZE), std::addressof(e));
+            }
+
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            a_error = e;
+            return false;
+        }
+    }
+
+    bool BoneCastPack::Find(
+        const std::string& a_key,
+        const long long* a_sourceTime,
+        ColliderDataStorage& a_out) const
+    {
+        auto it = m_index.find(a_key);
+        if (it == m_index.end())
+            return false;
+
+        auto& e = *it->second;
+
+        if (a_sourceTime && *a_sourceTime != e.sourceTime)
+            return false;
+
+        // the view outlives every storage pointing into it
+        a_out.m_vertices = std::shared_ptr<MeshPoint[]>(
+            shared_from_this(),
+            const_cast<MeshPoint*>(reinterpret_cast<const MeshPoint*>(m_view + e.vertexOffset)));
+
+        auto weights = reinterpret_cast<const float*>(m_view + e.weightOffset);
+        a_out.m_weights.assign(weights, weights + e.numWeights);
+
+        auto indices = reinterpret_cast<const unsigned int*>(m_view + e.indexOffset);
+        a_out.m_indices.assign(indices, indices + e.numIndices);
+
+        a_out.m_numVertices = e.numVertices;
+        a_out.m_numTriangles = e.numTriangles;
+        a_out.m_contentHash.assign(e.contentHash, KEY_SIZE);
+
+        return true;
+    }
+
+    BoneCastPackWriter::BoneCastPackWriter(const fs::path& a_path) :
+        m_path(a_path),
+        m_tmpPath(a_path),
+        m_offset(0),
+        m_finished(false)
+    {
+        m_tmpPath += ".tmp";
+
+        Serialization::CreateRootPath(m_path);
+
+        m_stream.open(
+            m_tmpPath,
+            std::ofstream::out |
+            std::ofstream::binary |
+            std::ofstream::trunc,
+            _SH_DENYWR);
+
+        if (!m_stream.is_open())
+            throw std::system_error(errno, std::system_category(), m_tmpPath.string());
+
+        // filled in by Finish
+        BoneCastPack::header_t header{};
+        WriteBlock(std::addressof(header), sizeof(header));
+    }
+
+    BoneCastPackWriter::~BoneCastPackWriter() noexcept
+    {
+        if (!m_finished)
+        {
+            m_stream.close();
+            Serialization::SafeCleanup(m_tmpPath);
+        }
+    }
+
+    std::uint64_t BoneCastPackWriter::WriteBlock(const void* a_data, std::size_t a_size)
+    {
+        constexpr char zero[BoneCastPack::BLOCK_ALIGNMENT]{};
+
+        if (auto pad = m_offset % BoneCastPack::BLOCK_ALIGNMENT)
+        {
+            pad = BoneCastPack::BLOCK_ALIGNMENT - pad;
+
+            m_stream.write(zero, pad);
+            m_offset += pad;
+        }
+
+        auto offset = m_offset;
+
+        if (a_size)
+        {
+            m_stream.write(static_cast<const char*>(a_data), a_size);
+            m_offset += a_size;
+        }
+
+        if (m_stream.fail())
+            throw std::system_error(errno, std::system_category(), m_tmpPath.string());
+
+        return offset;
+    }
+
+    void BoneCastPackWriter::Add(
+        const std::string& a_key,
+        long long a_sourceTime,
+        const ColliderDataStorage& a_in)
+    {
+        if (a_key.size() != BoneCastPack::KEY_SIZE)
+            throw std::exception("bad key length");
+
+        if (a_in.m_contentHash.size() != BoneCastPack::KEY_SIZE)
+            throw std::exception("bad content hash length");
+
+        auto& e = m_entries.emplace_back();
+
+        std::memcpy(e.key, a_key.data(), BoneCastPack::KEY_SIZE);
+        std::memcpy(e.contentHash, a_in.m_contentHash.data(), BoneCastPack::KEY_SIZE);
+
+        e.sourceTime = a_sourceTime;
+        e.numVertices = a_in.m_numVertices;
+        e.numWeights = static_cast<std::uint32_t>(a_in.m_weights.size());
+        e.numIndices = static_cast<std::uint32_t>(a_in.m_indices.size());
+        e.numTriangles = a_in.m_numTriangles;
+
+        auto r = m_blocks.try_emplace(a_in.m_contentHash, m_entries.size() - 1);
+        if (!r.second)
+        {
+            auto& o = m_entries[r.first->second];
+
+            e.vertexOffset = o.vertexOffset;
+            e.weightOffset = o.weightOffset;
+            e.indexOffset = o.indexOffset;
+
+            return;
+        }
+
+        a_in.CopyVerticesZeroW(m_vertexBuffer);
+
+        e.vertexOffset = WriteBlock(m_vertexBuffer.data(), std::size_t(e.numVertices) * sizeof(MeshPoint));
+        e.weightOffset = WriteBlock(a_in.m_weights.data(), std::size_t(e.numWeights) * sizeof(float));
+        e.indexOffset = WriteBlock(a_in.m_indices.data(), std::size_t(e.numIndices) * sizeof(unsigned int));
+    }
+
+    void BoneCastPackWriter::Finish()
+    {
+        BoneCastPack::header_t header{};
+
+        header.magic = BoneCastPack::MAGIC;
+        header.version = BoneCastPack::VERSION;
+        header.numEntries = static_cast<std::uint32_t>(m_entries.size());
+        header.indexOffset = WriteBlock(m_entries.data(), m_entries.size() * sizeof(BoneCastPack::entry_t));
+
+        m_stream.seekp(0);
+        m_stream.write(reinterpret_cast<const char*>(std::addressof(header)), sizeof(header));
+        m_stream.close();
+
+        if (m_stream.fail())
+            throw std::system_error(errno, std::system_category(), m_tmpPath.string());
+
+        // views handed out by Find can outlive the cache, a mapped file can be renamed
+        // (opened with FILE_SHARE_DELETE) but not replaced
+        std::error_code ec;
+        if (fs::exists(m_path, ec))
+        {
+            auto oldPath(m_path);
+            oldPath += "." + std::to_string(::GetTickCount64()) + BoneCastPack::OLD_EXTENSION;
+
+            fs::rename(m_path, oldPath);
+        }
+
+        fs::rename(m_tmpPath, m_path);
+
+        m_finished = true;
+    }
+}
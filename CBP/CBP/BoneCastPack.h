@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ColliderData.h"
+
+namespace CBP
+{
+    // every bonecast archive in one read-only mapped file. Vertices are stored in the MeshPoint
+    // layout and handed out as pointers into the view, weights and indices are a flat copy
+    class BoneCastPack :
+        public std::enable_shared_from_this<BoneCastPack>,
+        ILog
+    {
+        friend class BoneCastPackWriter;
+
+    public:
+
+        static constexpr const char* FILE_NAME = "bonecast.pack";
+
+        // replaced packs still mapped by live colliders are renamed to <FILE_NAME>.<n>.old
+        static constexpr const char* OLD_EXTENSION = ".old";
+
+        // hex SHA1, IBoneCastIO::MakeKey and IBoneCast::HashGeometry
+        static constexpr std::size_t KEY_SIZE = 40;
+
+    private:
+
+        static constexpr std::uint32_t MAGIC = 0x4B504342; // 'BCPK'
+        static constexpr std::uint32_t VERSION = 2;
+
+        // keeps the vertex arrays aligned for MeshPoint
+        static constexpr std::size_t BLOCK_ALIGNMENT = 16;
+
+        struct header_t
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t numEntries;
+            std::uint32_t pad;
+            std::uint64_t indexOffset;
+        };
+
+        struct entry_t
+        {
+            char key[KEY_SIZE];
+
+            // ColliderDataStorage::m_contentHash, saves hashing on every pack read
+            char contentHash[KEY_SIZE];
+
+            // loose archive write time when packed
+            long long sourceTime;
+
+            std::uint64_t vertexOffset;
+            std::uint64_t weightOffset;
+            std::uint64_t indexOffset;
+
+            std::uint32_t numVertices;
+            std::uint32_t numWeights;
+            std::uint32_t numIndices;
+            std::int32_t numTriangles;
+        };
+
+        static_assert(sizeof(MeshPoint) == 16);
+
+    public:
+
+        BoneCastPack() = default;
+        virtual ~BoneCastPack() noexcept;
+
+        BoneCastPack(const BoneCastPack&) = delete;
+        BoneCastPack(BoneCastPack&&) = delete;
+        BoneCastPack& operator=(const BoneCastPack&) = delete;
+        BoneCastPack& operator=(BoneCastPack&&) = delete;
+
+        // must be owned by a shared_ptr, Find hands out pointers sharing ownership of the view
+        [[nodiscard]] bool Open(const fs::path& a_path, except::descriptor& a_error);
+
+        // a_sourceTime is the write time of the loose archive for this key, null if there is none.
+        // Entries packed from a different version of it are skipped
+        [[nodiscard]] bool Find(
+            const std::string& a_key,
+            const long long* a_sourceTime,
+            ColliderDataStorage& a_out) const;
+
+        // a_func(const std::string& a_key, long long a_sourceTime)
+        template <class Tf>
+        void VisitEntries(Tf a_func) const
+        {
+            for (auto& e : m_index)
+                a_func(e.first, e.second->sourceTime);
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::size_t GetNumEntries() const noexcept {
+            return m_index.size();
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::size_t GetSize() const noexcept {
+            return m_size;
+        }
+
+        FN_NAMEPROC("BoneCastPack");
+
+    private:
+
+        HANDLE m_file{ INVALID_HANDLE_VALUE };
+        HANDLE m_mapping{ nullptr };
+        const std::uint8_t* m_view{ nullptr };
+        std::size_t m_size{ 0 };
+
+        std::unordered_map<std::string, const entry_t*> m_index;
+    };
+
+    // writes to <path>.tmp, Finish moves it in place. Throws on failure
+    class BoneCastPackWriter
+    {
+    public:
+
+        BoneCastPackWriter(const fs::path& a_path);
+        ~BoneCastPackWriter() noexcept;
+
+        BoneCastPackWriter(const BoneCastPackWriter&) = delete;
+        BoneCastPackWriter(BoneCastPackWriter&&) = delete;
+        BoneCastPackWriter& operator=(const BoneCastPackWriter&) = delete;
+        BoneCastPackWriter& operator=(BoneCastPackWriter&&) = delete;
+
+        // a_in must be hashed, entries with the same m_contentHash point at the same blocks
+        void Add(const std::string& a_key, long long a_sourceTime, const ColliderDataStorage& a_in);
+        void Finish();
+
+        [[nodiscard]] SKMP_FORCEINLINE std::uint32_t GetNumEntries() const noexcept {
+            return static_cast<std::uint32_t>(m_entries.size());
+        }
+
+    private:
+
+        std::uint64_t WriteBlock(const void* a_data, std::size_t a_size);
+
+        fs::path m_path;
+        fs::path m_tmpPath;
+
+        std::ofstream m_stream;
+        std::uint64_t m_offset;
+
+        std::vector<BoneCastPack::entry_t> m_entries;
+        std::unordered_map<std::string, std::size_t> m_blocks;
+
+        stl::vector_simd<MeshPoint> m_vertexBuffer;
+
+        bool m_finished;
+    };
+}
@@ -0,0 +1,243 @@
+#include "pch.h"
+
+#include "Broadphase.h"
+
+namespace CBP
+{
+    SKMP_FORCEINLINE static std::int32_t CellCoord(btScalar a_v, btScalar a_invCellSize)
+    {
+        return static_cast<std::int32_t>(std::floor(a_v * a_invCellSize));
+    }
+
+    // 21 bits per axis, coordinates past +-2^20 cells wrap around which only adds false candidates
+    SKMP_FORCEINLINE static std::uint64_t CellKey(std::int32_t a_x, std::int32_t a_y, std::int32_t a_z)
+    {
+        return
+            ((static_cast<std::uint64_t>(a_x) & 0x1FFFFF) << 42) |
+            ((static_cast<std::uint64_t>(a_y) & 0x1FFFFF) << 21) |
+            (static_cast<std::uint64_t>(a_z) & 0x1FFFFF);
+    }
+
+    SpatialHashBroadphase::SpatialHashBroadphase(btScalar a_cellSize) :
+        m_pairCache(std::make_unique<btHashedOverlappingPairCache>()),
+        m_cellSize(a_cellSize),
+        m_lastCellSize(0.0f)
+    {
+    }
+
+    SpatialHashBroadphase::~SpatialHashBroadphase() noexcept
+    {
+        for (auto& e : m_proxies)
+            delete e;
+    }
+
+    btBroadphaseProxy* SpatialHashBroadphase::createProxy(
+        const btVector3& a_aabbMin,
+        const btVector3& a_aabbMax,
+        int,
+        void* a_userPtr,
+        int a_collisionFilterGroup,
+        int a_collisionFilterMask,
+        btDispatcher*)
+    {
+        auto proxy = new proxy_t(a_aabbMin, a_aabbMax, a_userPtr, a_collisionFilterGroup, a_collisionFilterMask);
+
+        proxy->m_uniqueId = m_nextUid++;
+        proxy->m_index = static_cast<std::uint32_t>(m_proxies.size());
+
+        m_proxies.emplace_back(proxy);
+
+        return proxy;
+    }
+
+    void SpatialHashBroadphase::destroyProxy(btBroadphaseProxy* a_proxy, btDispatcher* a_dispatcher)
+    {
+        auto proxy = static_cast<proxy_t*>(a_proxy);
+
+        m_pairCache->removeOverlappingPairsContainingProxy(proxy, a_dispatcher);
+
+        auto last = m_proxies.back();
+
+        m_proxies[proxy->m_index] = last;
+        last->m_index = proxy->m_index;
+        m_proxies.pop_back();
+
+        delete proxy;
+    }
+
+    void SpatialHashBroadphase::setAabb(
+        btBroadphaseProxy* a_proxy,
+        const btVector3& a_aabbMin,
+        const btVector3& a_aabbMax,
+        btDispatcher*)
+    {
+        // pairs are brought up to date by the next calculateOverlappingPairs
+        a_proxy->m_aabbMin = a_aabbMin;
+        a_proxy->m_aabbMax = a_aabbMax;
+    }
+
+    void SpatialHashBroadphase::getAabb(btBroadphaseProxy* a_proxy, btVector3& a_aabbMin, btVector3& a_aabbMax) const
+    {
+        a_aabbMin = a_proxy->m_aabbMin;
+        a_aabbMax = a_proxy->m_aabbMax;
+    }
+
+    void SpatialHashBroadphase::rayTest(
+        const btVector3&,
+        const btVector3&,
+        btBroadphaseRayCallback& a_rayCallback,
+        const btVector3&,
+        const btVector3&)
+    {
+        // same as btSimpleBroadphase, the callback does the actual test
+        for (auto& e : m_proxies)
+            a_rayCallback.process(e);
+    }
+
+    void SpatialHashBroadphase::aabbTest(const btVector3& a_aabbMin, const btVector3& a_aabbMax, btBroadphaseAabbCallback& a_callback)
+    {
+        for (auto& e : m_proxies)
+        {
+            if (TestAabbAgainstAabb2(a_aabbMin, a_aabbMax, e->m_aabbMin, e->m_aabbMax))
+                a_callback.process(e);
+        }
+    }
+
+    void SpatialHashBroadphase::getBroadphaseAabb(btVector3& a_aabbMin, btVector3& a_aabbMax) const
+    {
+        a_aabbMin.setValue(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+        a_aabbMax.setValue(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    }
+
+    btScalar SpatialHashBroadphase::ComputeCellSize() const
+    {
+        if (m_cellSize > 0.0f || m_proxies.empty())
+            return std::clamp(m_cellSize, MIN_CELL_SIZE, MAX_CELL_SIZE);
+
+        btScalar sum(0.0f);
+
+        for (auto& e : m_proxies)
+        {
+            auto extent(e->m_aabbMax - e->m_aabbMin);
+            sum += extent[extent.maxAxis()];
+        }
+
+        return std::clamp(sum / static_cast<btScalar>(m_proxies.size()) * 2.0f, MIN_CELL_SIZE, MAX_CELL_SIZE);
+    }
+
+    SKMP_FORCEINLINE void SpatialHashBroadphase::AddPair(proxy_t* a_p0, proxy_t* a_p1)
+    {
+        if (TestAabbAgainstAabb2(a_p0->m_aabbMin, a_p0->m_aabbMax, a_p1->m_aabbMin, a_p1->m_aabbMax))
+        {
+            // runs the overlap filter and returns the existing pair if there is one
+            m_pairCache->addOverlappingPair(a_p0, a_p1);
+        }
+    }
+
+    void SpatialHashBroadphase::calculateOverlappingPairs(btDispatcher* a_dispatcher)
+    {
+        auto numProxies = static_cast<std::uint32_t>(m_proxies.size());
+
+        auto cellSize = ComputeCellSize();
+        auto invCellSize = 1.0f / cellSize;
+
+        m_lastCellSize = cellSize;
+
+        m_ranges.resize(numProxies);
+        m_entries.clear();
+        m_oversize.clear();
+
+        for (std::uint32_t i = 0; i < numProxies; i++)
+        {
+            auto proxy = m_proxies[i];
+            auto& range = m_ranges[i];
+
+            std::uint32_t numCells(1);
+
+            for (int j = 0; j < 3; j++)
+            {
+                range.min[j] = CellCoord(proxy->m_aabbMin[j], invCellSize);
+                range.max[j] = CellCoord(proxy->m_aabbMax[j], invCellSize);
+
+                numCells *= static_cast<std::uint32_t>(std::min(range.max[j] - range.min[j] + 1, 1 << 10));
+            }
+
+            range.oversize = numCells > MAX_CELLS_PER_PROXY;
+
+            if (range.oversize)
+            {
+                m_oversize.emplace_back(i);
+                continue;
+            }
+
+            for (auto x = range.min[0]; x <= range.max[0]; x++)
+                for (auto y = range.min[1]; y <= range.max[1]; y++)
+                    for (auto z = range.min[2]; z <= range.max[2]; z++)
+                        m_entries.emplace_back(cellEntry_t{ CellKey(x, y, z), i });
+        }
+
+        std::sort(m_entries.begin(), m_entries.end(), [](auto& a_lhs, auto& a_rhs) {
+            return a_lhs.key < a_rhs.key;
+        });
+
+        auto numEntries = m_entries.size();
+
+        for (std::size_t begin = 0; begin < numEntries;)
+        {
+            auto key = m_entries[begin].key;
+
+            auto end = begin + 1;
+            while (end < numEntries && m_entries[end].key == key)
+                end++;
+
+            for (auto i = begin; i < end; i++)
+            {
+                auto ia = m_entries[i].proxy;
+                auto& ra = m_ranges[ia];
+
+                for (auto j = i + 1; j < end; j++)
+                {
+                    auto ib = m_entries[j].proxy;
+                    auto& rb = m_ranges[ib];
+
+                    // a pair sharing several cells is only taken from the first one they have in common
+                    auto first = CellKey(
+                        std::max(ra.min[0], rb.min[0]),
+                        std::max(ra.min[1], rb.min[1]),
+                        std::max(ra.min[2], rb.min[2]));
+
+                    if (first == key)
+                        AddPair(m_proxies[ia], m_proxies[ib]);
+                }
+            }
+
+            begin = end;
+        }
+
+        for (auto i : m_oversize)
+        {
+            auto proxy = m_proxies[i];
+
+            for (std::uint32_t j = 0; j < numProxies; j++)
+            {
+                // oversize pairs are taken once, by the lower index
+                if (j == i || (m_ranges[j].oversize && j < i))
+                    continue;
+
+                AddPair(proxy, m_proxies[j]);
+            }
+        }
+
+        // drop pairs which no longer overlap, removal moves the last pair into the freed slot
+        auto& pairs = m_pairCache->getOverlappingPairArray();
+
+        for (int i = pairs.size() - 1; i >= 0; i--)
+        {
+            auto p0 = pairs[i].m_pProxy0;
+            auto p1 = pairs[i].m_pProxy1;
+
+            if (!TestAabbAgainstAabb2(p0->m_aabbMin, p0->m_aabbMax, p1->m_aabbMin, p1->m_aabbMax))
+                m_pairCache->removeOverlappingPair(p0, p1, a_dispatcher);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+namespace CBP
+{
+    // uniform grid rebuilt from scratch every step. Costs the same no matter how far
+    // things moved, unlike the incremental DBVT and sweep and prune updates
+    class SpatialHashBroadphase :
+        public btBroadphaseInterface
+    {
+        struct proxy_t :
+            public btBroadphaseProxy
+        {
+            proxy_t(
+                const btVector3& a_aabbMin,
+                const btVector3& a_aabbMax,
+                void* a_userPtr,
+                int a_collisionFilterGroup,
+                int a_collisionFilterMask)
+                :
+                btBroadphaseProxy(a_aabbMin, a_aabbMax, a_userPtr, a_collisionFilterGroup, a_collisionFilterMask)
+            {
+            }
+
+            std::uint32_t m_index;
+        };
+
+        struct cellEntry_t
+        {
+            std::uint64_t key;
+            std::uint32_t proxy;
+        };
+
+        struct cellRange_t
+        {
+            std::int32_t min[3];
+            std::int32_t max[3];
+            bool oversize;
+        };
+
+    public:
+
+        // proxies spanning more cells are tested against everything instead
+        static constexpr std::uint32_t MAX_CELLS_PER_PROXY = 64;
+
+        static constexpr btScalar MIN_CELL_SIZE = 1.0f;
+        static constexpr btScalar MAX_CELL_SIZE = 1000.0f;
+
+        // 0 picks twice the mean proxy extent every step
+        SpatialHashBroadphase(btScalar a_cellSize = 0.0f);
+        virtual ~SpatialHashBroadphase() noexcept;
+
+        SpatialHashBroadphase(const SpatialHashBroadphase&) = delete;
+        SpatialHashBroadphase(SpatialHashBroadphase&&) = delete;
+        SpatialHashBroadphase& operator=(const SpatialHashBroadphase&) = delete;
+        SpatialHashBroadphase& operator=(SpatialHashBroadphase&&) = delete;
+
+        virtual btBroadphaseProxy* createProxy(
+            const btVector3& a_aabbMin,
+            const btVector3& a_aabbMax,
+            int a_shapeType,
+            void* a_userPtr,
+            int a_collisionFilterGroup,
+            int a_collisionFilterMask,
+            btDispatcher* a_dispatcher) override;
+
+        virtual void destroyProxy(btBroadphaseProxy* a_proxy, btDispatcher* a_dispatcher) override;
+
+        virtual void setAabb(
+            btBroadphaseProxy* a_proxy,
+            const btVector3& a_aabbMin,
+            const btVector3& a_aabbMax,
+            btDispatcher* a_dispatcher) override;
+
+        virtual void getAabb(btBroadphaseProxy* a_proxy, btVector3& a_aabbMin, btVector3& a_aabbMax) const override;
+
+        virtual void rayTest(
+            const btVector3& a_rayFrom,
+            const btVector3& a_rayTo,
+            btBroadphaseRayCallback& a_rayCallback,
+            const btVector3& a_aabbMin = btVector3(0, 0, 0),
+            const btVector3& a_aabbMax = btVector3(0, 0, 0)) override;
+
+        virtual void aabbTest(const btVector3& a_aabbMin, const btVector3& a_aabbMax, btBroadphaseAabbCallback& a_callback) override;
+
+        virtual void calculateOverlappingPairs(btDispatcher* a_dispatcher) override;
+
+        virtual btOverlappingPairCache* getOverlappingPairCache() override {
+            return m_pairCache.get();
+        }
+
+        virtual const btOverlappingPairCache* getOverlappingPairCache() const override {
+            return m_pairCache.get();
+        }
+
+        virtual void getBroadphaseAabb(btVector3& a_aabbMin, btVector3& a_aabbMax) const override;
+
+        virtual void printStats() override {}
+
+        SKMP_FORCEINLINE void SetCellSize(btScalar a_cellSize) {
+            m_cellSize = a_cellSize;
+        }
+
+        // size used by the last step
+        [[nodiscard]] SKMP_FORCEINLINE btScalar GetCellSize() const {
+            return m_lastCellSize;
+        }
+
+    private:
+
+        [[nodiscard]] btScalar ComputeCellSize() const;
+
+        void AddPair(proxy_t* a_p0, proxy_t* a_p1);
+
+        std::unique_ptr<btHashedOverlappingPairCache> m_pairCache;
+
+        std::vector<proxy_t*> m_proxies;
+        std::vector<cellRange_t> m_ranges;
+        std::vector<cellEntry_t> m_entries;
+        std::vector<std::uint32_t> m_oversize;
+
+        btScalar m_cellSize;
+        btScalar m_lastCellSize;
+
+        int m_nextUid{ 1 };
+    };
+}
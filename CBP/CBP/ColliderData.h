@@ -72,8 +72,7 @@ namespace CBP
         ColliderData() :
             m_numIndices(0),
             m_numVertices(0),
-            m_numTriangles(0),
-            m_size(sizeof(ColliderData))
+            m_numTriangles(0)
         {
         };
 
@@ -111,18 +110,13 @@ namespace CBP
 
         std::unique_ptr<btTriangleIndexVertexArray> m_triVertexArray;
 
-        SKMP_FORCEINLINE void UpdateSize(bool a_ignoreVertex = false) const;
-
-        SKMP_FORCEINLINE std::size_t GetSize() const {
-            return m_size;
-        }
+        // a_ignoreVertex when m_vertices belongs to the source storage
+        SKMP_FORCEINLINE std::size_t GetSize(bool a_ignoreVertex = false) const;
 
     private:
 
         SKMP_FORCEINLINE void __move(ColliderData&& a_rhs);
         SKMP_FORCEINLINE void __copy(const ColliderData& a_rhs);
-
-        mutable std::size_t m_size;
     };
 
     void ColliderData::__move(ColliderData&& a_rhs)
@@ -136,8 +130,6 @@ namespace CBP
         m_numIndices = a_rhs.m_numIndices;
 
         m_triVertexArray = std::move(a_rhs.m_triVertexArray);
-
-        UpdateSize();
     }
 
     void ColliderData::__copy(const ColliderData& a_rhs)
@@ -157,23 +149,24 @@ namespace CBP
         m_numIndices = a_rhs.m_numIndices;
 
         GenerateTriVertexArray();
-        UpdateSize();
     }
 
-    void ColliderData::UpdateSize(bool a_ignoreVertex) const
+    std::size_t ColliderData::GetSize(bool a_ignoreVertex) const
     {
-        m_size =
+        std::size_t size =
             sizeof(ColliderData) +
             sizeof(decltype(m_hullPoints)::element_type) * m_numIndices +
             sizeof(decltype(m_indices)::element_type) * m_numIndices;
 
         if (!a_ignoreVertex) {
-            m_size += sizeof(decltype(m_vertices)::element_type) * m_numVertices;
+            size += sizeof(decltype(m_vertices)::element_type) * m_numVertices;
         }
 
         if (m_triVertexArray.get()) {
-            m_size += sizeof(decltype(m_triVertexArray)::element_type);
+            size += sizeof(decltype(m_triVertexArray)::element_type);
         }
+
+        return size;
     }
 
     void ColliderData::GenerateTriVertexArray()
@@ -207,6 +200,9 @@ namespace CBP
 
         SKMP_FORCEINLINE void UpdateSize();
 
+        // the w lane is never initialized, anything written to disk goes through this so equal geometry gives equal bytes
+        SKMP_FORCEINLINE void CopyVerticesZeroW(stl::vector_simd<MeshPoint>& a_out) const;
+
         std::shared_ptr<MeshPoint[]> m_vertices;
         std::vector<float> m_weights;
         std::vector<unsigned int> m_indices;
@@ -214,6 +210,9 @@ namespace CBP
         int m_numTriangles;
         unsigned int m_numVertices;
 
+        // SHA1 of the arrays, empty until IBoneCast::HashGeometry fills it. Not serialized
+        std::string m_contentHash;
+
     private:
 
         template<class Archive>
@@ -268,6 +267,17 @@ namespace CBP
             m_indices.capacity() * sizeof(decltype(m_indices)::value_type);
     }
 
+    void ColliderDataStorage::CopyVerticesZeroW(stl::vector_simd<MeshPoint>& a_out) const
+    {
+        a_out.resize(m_numVertices);
+
+        for (unsigned int i = 0; i < m_numVertices; i++)
+        {
+            auto& v = m_vertices[i].v;
+            a_out[i].v.setValue(v.x(), v.y(), v.z());
+        }
+    }
+
     struct ColliderDataStoragePair
     {
     private:
@@ -317,6 +327,10 @@ namespace CBP
         SKMP_FORCEINLINE std::size_t UpdateSize();
         SKMP_FORCEINLINE void SetVerticesShared(bool a_switch);
 
+        SKMP_FORCEINLINE bool HasSharedVertices() const {
+            return m_hasSharedVertices;
+        }
+
     private:
         template<class Archive>
         void save(Archive& ar, const unsigned int version) const {
@@ -342,12 +356,11 @@ namespace CBP
     std::size_t ColliderDataStoragePair::UpdateSize()
     {
         first.UpdateSize();
-        second->UpdateSize(m_hasSharedVertices);
 
         return (m_size =
             sizeof(ColliderDataStoragePair) +
             first.GetSize() +
-            second->GetSize());
+            second->GetSize(m_hasSharedVertices));
     }
 
     void ColliderDataStoragePair::SetVerticesShared(bool a_switch)
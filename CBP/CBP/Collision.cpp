@@ -3,6 +3,8 @@
 #include "Collision.h"
 #include "ColliderData.h"
 #include "SimComponent.h"
+#include "ThreadPool.h"
+#include "Benchmark.h"
 
 namespace CBP
 {
@@ -230,31 +232,29 @@ namespace CBP
         ptrs.bt_collision_configuration = new btDefaultCollisionConfiguration(conf);
 
 #if BT_THREADSAFE
+        // also used by the dispatch benchmark when the live world is serial
+        m_Instance.m_scheduler = std::make_unique<BulletTaskScheduler>();
+        btSetTaskScheduler(m_Instance.m_scheduler.get());
+
         if (a_useThreading)
         {
-            auto ts = btCreateDefaultTaskScheduler();
-            btSetTaskScheduler(ts);
-
-            ASSERT(ts->getNumThreads() > 0);
-
-            //m_Instance.m_numThreads = ts->getNumThreads();
-
-            ptrs.bt_dispatcher = new btCollisionDispatcherMt(ptrs.bt_collision_configuration);
+            auto dispatcher = new PoolTrackingDispatcher<btCollisionDispatcherMt>(ptrs.bt_collision_configuration);
 
-            /*for (int i = 0; i < m_Instance.m_numThreads; i++) {
-                m_Instance.m_responseTasks.emplace_back();
-            }*/
+            ptrs.bt_dispatcher = dispatcher;
+            m_Instance.m_poolTracker = dispatcher;
         }
         else
         {
 #endif
-            ptrs.bt_dispatcher = new btCollisionDispatcher(ptrs.bt_collision_configuration);
+            auto dispatcher = new PoolTrackingDispatcher<btCollisionDispatcher>(ptrs.bt_collision_configuration);
+
+            ptrs.bt_dispatcher = dispatcher;
+            m_Instance.m_poolTracker = dispatcher;
 #if BT_THREADSAFE
-            //m_Instance.m_numThreads = 0;
         }
 #endif
 
-        ptrs.bt_broadphase = new btDbvtBroadphase();
+        ptrs.bt_broadphase = CreateBroadphase(m_Instance.m_broadphaseType);
 
         if (!a_useRelativeContactBreakingThreshold)
         {
@@ -270,6 +270,8 @@ namespace CBP
 
         btGImpactCollisionAlgorithm::registerAlgorithm(ptrs.bt_dispatcher);
 
+        ptrs.bt_dispatcher->setNearCallback(NearCallback);
+
     }
 
     void ICollision::Destroy()
@@ -280,48 +282,882 @@ namespace CBP
         delete ptrs.bt_broadphase;
         delete ptrs.bt_dispatcher;
         delete ptrs.bt_collision_configuration;
+
+        m_Instance.m_poolTracker = nullptr;
+        m_Instance.m_manifoldPool.reset();
+        m_Instance.m_algorithmPool.reset();
+
+#if BT_THREADSAFE
+        if (m_Instance.m_scheduler)
+        {
+            btSetTaskScheduler(btGetSequentialTaskScheduler());
+            m_Instance.m_scheduler.reset();
+        }
+#endif
+    }
+
+    CollisionIsland::CollisionIsland()
+    {
+        ICollision::RegisterIsland(this);
+    }
+
+    CollisionIsland::~CollisionIsland() noexcept
+    {
+        ICollision::UnregisterIsland(this);
+    }
+
+    btCollisionWorld* CollisionIsland::GetWorld()
+    {
+        if (!m_world)
+        {
+            auto& ptrs = ICollision::m_Instance.m_ptrs;
+
+            m_broadphase = std::make_unique<btDbvtBroadphase>();
+
+            // shares the dispatcher so manifolds end up where the response looks for them
+            m_world = std::make_unique<btCollisionWorld>(
+                ptrs.bt_dispatcher,
+                m_broadphase.get(),
+                ptrs.bt_collision_configuration);
+
+            m_world->getPairCache()->setOverlapFilterCallback(&ICollision::m_Instance.m_overlapFilter);
+        }
+
+        return m_world.get();
+    }
+
+    CollisionIsland* ICollision::GetIsland(const btCollisionObject* a_collider)
+    {
+        auto sc = static_cast<SimComponent*>(a_collider->getUserPointer());
+        return sc ? std::addressof(sc->GetCollisionIsland()) : nullptr;
+    }
+
+    btCollisionWorld* ICollision::GetObjectWorld(const btCollisionObject* a_collider)
+    {
+        auto island = GetIsland(a_collider);
+        return island && !island->m_shared ? island->GetWorld() : GetWorld();
+    }
+
+    void ICollision::RegisterIsland(CollisionIsland* a_island)
+    {
+        IScopedLock _(m_Instance.m_lock);
+
+        m_Instance.m_islands.emplace_back(a_island);
+    }
+
+    void ICollision::UnregisterIsland(CollisionIsland* a_island)
+    {
+        IScopedLock _(m_Instance.m_lock);
+
+        auto world = a_island->m_shared ? GetWorld() : a_island->m_world.get();
+
+        for (auto& e : a_island->m_objects)
+            world->removeCollisionObject(e);
+
+        auto& islands = m_Instance.m_islands;
+
+        auto it = std::find(islands.begin(), islands.end(), a_island);
+        if (it != islands.end())
+        {
+            *it = islands.back();
+            islands.pop_back();
+        }
     }
 
     void ICollision::CleanProxyFromPairs(btCollisionObject* a_collider)
     {
-#if 0
-        m_Instance.m_mutex.lock();
-#endif
+        // shape changes before the collider was activated
+        if (!a_collider->getBroadphaseHandle())
+            return;
 
-        GetWorld()->getPairCache()->cleanProxyFromPairs(
-            a_collider->getBroadphaseHandle(), GetWorld()->getDispatcher());
+        IScopedLock _(m_Instance.m_lock);
 
-#if 0
-        m_Instance.m_mutex.unlock();
-#endif
+        auto world = GetObjectWorld(a_collider);
+
+        world->getPairCache()->cleanProxyFromPairs(
+            a_collider->getBroadphaseHandle(), world->getDispatcher());
     }
 
     void ICollision::AddCollisionObject(btCollisionObject* a_collider)
     {
-#if 0
-        m_Instance.m_mutex.lock();
-#endif
+        IScopedLock _(m_Instance.m_lock);
 
-        GetWorld()->addCollisionObject(a_collider);
+        auto world = GetObjectWorld(a_collider);
 
-#if 0
-        m_Instance.m_mutex.unlock();
-#endif
+        if (world == GetWorld() &&
+            m_Instance.m_broadphaseType == BroadphaseType::SweepAndPrune &&
+            world->getNumCollisionObjects() >= static_cast<int>(SAP_MAX_HANDLES))
+        {
+            SetBroadphase(BroadphaseType::Dbvt);
+        }
+
+        world->addCollisionObject(a_collider);
+
+        if (auto island = GetIsland(a_collider))
+            island->m_objects.emplace_back(a_collider);
     }
+
     void ICollision::RemoveCollisionObject(btCollisionObject* a_collider)
     {
-#if 0
-        m_Instance.m_mutex.lock();
+        IScopedLock _(m_Instance.m_lock);
+
+        GetObjectWorld(a_collider)->removeCollisionObject(a_collider);
+
+        if (auto island = GetIsland(a_collider))
+        {
+            auto& objects = island->m_objects;
+
+            auto it = std::find(objects.begin(), objects.end(), a_collider);
+            if (it != objects.end())
+            {
+                *it = objects.back();
+                objects.pop_back();
+            }
+        }
+    }
+
+    void ICollision::MoveIsland(CollisionIsland& a_island, bool a_shared)
+    {
+        if (a_island.m_shared == a_shared)
+            return;
+
+        auto from = a_island.m_shared ? GetWorld() : a_island.GetWorld();
+        auto to = a_shared ? GetWorld() : a_island.GetWorld();
+
+        for (auto& e : a_island.m_objects)
+        {
+            from->removeCollisionObject(e);
+            to->addCollisionObject(e);
+        }
+
+        a_island.m_shared = a_shared;
+    }
+
+    void ICollision::UpdateIslands()
+    {
+        // keeps islands that just separated in the shared world a little longer
+        constexpr btScalar SEPARATION_MARGIN = 10.0f;
+
+        IScopedLock _(m_Instance.m_lock);
+
+        auto& islands = m_Instance.m_islands;
+
+        bool enabled = IConfig::GetGlobal().phys.collisionIslands;
+
+        if (enabled != m_Instance.m_islandsEnabled)
+        {
+            m_Instance.m_islandsEnabled = enabled;
+
+            if (!enabled)
+            {
+                for (auto& e : islands)
+                    MoveIsland(*e, true);
+            }
+        }
+
+        if (!enabled)
+            return;
+
+        for (auto& e : islands)
+        {
+            e->m_touching = false;
+
+            if (e->m_objects.empty())
+            {
+                e->m_radius = -1.0f;
+                continue;
+            }
+
+            btVector3 bmin, bmax;
+
+            auto& first = e->m_objects.front();
+            first->getCollisionShape()->getAabb(first->getWorldTransform(), bmin, bmax);
+
+            for (std::size_t i = 1; i < e->m_objects.size(); i++)
+            {
+                auto& object = e->m_objects[i];
+
+                btVector3 omin, omax;
+                object->getCollisionShape()->getAabb(object->getWorldTransform(), omin, omax);
+
+                bmin.setMin(omin);
+                bmax.setMax(omax);
+            }
+
+            e->m_center = (bmin + bmax) * 0.5f;
+            e->m_radius = (bmax - bmin).length() * 0.5f;
+        }
+
+        // few actors are loaded at once, all pairs is cheap enough
+        auto numIslands = islands.size();
+
+        for (std::size_t i = 0; i < numIslands; i++)
+        {
+            auto a = islands[i];
+
+            if (a->m_radius < 0.0f)
+                continue;
+
+            for (std::size_t j = i + 1; j < numIslands; j++)
+            {
+                auto b = islands[j];
+
+                if (b->m_radius < 0.0f)
+                    continue;
+
+                auto r = a->m_radius + b->m_radius;
+
+                if (a->m_shared && b->m_shared)
+                    r += SEPARATION_MARGIN;
+
+                if (a->m_center.distance2(b->m_center) < r * r)
+                {
+                    a->m_touching = true;
+                    b->m_touching = true;
+                }
+            }
+        }
+
+        for (auto& e : islands)
+            MoveIsland(*e, e->m_touching);
+    }
+
+    void ICollision::PerformIslandDetection()
+    {
+        if (!m_Instance.m_islandsEnabled)
+            return;
+
+        for (auto& e : m_Instance.m_islands)
+        {
+            // a single collider can't collide with itself
+            if (!e->m_shared && e->m_objects.size() > 1)
+                e->GetWorld()->performDiscreteCollisionDetection();
+        }
+    }
+
+    void ICollision::DebugDrawWorlds()
+    {
+        auto world = GetWorld();
+
+        world->debugDrawWorld();
+
+        if (!m_Instance.m_islandsEnabled)
+            return;
+
+        IScopedLock _(m_Instance.m_lock);
+
+        auto drawer = world->getDebugDrawer();
+
+        for (auto& e : m_Instance.m_islands)
+        {
+            if (e->m_shared || e->m_objects.empty())
+                continue;
+
+            auto islandWorld = e->GetWorld();
+
+            islandWorld->setDebugDrawer(drawer);
+            islandWorld->debugDrawWorld();
+        }
+    }
+
+    void ICollision::GetIslandStats(std::uint32_t& a_numIslands, std::uint32_t& a_numShared)
+    {
+        IScopedLock _(m_Instance.m_lock);
+
+        a_numIslands = 0;
+        a_numShared = 0;
+
+        for (auto& e : m_Instance.m_islands)
+        {
+            if (e->m_objects.empty())
+                continue;
+
+            a_numIslands++;
+
+            if (e->m_shared)
+                a_numShared++;
+        }
+    }
+
+    btBroadphaseInterface* ICollision::CreateBroadphase(BroadphaseType a_type)
+    {
+        switch (a_type)
+        {
+        case BroadphaseType::SweepAndPrune:
+            return new bt32BitAxisSweep3(
+                btVector3(-SAP_WORLD_EXTENT, -SAP_WORLD_EXTENT, -SAP_WORLD_EXTENT),
+                btVector3(SAP_WORLD_EXTENT, SAP_WORLD_EXTENT, SAP_WORLD_EXTENT),
+                SAP_MAX_HANDLES);
+        case BroadphaseType::SpatialHash:
+            return new SpatialHashBroadphase(IConfig::GetGlobal().phys.broadphaseCellSize);
+        default:
+            return new btDbvtBroadphase();
+        }
+    }
+
+    static void DetachObjects(btCollisionWorld* a_world, std::vector<btCollisionObject*>& a_out)
+    {
+        auto& objects = a_world->getCollisionObjectArray();
+
+        a_out.reserve(a_out.size() + objects.size());
+
+        for (int i = 0; i < objects.size(); i++)
+            a_out.emplace_back(objects[i]);
+
+        while (objects.size())
+            a_world->removeCollisionObject(objects[objects.size() - 1]);
+    }
+
+    void ICollision::SetBroadphase(BroadphaseType a_type)
+    {
+        IScopedLock _(m_Instance.m_lock);
+
+        auto& ptrs = m_Instance.m_ptrs;
+        auto world = ptrs.bt_collision_world;
+
+        // proxies can't be handed over, objects are re-added which drops their pairs and manifolds
+        std::vector<btCollisionObject*> tmp;
+        DetachObjects(world, tmp);
+
+        auto broadphase = CreateBroadphase(a_type);
+        broadphase->getOverlappingPairCache()->setOverlapFilterCallback(&m_Instance.m_overlapFilter);
+
+        world->setBroadphase(broadphase);
+
+        delete ptrs.bt_broadphase;
+        ptrs.bt_broadphase = broadphase;
+
+        m_Instance.m_broadphaseType = a_type;
+        m_Instance.m_broadphaseTicks = 0;
+        m_Instance.m_broadphaseSteps = 0;
+        m_Instance.m_spatialHash = a_type == BroadphaseType::SpatialHash ?
+            static_cast<SpatialHashBroadphase*>(broadphase) : nullptr;
+
+        for (auto& e : tmp)
+            world->addCollisionObject(e);
+    }
+
+    void ICollision::SampleBroadphaseMotion(float a_timeStep)
+    {
+        // picks are made every AUTO_EVAL_STEPS and have to come out the same twice in a row
+        constexpr std::uint32_t AUTO_EVAL_STEPS = 120;
+        // below this DBVT is as good as anything
+        constexpr std::uint64_t AUTO_MIN_PROXIES = 64;
+        // mean displacement per step relative to proxy size, SAP swaps stay cheap under it
+        constexpr double AUTO_SAP_MAX_MOTION = 0.05;
+
+        auto& state = m_Instance.m_auto;
+
+        auto& objects = GetWorld()->getCollisionObjectArray();
+        auto numObjects = objects.size();
+
+        double motion(0.0);
+
+        for (int i = 0; i < numObjects; i++)
+        {
+            auto object = objects[i];
+
+            auto sc = static_cast<const SimComponent*>(object->getUserPointer());
+            auto proxy = object->getBroadphaseHandle();
+
+            if (!sc || !proxy)
+                continue;
+
+            auto extent(proxy->m_aabbMax - proxy->m_aabbMin);
+            auto size = extent[extent.maxAxis()];
+
+            if (size > _EPSILON)
+                motion += static_cast<double>(sc->GetVelocity().length() * a_timeStep / size);
+        }
+
+        if (numObjects > 0)
+            state.motion += motion / static_cast<double>(numObjects);
+
+        state.numProxies += static_cast<std::uint64_t>(numObjects);
+        state.numSteps++;
+
+        if (state.numSteps < AUTO_EVAL_STEPS)
+            return;
+
+        auto avgProxies = state.numProxies / state.numSteps;
+        auto avgMotion = state.motion / static_cast<double>(state.numSteps);
+
+        BroadphaseType pick;
+
+        if (avgProxies < AUTO_MIN_PROXIES)
+            pick = BroadphaseType::Dbvt;
+        else if (avgMotion < AUTO_SAP_MAX_MOTION && avgProxies < SAP_MAX_HANDLES / 2)
+            pick = BroadphaseType::SweepAndPrune;
+        else
+            pick = BroadphaseType::SpatialHash;
+
+        if (pick == state.candidate)
+            state.selected = pick;
+
+        state.candidate = pick;
+        state.motion = 0.0;
+        state.numProxies = 0;
+        state.numSteps = 0;
+    }
+
+    void ICollision::UpdateBroadphase(float a_timeStep)
+    {
+        const auto& physConf = IConfig::GetGlobal().phys;
+
+        auto type = physConf.broadphase;
+
+        if (type == BroadphaseType::Auto)
+        {
+            SampleBroadphaseMotion(a_timeStep);
+            type = m_Instance.m_auto.selected;
+        }
+
+        // leave some room so it doesn't flip back and forth around the limit
+        if (type == BroadphaseType::SweepAndPrune &&
+            GetWorld()->getNumCollisionObjects() >= static_cast<int>(SAP_MAX_HANDLES * 3 / 4))
+        {
+            type = BroadphaseType::Dbvt;
+        }
+
+        if (type != m_Instance.m_broadphaseType)
+            SetBroadphase(type);
+
+        if (m_Instance.m_spatialHash)
+            m_Instance.m_spatialHash->SetCellSize(physConf.broadphaseCellSize);
+    }
+
+    void ICollision::btPerformCollisionDetection()
+    {
+        auto world = GetWorld();
+
+        auto start = IPerfCounter::Query();
+
+        world->updateAabbs();
+        world->computeOverlappingPairs();
+
+        m_Instance.m_broadphaseTicks += IPerfCounter::Query() - start;
+        m_Instance.m_broadphaseSteps++;
+
+        auto dispatcher = m_Instance.m_ptrs.bt_dispatcher;
+
+        dispatcher->dispatchAllCollisionPairs(world->getPairCache(), world->getDispatchInfo(), dispatcher);
+    }
+
+    static btPoolAllocator* GetManifoldPool(
+        btCollisionConfiguration* a_config,
+        const std::unique_ptr<btPoolAllocator>& a_pool)
+    {
+        return a_pool ? a_pool.get() : a_config->getPersistentManifoldPool();
+    }
+
+    static btPoolAllocator* GetAlgorithmPool(
+        btCollisionConfiguration* a_config,
+        const std::unique_ptr<btPoolAllocator>& a_pool)
+    {
+        return a_pool ? a_pool.get() : a_config->getCollisionAlgorithmPool();
+    }
+
+    void ICollision::SamplePools()
+    {
+        auto& pools = m_Instance.m_pools;
+        auto config = m_Instance.m_ptrs.bt_collision_configuration;
+
+        auto manifoldPool = GetManifoldPool(config, m_Instance.m_manifoldPool);
+        auto algorithmPool = GetAlgorithmPool(config, m_Instance.m_algorithmPool);
+
+        // pooled or not, every manifold is in the dispatcher's list
+        auto numManifolds = static_cast<std::uint32_t>(GetDispatcher()->getNumManifolds());
+        auto numAlgorithms = static_cast<std::uint32_t>(algorithmPool->getUsedCount()) +
+            static_cast<std::uint32_t>(std::max(m_Instance.m_poolTracker->m_algorithmOverflowsLive.load(std::memory_order_relaxed), 0));
+
+        pools.numManifolds = numManifolds;
+        pools.manifoldPeak = std::max(pools.manifoldPeak, numManifolds);
+        pools.algorithmPeak = std::max(pools.algorithmPeak, numAlgorithms);
+
+        if (numManifolds > static_cast<std::uint32_t>(manifoldPool->getMaxCount()) ||
+            numAlgorithms > static_cast<std::uint32_t>(algorithmPool->getMaxCount()))
+        {
+            pools.grow = IConfig::GetGlobal().phys.poolAutoGrow;
+        }
+    }
+
+    static std::uint32_t GetGrownPoolSize(std::uint32_t a_peak, int a_current, std::uint32_t a_limit)
+    {
+        auto size = std::bit_ceil(a_peak + a_peak / 4);
+        // never shrinks, the ini may ask for more than the limit
+        return std::max(std::min(size, a_limit), static_cast<std::uint32_t>(a_current));
+    }
+
+    void ICollision::GrowPools()
+    {
+        IScopedLock _(m_Instance.m_lock);
+
+        auto& pools = m_Instance.m_pools;
+
+        pools.grow = false;
+
+        auto config = m_Instance.m_ptrs.bt_collision_configuration;
+
+        auto manifoldPool = GetManifoldPool(config, m_Instance.m_manifoldPool);
+        auto algorithmPool = GetAlgorithmPool(config, m_Instance.m_algorithmPool);
+
+        auto manifoldSize = GetGrownPoolSize(pools.manifoldPeak, manifoldPool->getMaxCount(), POOL_SIZE_LIMIT);
+        auto algorithmSize = GetGrownPoolSize(pools.algorithmPeak, algorithmPool->getMaxCount(), POOL_SIZE_LIMIT);
+
+        if (manifoldSize == static_cast<std::uint32_t>(manifoldPool->getMaxCount()) &&
+            algorithmSize == static_cast<std::uint32_t>(algorithmPool->getMaxCount()))
+        {
+            return;
+        }
+
+        // everything has to go back to the pool it came from first, removing the objects
+        // frees all pairs along with their algorithms and manifolds
+        std::vector<btCollisionObject*> shared;
+        std::vector<std::pair<CollisionIsland*, std::vector<btCollisionObject*>>> islands;
+
+        DetachObjects(GetWorld(), shared);
+
+        for (auto& e : m_Instance.m_islands)
+        {
+            if (e->m_world && e->m_world->getNumCollisionObjects())
+                DetachObjects(e->m_world.get(), islands.emplace_back(e, std::vector<btCollisionObject*>()).second);
+        }
+
+        auto tracker = m_Instance.m_poolTracker;
+
+        if (GetDispatcher()->getNumManifolds() == 0 &&
+            algorithmPool->getUsedCount() == 0 &&
+            tracker->m_algorithmOverflowsLive.load(std::memory_order_relaxed) == 0)
+        {
+            auto newManifoldPool = std::make_unique<btPoolAllocator>(
+                manifoldPool->getElementSize(), static_cast<int>(manifoldSize));
+
+            auto newAlgorithmPool = std::make_unique<btPoolAllocator>(
+                algorithmPool->getElementSize(), static_cast<int>(algorithmSize));
+
+            tracker->SetPools(newManifoldPool.get(), newAlgorithmPool.get());
+
+            m_Instance.m_manifoldPool = std::move(newManifoldPool);
+            m_Instance.m_algorithmPool = std::move(newAlgorithmPool);
+
+            pools.numResizes++;
+        }
+
+        for (auto& e : shared)
+            GetWorld()->addCollisionObject(e);
+
+        for (auto& e : islands)
+        {
+            for (auto& f : e.second)
+                e.first->m_world->addCollisionObject(f);
+        }
+    }
+
+    void ICollision::GetPoolStats(poolStats_t& a_out)
+    {
+        const auto& pools = m_Instance.m_pools;
+        auto config = m_Instance.m_ptrs.bt_collision_configuration;
+        auto tracker = m_Instance.m_poolTracker;
+
+        auto manifoldPool = GetManifoldPool(config, m_Instance.m_manifoldPool);
+        auto algorithmPool = GetAlgorithmPool(config, m_Instance.m_algorithmPool);
+
+        a_out.manifoldPoolSize = static_cast<std::uint32_t>(manifoldPool->getMaxCount());
+        a_out.manifoldsUsed = static_cast<std::uint32_t>(manifoldPool->getUsedCount());
+        a_out.manifoldPeak = pools.manifoldPeak;
+        a_out.manifoldOverflows = tracker->m_manifoldOverflows.load(std::memory_order_relaxed);
+
+        a_out.algorithmPoolSize = static_cast<std::uint32_t>(algorithmPool->getMaxCount());
+        a_out.algorithmsUsed = static_cast<std::uint32_t>(algorithmPool->getUsedCount());
+        a_out.algorithmPeak = pools.algorithmPeak;
+        a_out.algorithmOverflows = tracker->m_algorithmOverflows.load(std::memory_order_relaxed);
+
+        a_out.numManifolds = pools.numManifolds;
+        a_out.numResizes = pools.numResizes;
+    }
+
+    btScalar ICollision::GetBroadphaseCellSize()
+    {
+        return m_Instance.m_spatialHash ? m_Instance.m_spatialHash->GetCellSize() : 0.0f;
+    }
+
+    void ICollision::ConsumeBroadphaseStats(BroadphaseType& a_type, long long& a_ticks, std::uint32_t& a_steps)
+    {
+        a_type = m_Instance.m_broadphaseType;
+        a_ticks = m_Instance.m_broadphaseTicks;
+        a_steps = m_Instance.m_broadphaseSteps;
+
+        m_Instance.m_broadphaseTicks = 0;
+        m_Instance.m_broadphaseSteps = 0;
+    }
+
+    void ICollision::NearCallback(
+        btBroadphasePair& a_pair,
+        btCollisionDispatcher& a_dispatcher,
+        const btDispatcherInfo& a_info)
+    {
+        auto o1 = static_cast<btCollisionObject*>(a_pair.m_pProxy0->m_clientObject);
+        auto o2 = static_cast<btCollisionObject*>(a_pair.m_pProxy1->m_clientObject);
+
+        if (!m_Instance.m_nativeNarrowphase ||
+            !Narrowphase::IsSupported(o1->getCollisionShape()) ||
+            !Narrowphase::IsSupported(o2->getCollisionShape()))
+        {
+            btCollisionDispatcher::defaultNearCallback(a_pair, a_dispatcher, a_info);
+            return;
+        }
+
+        if (!a_dispatcher.needsCollision(o1, o2))
+            return;
+
+        Narrowphase::shape_t sa, sb;
+
+        Narrowphase::GetShape(o1, sa);
+        Narrowphase::GetShape(o2, sb);
+
+        btVector3 normalOnB;
+        btScalar depth;
+
+        if (!Narrowphase::Collide(sa, sb, normalOnB, depth))
+            return;
+
+#if BT_THREADSAFE
+        auto& contacts = m_Instance.m_contacts[btGetCurrentThreadIndex()];
+#else
+        auto& contacts = m_Instance.m_contacts[0];
 #endif
 
-        GetWorld()->removeCollisionObject(a_collider);
+        auto& contact = contacts.emplace_back();
+
+        contact.normalOnB = normalOnB;
+        contact.depth = depth;
+        contact.a = static_cast<SimComponent*>(o1->getUserPointer());
+        contact.b = static_cast<SimComponent*>(o2->getUserPointer());
+    }
+
+    static void CleanNativePairs(btCollisionWorld* a_world)
+    {
+        auto pairCache = a_world->getPairCache();
+        auto& pairs = pairCache->getOverlappingPairArray();
+
+        for (int i = 0; i < pairs.size(); i++)
+        {
+            auto& pair = pairs[i];
+
+            if (!pair.m_algorithm)
+                continue;
+
+            auto o1 = static_cast<const btCollisionObject*>(pair.m_pProxy0->m_clientObject);
+            auto o2 = static_cast<const btCollisionObject*>(pair.m_pProxy1->m_clientObject);
 
-#if 0
-        m_Instance.m_mutex.unlock();
+            if (Narrowphase::IsSupported(o1->getCollisionShape()) &&
+                Narrowphase::IsSupported(o2->getCollisionShape()))
+            {
+                pairCache->cleanOverlappingPair(pair, a_world->getDispatcher());
+            }
+        }
+    }
+
+    void ICollision::BeginCollisionDetection(float a_timeStep)
+    {
+#if BT_THREADSAFE
+        {
+            const auto& physConf = IConfig::GetGlobal().phys;
+
+            std::uint32_t minItems = physConf.mtDispatch ?
+                static_cast<std::uint32_t>(physConf.mtDispatchMinPairs) :
+                std::numeric_limits<std::uint32_t>::max();
+
+            // only on change, the dispatch benchmark adjusts the scheduler while it runs
+            if (minItems != m_Instance.m_dispatchMinItems ||
+                physConf.mtDispatchThreads != m_Instance.m_dispatchThreads)
+            {
+                m_Instance.m_dispatchMinItems = minItems;
+                m_Instance.m_dispatchThreads = physConf.mtDispatchThreads;
+
+                m_Instance.m_scheduler->SetMinItems(minItems);
+                m_Instance.m_scheduler->setNumThreads(physConf.mtDispatchThreads);
+            }
+        }
 #endif
+
+        bool native = IConfig::GetGlobal().phys.nativeNarrowphase;
+
+        if (native != m_Instance.m_nativeNarrowphase)
+        {
+            m_Instance.m_nativeNarrowphase = native;
+
+            // pairs found before the switch still own an algorithm and a manifold which would keep producing contacts
+            if (native)
+            {
+                CleanNativePairs(GetWorld());
+
+                for (auto& e : m_Instance.m_islands)
+                {
+                    if (e->m_world)
+                        CleanNativePairs(e->m_world.get());
+                }
+            }
+        }
+
+        if (m_Instance.m_pools.grow)
+            GrowPools();
+
+        UpdateBroadphase(a_timeStep);
+        UpdateIslands();
+
+        for (auto& e : m_Instance.m_contacts)
+            e.clear();
+    }
+
+    void ICollision::SetupResponsePair(
+        SimComponent* a_sca,
+        SimComponent* a_scb,
+        responsePair_t& a_out)
+    {
+        auto& confa = a_sca->GetConfig();
+        auto& confb = a_scb->GetConfig();
+
+        a_out.sca = a_sca;
+        a_out.scb = a_scb;
+
+        a_out.mova = a_sca->HasMotion();
+        a_out.movb = a_scb->HasMotion();
+
+        a_out.mia = a_sca->GetMassInverse();
+        a_out.mib = a_scb->GetMassInverse();
+        a_out.miab = a_out.mia + a_out.mib;
+
+        a_out.pbf = std::max(confa.fp.f32.colPenBiasFactor, confb.fp.f32.colPenBiasFactor);
+        a_out.pmi = 1.0f / std::max(confa.fp.f32.colPenMass, confb.fp.f32.colPenMass);
+        a_out.rc = 1.0f + std::max(confa.fp.f32.colRestitutionCoefficient, confb.fp.f32.colRestitutionCoefficient);
+
+        a_out.friction = (a_sca->HasFriction() || a_scb->HasFriction());
+
+        if (a_out.friction) {
+            a_out.fc = confa.fp.f32.colFriction * confb.fp.f32.colFriction;
+        }
+    }
+
+    void ICollision::ResolveContact(
+        const responsePair_t& a_pair,
+        const btVector3& a_normalOnB,
+        btScalar a_depth,
+        float a_timeStep)
+    {
+        auto& p = a_pair;
+        auto& cn = a_normalOnB;
+
+        auto deltaV(p.scb->GetVelocity() - p.sca->GetVelocity());
+
+        auto impulse = cn.dot(deltaV);
+
+        if (a_depth > 0.01f) {
+            impulse += (a_timeStep * (2880.0f * p.pbf)) * std::max(a_depth - 0.01f, 0.0f);
+        }
+
+        if (impulse > 0.0f)
+        {
+            auto Jm = impulse / p.miab * p.rc;
+
+            if (p.mova)
+            {
+                p.sca->AddVelocity(cn * (Jm * p.mia * p.pmi));
+            }
+
+            if (p.movb)
+            {
+                p.scb->SubVelocity(cn * (Jm * p.mib * p.pmi));
+            }
+        }
+
+        if (p.friction)
+        {
+            btVector3 fn;
+
+            impulse = GetFrictionImpulse(deltaV, cn, fn);
+
+            if (impulse > 0.0f)
+            {
+                auto Jm = impulse / p.miab * p.fc;
+
+                if (p.mova)
+                {
+                    p.sca->AddVelocity(fn * (Jm * p.mia));
+                }
+
+                if (p.movb)
+                {
+                    p.scb->SubVelocity(fn * (Jm * p.mib));
+                }
+            }
+        }
     }
 
-    void ICollision::PerformCollisionResponse(
+    void ICollision::RespondManifold(
+        const btPersistentManifold* a_manifold,
+        float a_timeStep)
+    {
+        auto numContacts = a_manifold->getNumContacts();
+
+        const auto oba = a_manifold->getBody0();
+        const auto obb = a_manifold->getBody1();
+
+        responsePair_t pair;
+
+        SetupResponsePair(
+            static_cast<SimComponent*>(oba->getUserPointer()),
+            static_cast<SimComponent*>(obb->getUserPointer()),
+            pair);
+
+        for (decltype(numContacts) j = 0; j < numContacts; j++)
+        {
+            auto& contactPoint = a_manifold->getContactPoint(j);
+
+            auto depth = contactPoint.getDistance();
+            if (depth >= 0.0f) {
+                continue;
+            }
+
+            ResolveContact(pair, contactPoint.m_normalWorldOnB, -depth, a_timeStep);
+        }
+    }
+
+    void ICollision::RespondContact(
+        const Narrowphase::contact_t& a_contact,
+        float a_timeStep)
+    {
+        responsePair_t pair;
+
+        SetupResponsePair(a_contact.a, a_contact.b, pair);
+        ResolveContact(pair, a_contact.normalOnB, a_contact.depth, a_timeStep);
+    }
+
+    void ICollision::PerformCollisionResponse(float a_timeStep)
+    {
+        int numManifolds = GetDispatcher()->getNumManifolds();
+
+        std::size_t numPairs(numManifolds);
+
+        for (auto& e : m_Instance.m_contacts)
+            numPairs += e.size();
+
+        auto minPairs = IConfig::GetGlobal().phys.parallelResponseMin;
+
+        if (minPairs > 0 &&
+            numPairs >= static_cast<std::size_t>(minPairs) &&
+            IThreadPool::GetNumThreads() > 0)
+        {
+            PerformParallelCollisionResponse(numManifolds, a_timeStep);
+        }
+        else
+        {
+            PerformManifoldResponse(0, numManifolds, a_timeStep);
+            PerformNativeCollisionResponse(a_timeStep);
+        }
+    }
+
+    void ICollision::PerformManifoldResponse(
         int a_low,
         int a_high,
         float a_timeStep)
@@ -332,112 +1168,292 @@ namespace CBP
         {
             auto contactManifold = dispatcher->getManifoldByIndexInternal(i);
 
-            auto numContacts = contactManifold->getNumContacts();
-
-            if (!numContacts) {
+            if (!contactManifold->getNumContacts()) {
                 continue;
             }
 
-            const auto oba = contactManifold->getBody0();
-            const auto obb = contactManifold->getBody1();
+            RespondManifold(contactManifold, a_timeStep);
+        }
+    }
+
+    void ICollision::PerformNativeCollisionResponse(float a_timeStep)
+    {
+        for (auto& contacts : m_Instance.m_contacts)
+        {
+            for (auto& e : contacts)
+            {
+                RespondContact(e, a_timeStep);
+            }
+        }
+    }
+
+    /*
+        A job gets the colour after the last one that touched either of its moving components, in serial order.
+        Jobs of one colour never share a written component and every component sees its jobs in the same order
+        as the serial loop, so each colour can run in parallel and the result matches the serial path exactly.
+        Components without motion are only read and don't constrain the colouring.
+    */
+    void ICollision::AddResponseJob(
+        const btPersistentManifold* a_manifold,
+        const Narrowphase::contact_t* a_contact,
+        SimComponent* a_sca,
+        SimComponent* a_scb)
+    {
+        auto pass = m_Instance.m_responsePass;
+
+        auto mova = a_sca->HasMotion();
+        auto movb = a_scb->HasMotion();
+
+        std::uint32_t colour = std::max(
+            mova ? a_sca->GetResponseColour(pass) : 0U,
+            movb ? a_scb->GetResponseColour(pass) : 0U) + 1;
+
+        if (mova)
+            a_sca->SetResponseColour(pass, colour);
 
-            auto sca = static_cast<SimComponent*>(oba->getUserPointer());
-            auto scb = static_cast<SimComponent*>(obb->getUserPointer());
+        if (movb)
+            a_scb->SetResponseColour(pass, colour);
 
-            auto& confa = sca->GetConfig();
-            auto& confb = scb->GetConfig();
+        m_Instance.m_numColours = std::max(m_Instance.m_numColours, colour);
+        m_Instance.m_jobs.emplace_back(responseJob_t{ a_manifold, a_contact, colour });
+    }
+
+    void ICollision::PerformParallelCollisionResponse(
+        int a_numManifolds,
+        float a_timeStep)
+    {
+        auto& inst = m_Instance;
 
-            auto mova = sca->HasMotion();
-            auto movb = scb->HasMotion();
+        // 0 is never a valid pass so components that were never coloured read as uncoloured
+        if (++inst.m_responsePass == 0)
+            inst.m_responsePass = 1;
 
-            auto mia = sca->GetMassInverse();
-            auto mib = scb->GetMassInverse();
-            auto miab = mia + mib;
+        inst.m_jobs.clear();
+        inst.m_numColours = 0;
 
-            auto pbf = std::max(confa.fp.f32.colPenBiasFactor, confb.fp.f32.colPenBiasFactor);
-            auto pmi = 1.0f / std::max(confa.fp.f32.colPenMass, confb.fp.f32.colPenMass);
-            auto rc = 1.0f + std::max(confa.fp.f32.colRestitutionCoefficient, confb.fp.f32.colRestitutionCoefficient);
+        auto dispatcher = GetDispatcher();
 
-            float fc;
-            auto friction = (sca->HasFriction() || scb->HasFriction());
+        for (int i = 0; i < a_numManifolds; i++)
+        {
+            auto contactManifold = dispatcher->getManifoldByIndexInternal(i);
 
-            if (friction) {
-                fc = confa.fp.f32.colFriction * confb.fp.f32.colFriction;
+            if (!contactManifold->getNumContacts()) {
+                continue;
             }
 
-#if 0
-            sc1->Lock();
-            sc2->Lock();
-#endif
+            AddResponseJob(
+                contactManifold,
+                nullptr,
+                static_cast<SimComponent*>(contactManifold->getBody0()->getUserPointer()),
+                static_cast<SimComponent*>(contactManifold->getBody1()->getUserPointer()));
+        }
 
-            for (decltype(numContacts) j = 0; j < numContacts; j++)
+        for (auto& contacts : inst.m_contacts)
+        {
+            for (auto& e : contacts)
             {
-                auto& contactPoint = contactManifold->getContactPoint(j);
+                AddResponseJob(nullptr, std::addressof(e), e.a, e.b);
+            }
+        }
 
-                auto depth = contactPoint.getDistance();
-                if (depth >= 0.0f) {
-                    continue;
-                }
+        auto numColours = inst.m_numColours;
 
-                depth = -depth;
+        // counting sort by colour, stable so jobs keep serial order within a colour
+        auto& offsets = inst.m_colourOffsets;
+        offsets.assign(std::size_t(numColours) + 2, 0);
 
-                auto& cn = contactPoint.m_normalWorldOnB;
+        for (auto& e : inst.m_jobs)
+            offsets[e.colour + 1]++;
 
-                auto deltaV(scb->GetVelocity() - sca->GetVelocity());
+        for (std::uint32_t i = 1; i <= numColours + 1; i++)
+            offsets[i] += offsets[i - 1];
 
-                auto impulse = cn.dot(deltaV);
+        auto& sorted = inst.m_sortedJobs;
+        sorted.resize(inst.m_jobs.size());
 
-                if (depth > 0.01f) {
-                    impulse += (a_timeStep * (2880.0f * pbf)) * std::max(depth - 0.01f, 0.0f);
-                }
+        for (auto& e : inst.m_jobs)
+            sorted[offsets[e.colour]++] = e;
 
-                if (impulse > 0.0f)
-                {
-                    auto Jm = impulse / miab * rc;
+        // offsets[c] now points at the end of colour c
+        auto jobs = sorted.data();
 
-                    if (mova)
-                    {
-                        sca->AddVelocity(cn * (Jm * mia * pmi));
-                    }
+        std::uint32_t begin = 0;
 
-                    if (movb)
+        for (std::uint32_t c = 1; c <= numColours; c++)
+        {
+            auto end = offsets[c];
+
+            auto colourJobs = jobs + begin;
+
+            IThreadPool::ParallelFor(end - begin, 32,
+                [&](std::uint32_t a_begin, std::uint32_t a_end)
+                {
+                    for (auto i = a_begin; i < a_end; i++)
                     {
-                        scb->SubVelocity(cn * (Jm * mib * pmi));
+                        auto& e = colourJobs[i];
+
+                        if (e.manifold)
+                            RespondManifold(e.manifold, a_timeStep);
+                        else
+                            RespondContact(*e.contact, a_timeStep);
                     }
-                }
+                });
 
-                if (friction)
-                {
-                    btVector3 fn;
+            begin = end;
+        }
+    }
 
-                    impulse = GetFrictionImpulse(deltaV, cn, fn);
+    static void CreateBenchmarkActors(
+        std::uint32_t a_numActors,
+        std::vector<std::unique_ptr<btCollisionShape>>& a_shapes,
+        std::vector<std::unique_ptr<btCollisionObject>>& a_objects)
+    {
+        // roughly a body with breast, butt, belly and thigh nodes, per actor
+        constexpr std::uint32_t NUM_COLLIDERS = 16;
+        constexpr btScalar ACTOR_SPACING = 90.0f;
 
-                    if (impulse > 0.0f)
-                    {
-                        auto Jm = impulse / miab * fc;
+        BenchmarkRandom rnd(0x6C8E9CF5);
 
-                        if (mova)
-                        {
-                            sca->AddVelocity(fn * (Jm * mia));
-                        }
+        auto side = static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<float>(a_numActors))));
 
-                        if (movb)
-                        {
-                            scb->SubVelocity(fn * (Jm * mib));
-                        }
-                    }
-                }
+        for (std::uint32_t i = 0; i < a_numActors; i++)
+        {
+            btVector3 base(
+                static_cast<float>(i % side) * ACTOR_SPACING,
+                static_cast<float>(i / side) * ACTOR_SPACING,
+                0.0f);
+
+            for (std::uint32_t j = 0; j < NUM_COLLIDERS; j++)
+            {
+                auto radius = 3.0f + rnd.Unit() * 5.0f;
 
+                if (j & 1)
+                    a_shapes.emplace_back(std::make_unique<btSphereShape>(radius));
+                else
+                    a_shapes.emplace_back(std::make_unique<btCapsuleShape>(radius, 6.0f + rnd.Unit() * 14.0f));
+
+                btVector3 axis(rnd.Unit() - 0.5f, rnd.Unit() - 0.5f, rnd.Unit() - 0.5f);
+                if (axis.length2() < 0.01f)
+                    axis.setValue(0.0f, 0.0f, 1.0f);
+
+                auto& object = a_objects.emplace_back(std::make_unique<btCollisionObject>());
+
+                object->setCollisionShape(a_shapes.back().get());
+                object->setWorldTransform(btTransform(
+                    btQuaternion(axis.normalized(), rnd.Unit() * std::numbers::pi_v<float>),
+                    base + btVector3((rnd.Unit() - 0.5f) * 30.0f, (rnd.Unit() - 0.5f) * 20.0f, 60.0f + rnd.Unit() * 70.0f)));
             }
+        }
+    }
 
-#if 0
-            sc2->Unlock();
-            sc1->Unlock();
-#endif
+    static long long RunBenchmarkScene(
+        btCollisionDispatcher* a_dispatcher,
+        btCollisionConfiguration* a_config,
+        std::vector<std::unique_ptr<btCollisionObject>>& a_objects,
+        std::uint32_t a_numSteps,
+        dispatchBenchmarkResult_t::entry_t& a_out)
+    {
+        btDbvtBroadphase broadphase;
+        btCollisionWorld world(a_dispatcher, std::addressof(broadphase), a_config);
+
+        std::vector<btVector3> origins;
+        origins.reserve(a_objects.size());
 
+        for (auto& e : a_objects)
+        {
+            origins.emplace_back(e->getWorldTransform().getOrigin());
+            world.addCollisionObject(e.get());
         }
+
+        // warm up pairs and manifolds, then time the steady state
+        world.performDiscreteCollisionDetection();
+
+        long long total(0);
+
+        for (std::uint32_t i = 0; i < a_numSteps; i++)
+        {
+            auto phase = static_cast<float>(i) * 0.4f;
+
+            for (std::size_t j = 0; j < a_objects.size(); j++)
+            {
+                auto offset = std::sinf(phase + static_cast<float>(j)) * 1.5f;
+
+                a_objects[j]->getWorldTransform().setOrigin(
+                    origins[j] + btVector3(offset, -offset, offset * 0.5f));
+            }
+
+            auto start = IPerfCounter::Query();
+
+            world.performDiscreteCollisionDetection();
+
+            total += IPerfCounter::Query() - start;
+        }
+
+        a_out.numPairs = static_cast<std::uint32_t>(world.getPairCache()->getNumOverlappingPairs());
+        a_out.numManifolds = static_cast<std::uint32_t>(a_dispatcher->getNumManifolds());
+
+        for (std::size_t j = 0; j < a_objects.size(); j++)
+        {
+            a_objects[j]->getWorldTransform().setOrigin(origins[j]);
+            world.removeCollisionObject(a_objects[j].get());
+        }
+
+        return IPerfCounter::delta_us(0, total) / std::max(a_numSteps, 1U);
     }
 
+    void ICollision::RunDispatchBenchmark(dispatchBenchmarkResult_t& a_out)
+    {
+        constexpr std::uint32_t actorCounts[dispatchBenchmarkResult_t::NUM_RUNS]{ 10, 25, 50, 100, 200 };
+
+        a_out.numSteps = 30;
+        a_out.numThreads = IThreadPool::GetNumThreads() + 1;
+
+#if BT_THREADSAFE
+        auto scheduler = m_Instance.m_scheduler.get();
+
+        a_out.mt = true;
+
+        if (auto maxThreads = scheduler->GetMaxThreads())
+            a_out.numThreads = std::min(a_out.numThreads, maxThreads);
+
+        // always go wide, restored below. The UI is blocked meanwhile so BeginCollisionDetection won't touch it
+        auto minItems = scheduler->GetMinItems();
+        scheduler->SetMinItems(0);
+#else
+        a_out.mt = false;
+#endif
+
+        for (std::size_t i = 0; i < std::size(actorCounts); i++)
+        {
+            auto& entry = a_out.runs[i];
+
+            entry = dispatchBenchmarkResult_t::entry_t{ actorCounts[i], 0, 0, 0, 0, 0 };
+
+            std::vector<std::unique_ptr<btCollisionShape>> shapes;
+            std::vector<std::unique_ptr<btCollisionObject>> objects;
 
+            CreateBenchmarkActors(actorCounts[i], shapes, objects);
+
+            entry.numObjects = static_cast<std::uint32_t>(objects.size());
+
+            btDefaultCollisionConfiguration config;
+
+            {
+                btCollisionDispatcher dispatcher(std::addressof(config));
+                entry.serialTime = RunBenchmarkScene(std::addressof(dispatcher), std::addressof(config), objects, a_out.numSteps, entry);
+            }
+
+#if BT_THREADSAFE
+            {
+                btCollisionDispatcherMt dispatcher(std::addressof(config));
+                entry.mtTime = RunBenchmarkScene(std::addressof(dispatcher), std::addressof(config), objects, a_out.numSteps, entry);
+            }
+#endif
+        }
+
+#if BT_THREADSAFE
+        scheduler->SetMinItems(minItems);
+#endif
+    }
 }
 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Profile/Profile.h"
+#include "Narrowphase.h"
+#include "Broadphase.h"
+#include "ThreadPool.h"
 
 namespace CBP
 {
@@ -43,8 +46,147 @@ namespace CBP
         FN_NAMEPROC("ColliderProfile");
     };
 
+    struct dispatchBenchmarkResult_t
+    {
+        static constexpr std::size_t NUM_RUNS = 5;
+
+        struct entry_t
+        {
+            std::uint32_t numActors;
+            std::uint32_t numObjects;
+            std::uint32_t numPairs;
+            std::uint32_t numManifolds;
+
+            // average per detection step
+            long long serialTime;
+            long long mtTime;
+        };
+
+        entry_t runs[NUM_RUNS];
+
+        std::uint32_t numSteps;
+        std::uint32_t numThreads;
+        bool mt;
+    };
+
+    // colliders of one actor. While its bounding sphere touches no other actor they live in a broadphase
+    // of their own instead of the shared world, see ICollision::UpdateIslands
+    class CollisionIsland
+    {
+        friend class ICollision;
+
+    public:
+
+        CollisionIsland();
+        ~CollisionIsland() noexcept;
+
+        CollisionIsland(const CollisionIsland&) = delete;
+        CollisionIsland(CollisionIsland&&) = delete;
+        CollisionIsland& operator=(const CollisionIsland&) = delete;
+        CollisionIsland& operator=(CollisionIsland&&) = delete;
+
+    private:
+
+        btCollisionWorld* GetWorld();
+
+        std::unique_ptr<btDbvtBroadphase> m_broadphase;
+        std::unique_ptr<btCollisionWorld> m_world;
+
+        std::vector<btCollisionObject*> m_objects;
+
+        btVector3 m_center;
+        btScalar m_radius{ 0.0f };
+
+        // objects are in the shared world
+        bool m_shared{ true };
+        bool m_touching{ false };
+    };
+
+    // allocations Bullet had to make outside of the manifold and algorithm pools
+    class PoolTracker
+    {
+    public:
+
+        virtual ~PoolTracker() noexcept = default;
+
+        // everything allocated from the current pools has to be freed first
+        virtual void SetPools(btPoolAllocator* a_manifolds, btPoolAllocator* a_algorithms) = 0;
+
+        // totals
+        std::atomic<std::uint32_t> m_manifoldOverflows{ 0 };
+        std::atomic<std::uint32_t> m_algorithmOverflows{ 0 };
+
+        // algorithms currently allocated outside the pool
+        std::atomic<std::int32_t> m_algorithmOverflowsLive{ 0 };
+    };
+
+    template <class T>
+    class PoolTrackingDispatcher :
+        public T,
+        public PoolTracker
+    {
+    public:
+
+        using T::T;
+
+        virtual btPersistentManifold* getNewManifold(const btCollisionObject* a_b0, const btCollisionObject* a_b1) override
+        {
+            auto manifold = T::getNewManifold(a_b0, a_b1);
+
+            if (!this->m_persistentManifoldPoolAllocator->validPtr(manifold))
+                m_manifoldOverflows.fetch_add(1, std::memory_order_relaxed);
+
+            return manifold;
+        }
+
+        virtual void* allocateCollisionAlgorithm(int a_size) override
+        {
+            auto mem = T::allocateCollisionAlgorithm(a_size);
+
+            if (!this->m_collisionAlgorithmPoolAllocator->validPtr(mem))
+            {
+                m_algorithmOverflows.fetch_add(1, std::memory_order_relaxed);
+                m_algorithmOverflowsLive.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            return mem;
+        }
+
+        virtual void freeCollisionAlgorithm(void* a_ptr) override
+        {
+            if (!this->m_collisionAlgorithmPoolAllocator->validPtr(a_ptr))
+                m_algorithmOverflowsLive.fetch_sub(1, std::memory_order_relaxed);
+
+            T::freeCollisionAlgorithm(a_ptr);
+        }
+
+        virtual void SetPools(btPoolAllocator* a_manifolds, btPoolAllocator* a_algorithms) override
+        {
+            this->m_persistentManifoldPoolAllocator = a_manifolds;
+            this->m_collisionAlgorithmPoolAllocator = a_algorithms;
+        }
+    };
+
+    struct poolStats_t
+    {
+        std::uint32_t manifoldPoolSize;
+        std::uint32_t manifoldsUsed;
+        std::uint32_t manifoldPeak;
+        std::uint32_t manifoldOverflows;
+
+        std::uint32_t algorithmPoolSize;
+        std::uint32_t algorithmsUsed;
+        std::uint32_t algorithmPeak;
+        std::uint32_t algorithmOverflows;
+
+        std::uint32_t numManifolds;
+        std::uint32_t numResizes;
+    };
+
     class ICollision
     {
+        friend class CollisionIsland;
+
         struct overlapFilter :
             public btOverlapFilterCallback
         {
@@ -54,6 +196,45 @@ namespace CBP
         static constexpr int MAX_PERSISTENT_MANIFOLD_POOL_SIZE = 4096;
         static constexpr int MAX_COLLISION_ALGORITHM_POOL_SIZE = 4096;
 
+        // auto-grow won't go past this
+        static constexpr std::uint32_t POOL_SIZE_LIMIT = 1U << 17;
+
+        // bt32BitAxisSweep3 preallocates its handles, the shared world falls back to DBVT past this
+        static constexpr unsigned int SAP_MAX_HANDLES = 16384;
+        static constexpr btScalar SAP_WORLD_EXTENT = 1000000.0f;
+
+#if BT_THREADSAFE
+        static constexpr std::size_t MAX_CONTACT_BUFFERS = BT_MAX_THREAD_COUNT;
+#else
+        static constexpr std::size_t MAX_CONTACT_BUFFERS = 1;
+#endif
+
+        // either a manifold or a native contact
+        struct responseJob_t
+        {
+            const btPersistentManifold* manifold;
+            const Narrowphase::contact_t* contact;
+            std::uint32_t colour;
+        };
+
+        struct responsePair_t
+        {
+            SimComponent* sca;
+            SimComponent* scb;
+
+            bool mova;
+            bool movb;
+            bool friction;
+
+            btScalar mia;
+            btScalar mib;
+            btScalar miab;
+            btScalar pbf;
+            btScalar pmi;
+            btScalar rc;
+            btScalar fc;
+        };
+
     public:
 
         [[nodiscard]] SKMP_FORCEINLINE static auto& GetSingleton() {
@@ -81,6 +262,24 @@ namespace CBP
         static void AddCollisionObject(btCollisionObject* a_collider);
         static void RemoveCollisionObject(btCollisionObject* a_collider);
 
+        static void DebugDrawWorlds();
+
+        // broadphase of the shared world, never Auto
+        [[nodiscard]] SKMP_FORCEINLINE static auto GetBroadphaseType() {
+            return m_Instance.m_broadphaseType;
+        }
+
+        [[nodiscard]] static btScalar GetBroadphaseCellSize();
+
+        static void GetPoolStats(poolStats_t& a_out);
+
+        // time spent in AABB updates and pair search since the last call
+        static void ConsumeBroadphaseStats(BroadphaseType& a_type, long long& a_ticks, std::uint32_t& a_steps);
+        static void GetIslandStats(std::uint32_t& a_numIslands, std::uint32_t& a_numShared);
+
+        // synthetic actors in private worlds, serial against MT dispatch (MT needs BT_THREADSAFE)
+        static void RunDispatchBenchmark(dispatchBenchmarkResult_t& a_out);
+
         SKMP_FORCEINLINE static btScalar GetFrictionImpulse(
             const btVector3& a_vi,
             const btVector3& a_n,
@@ -106,123 +305,122 @@ namespace CBP
             return m_Instance.m_ptrs.bt_dispatcher;
         }
 
-#if 0
-        SKMP_FORCEINLINE static int GetNumThreads() {
-            return m_Instance.m_numThreads;
-        }
-#endif
-
-        SKMP_FORCEINLINE static void btPerformCollisionDetection() {
-            m_Instance.m_ptrs.bt_collision_world->performDiscreteCollisionDetection();
-        }
-
-        static void PerformCollisionResponse(int a_low, int a_high, float a_timeStep);
+        // performDiscreteCollisionDetection with the broadphase part timed
+        static void btPerformCollisionDetection();
 
-#if 0
-        struct taskObject_t
-        {
-            using task_t = concurrency::task_handle<std::function<void()>>;
+        static void PerformCollisionResponse(float a_timeStep);
+        static void PerformManifoldResponse(int a_low, int a_high, float a_timeStep);
+        static void PerformNativeCollisionResponse(float a_timeStep);
+        static void PerformParallelCollisionResponse(int a_numManifolds, float a_timeStep);
 
-            taskObject_t() : m_task([&]() { PerformCollisionResponseImpl(); }) {};
+        SKMP_FORCEINLINE static void RespondManifold(const btPersistentManifold* a_manifold, float a_timeStep);
+        SKMP_FORCEINLINE static void RespondContact(const Narrowphase::contact_t& a_contact, float a_timeStep);
 
-            // lambda needs to be initialized again so the capture points to this, can discard everything from rhs
-            explicit taskObject_t(taskObject_t&& a_rhs) :
-                m_task([&]() { PerformCollisionResponseImpl(); }) {};
-            explicit taskObject_t(const taskObject_t&) :
-                m_task([&]() { PerformCollisionResponseImpl(); }) {};
+        SKMP_FORCEINLINE static void AddResponseJob(
+            const btPersistentManifold* a_manifold,
+            const Narrowphase::contact_t* a_contact,
+            SimComponent* a_sca,
+            SimComponent* a_scb);
 
-            taskObject_t& operator=(taskObject_t&&) = delete;
-            taskObject_t& operator=(const taskObject_t&) = delete;
+        SKMP_FORCEINLINE static void SetupResponsePair(
+            SimComponent* a_sca,
+            SimComponent* a_scb,
+            responsePair_t& a_out);
 
-            int m_low, m_high;
-            float m_timeStep;
-            task_t m_task;
+        SKMP_FORCEINLINE static void ResolveContact(
+            const responsePair_t& a_pair,
+            const btVector3& a_normalOnB,
+            btScalar a_depth,
+            float a_timeStep);
 
+        // sphere and capsule pairs skip algorithm dispatch and manifolds, everything else goes to btCollisionDispatcher::defaultNearCallback
+        static void NearCallback(
+            btBroadphasePair& a_pair,
+            btCollisionDispatcher& a_dispatcher,
+            const btDispatcherInfo& a_info);
 
-            SKMP_FORCEINLINE void PerformCollisionResponseImpl()
-            {
-                auto daz = _MM_GET_DENORMALS_ZERO_MODE();
-                auto ftz = _MM_GET_FLUSH_ZERO_MODE();
+        static void BeginCollisionDetection(float a_timeStep);
 
-                _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-                _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+        [[nodiscard]] static btBroadphaseInterface* CreateBroadphase(BroadphaseType a_type);
+        static void SetBroadphase(BroadphaseType a_type);
+        static void UpdateBroadphase(float a_timeStep);
+        static void SampleBroadphaseMotion(float a_timeStep);
 
-                PerformCollisionResponse(m_low, m_high, m_timeStep);
+        static void SamplePools();
+        static void GrowPools();
 
-                _MM_SET_DENORMALS_ZERO_MODE(daz);
-                _MM_SET_FLUSH_ZERO_MODE(ftz);
-            }
+        [[nodiscard]] static CollisionIsland* GetIsland(const btCollisionObject* a_collider);
+        [[nodiscard]] static btCollisionWorld* GetObjectWorld(const btCollisionObject* a_collider);
 
-        };
+        static void RegisterIsland(CollisionIsland* a_island);
+        static void UnregisterIsland(CollisionIsland* a_island);
+        static void MoveIsland(CollisionIsland& a_island, bool a_shared);
+        static void UpdateIslands();
+        static void PerformIslandDetection();
 
-        std::vector<taskObject_t> m_responseTasks;
-        btSpinMutex m_mutex;
-        int m_numThreads;
-#endif
         overlapFilter m_overlapFilter;
 
-        static ICollision m_Instance;
-    };
-
-    void ICollision::DoCollisionDetection(float a_timeStep)
-    {
-        btPerformCollisionDetection();
+        stl::vector_simd<Narrowphase::contact_t> m_contacts[MAX_CONTACT_BUFFERS];
+        bool m_nativeNarrowphase{ false };
 
-        /*static PerfTimerInt pta(1000000);
-        pta.Begin();*/
+        std::vector<responseJob_t> m_jobs;
+        std::vector<responseJob_t> m_sortedJobs;
+        std::vector<std::uint32_t> m_colourOffsets;
+        std::uint32_t m_numColours{ 0 };
+        std::uint32_t m_responsePass{ 0 };
 
+        std::vector<CollisionIsland*> m_islands;
+        bool m_islandsEnabled{ false };
 
-        auto* dispatcher = GetDispatcher();
+        BroadphaseType m_broadphaseType{ BroadphaseType::Dbvt };
+        SpatialHashBroadphase* m_spatialHash{ nullptr };
+        long long m_broadphaseTicks{ 0 };
+        std::uint32_t m_broadphaseSteps{ 0 };
 
-        int numManifolds = dispatcher->getNumManifolds();
+        PoolTracker* m_poolTracker{ nullptr };
 
-#if 0
-        if (!numManifolds)
-            return;
+        // replace the configuration's pools once they've been outgrown
+        std::unique_ptr<btPoolAllocator> m_manifoldPool;
+        std::unique_ptr<btPoolAllocator> m_algorithmPool;
 
-        //_DMESSAGE("got %d manifolds", numManifolds);
-
-        int numThreads = GetNumThreads();
-        if (numThreads == 0 || numManifolds < 4000) {
-            PerformCollisionResponse(0, numManifolds, a_timeStep);;
-        }
-        else
+        struct
         {
-            int seg = numManifolds / numThreads;
-            int rem = numManifolds % numThreads;
-
-            concurrency::structured_task_group task_group;
-
-            for (int i = 0, ii = numManifolds - rem; ii > 0; ii -= seg, i++)
-            {
-                ASSERT(i < numThreads);
+            std::uint32_t manifoldPeak{ 0 };
+            std::uint32_t algorithmPeak{ 0 };
+            std::uint32_t numManifolds{ 0 };
+            std::uint32_t numResizes{ 0 };
+            bool grow{ false };
+        } m_pools;
 
-                auto& task = m_Instance.m_responseTasks[i];
-
-                //_DMESSAGE("assigning chunk %d-%d", ii - seg, ii);
-                task.m_low = ii - seg;
-                task.m_high = ii;
-                task.m_timeStep = a_timeStep;
-
-                task_group.run(task.m_task);
-            }
-
-            if (rem > 0)
-            {
-                //_DMESSAGE("rem %d-%d", numManifolds - rem, numManifolds);
-                PerformCollisionResponse(numManifolds - rem, numManifolds, a_timeStep);
-            }
+        struct
+        {
+            BroadphaseType selected{ BroadphaseType::Dbvt };
+            BroadphaseType candidate{ BroadphaseType::Dbvt };
+            double motion{ 0.0 };
+            std::uint64_t numProxies{ 0 };
+            std::uint32_t numSteps{ 0 };
+        } m_auto;
 
-            task_group.wait();
-        }
-#else
-        PerformCollisionResponse(0, numManifolds, a_timeStep);
+#if BT_THREADSAFE
+        // installed once, Bullet hands out thread indices per active scheduler
+        std::unique_ptr<BulletTaskScheduler> m_scheduler;
+        std::uint32_t m_dispatchMinItems{ 0 };
+        int m_dispatchThreads{ 0 };
 #endif
 
-        /*long long a;
-        if (pta.End(a))
-            _DMESSAGE("%lld | %d", a, numManifolds);*/
+        // colliders can be (de)activated from motion worker threads
+        ICriticalSection m_lock;
+
+        static ICollision m_Instance;
+    };
 
+    void ICollision::DoCollisionDetection(float a_timeStep)
+    {
+        BeginCollisionDetection(a_timeStep);
+        btPerformCollisionDetection();
+        PerformIslandDetection();
+        SamplePools();
+        PerformCollisionResponse(a_timeStep);
     }
 
     btScalar ICollision::GetFrictionImpulse(
@@ -40,6 +40,26 @@ namespace CBP
         }
     );
 
+    const integratorDescMap_t configComponent_t::integratorDescMap({
+        { IntegratorType::Legacy, {
+            "Default",
+            "Euler integration with explicit damping. Stiff springs need small time ticks."
+        }},
+        { IntegratorType::SemiImplicit, {
+            "Semi-implicit Euler",
+            "Symplectic Euler with implicit damping. Stays stable at larger steps than the default for heavily damped springs."
+        }},
+        { IntegratorType::Verlet, {
+            "Velocity Verlet",
+            "Second order accurate, better energy behavior at the same step size. Costs an extra spring evaluation."
+        }},
+        { IntegratorType::Implicit, {
+            "Implicit spring",
+            "Backward Euler solve of the spring and damping forces. Unconditionally stable, allows stiff configs at one step per frame at the cost of some extra damping."
+        }}
+        }
+    );
+
     const componentValueDescMap_t configComponent_t::descMap({
         {"s", {
             offsetof(configComponent_t, fp.f32.stiffness),
@@ -898,6 +918,11 @@ namespace CBP
             ConfigValueType::kMotionConstraint,
             ComponentConfigSection::kExtra
         }},
+        {"itg", {
+            offsetof(configComponent_t, ex.integrator),
+            ConfigValueType::kIntegrator,
+            ComponentConfigSection::kExtra
+        }},
         {"clm", {
             offsetof(configComponent_t, ex.colMesh),
             ConfigValueType::kString,
@@ -8,6 +8,7 @@ namespace CBP
         kBool,
         kString,
         kColliderShape,
-        kMotionConstraint
+        kMotionConstraint,
+        kIntegrator
     };
 }
\ No newline at end of file
@@ -0,0 +1,492 @@
+#include "pch.h"
+
+#include "Constraints.h"
+#include "Benchmark.h"
+
+namespace CBP
+{
+    namespace Constraints
+    {
+        struct lanes_t
+        {
+            __m128 r[9];
+            __m128 tx, ty, tz;
+            __m128 ox, oy, oz;
+            __m128 dt;
+            __m128 vx, vy, vz;
+            __m128 lx, ly, lz;
+            __m128 violation;
+        };
+
+        SKMP_FORCEINLINE static __m128 Dot(
+            __m128 a_x, __m128 a_y, __m128 a_z,
+            __m128 a_bx, __m128 a_by, __m128 a_bz)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a_x, a_bx), _mm_mul_ps(a_y, a_by)), _mm_mul_ps(a_z, a_bz));
+        }
+
+        SKMP_FORCEINLINE static __m128 Select(__m128 a_mask, __m128 a_a, __m128 a_b)
+        {
+            return _mm_or_ps(_mm_and_ps(a_mask, a_a), _mm_andnot_ps(a_mask, a_b));
+        }
+
+        SKMP_FORCEINLINE static void ResolveLanes(
+            lanes_t& a_l,
+            __m128 a_dx,
+            __m128 a_dy,
+            __m128 a_dz,
+            __m128 a_mag,
+            __m128 a_active,
+            const float* const (&a_params)[4],
+            std::size_t a_index)
+        {
+            auto& l = a_l;
+
+            auto eps2 = _mm_set_ps1(_EPSILON * _EPSILON);
+            auto zero = _mm_setzero_ps();
+
+            auto nx = Dot(l.r[0], l.r[1], l.r[2], a_dx, a_dy, a_dz);
+            auto ny = Dot(l.r[3], l.r[4], l.r[5], a_dx, a_dy, a_dz);
+            auto nz = Dot(l.r[6], l.r[7], l.r[8], a_dx, a_dy, a_dz);
+
+            auto l2 = Dot(nx, ny, nz, nx, ny, nz);
+            auto valid = _mm_and_ps(a_active, _mm_cmpge_ps(l2, eps2));
+
+            auto len = _mm_sqrt_ps(_mm_max_ps(l2, eps2));
+
+            nx = _mm_div_ps(nx, len);
+            ny = _mm_div_ps(ny, len);
+            nz = _mm_div_ps(nz, len);
+
+            auto p0 = _mm_load_ps(a_params[0] + a_index);
+            auto p1 = _mm_load_ps(a_params[1] + a_index);
+            auto p2 = _mm_load_ps(a_params[2] + a_index);
+            auto p3 = _mm_load_ps(a_params[3] + a_index);
+
+            auto bias = _mm_min_ps(_mm_max_ps(_mm_sub_ps(a_mag, _mm_set_ps1(0.01f)), zero), p1);
+
+            auto impulse = _mm_add_ps(
+                Dot(l.vx, l.vy, l.vz, nx, ny, nz),
+                _mm_mul_ps(_mm_mul_ps(l.dt, p3), bias));
+
+            l.violation = _mm_max_ps(l.violation, _mm_and_ps(valid, a_mag));
+
+            auto apply = _mm_and_ps(valid, _mm_cmpgt_ps(impulse, zero));
+
+            auto s = _mm_and_ps(apply, _mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_set_ps1(1.0f), p2), impulse), p0));
+
+            l.vx = _mm_sub_ps(l.vx, _mm_mul_ps(nx, s));
+            l.vy = _mm_sub_ps(l.vy, _mm_mul_ps(ny, s));
+            l.vz = _mm_sub_ps(l.vz, _mm_mul_ps(nz, s));
+
+            auto px = _mm_sub_ps(_mm_add_ps(l.ox, _mm_mul_ps(l.vx, l.dt)), l.tx);
+            auto py = _mm_sub_ps(_mm_add_ps(l.oy, _mm_mul_ps(l.vy, l.dt)), l.ty);
+            auto pz = _mm_sub_ps(_mm_add_ps(l.oz, _mm_mul_ps(l.vz, l.dt)), l.tz);
+
+            // transposed parent rotation
+            l.lx = Select(apply, Dot(l.r[0], l.r[3], l.r[6], px, py, pz), l.lx);
+            l.ly = Select(apply, Dot(l.r[1], l.r[4], l.r[7], px, py, pz), l.ly);
+            l.lz = Select(apply, Dot(l.r[2], l.r[5], l.r[8], px, py, pz), l.lz);
+        }
+
+        void Solve(const batch_t& a_batch, std::size_t a_count)
+        {
+            auto& b = a_batch;
+
+            auto zero = _mm_setzero_ps();
+
+            lanes_t l;
+
+            for (std::size_t i = 0; i < a_count; i += 4)
+            {
+                for (std::size_t j = 0; j < 9; j++)
+                    l.r[j] = _mm_load_ps(b.rot[j] + i);
+
+                l.tx = _mm_load_ps(b.tx + i);
+                l.ty = _mm_load_ps(b.ty + i);
+                l.tz = _mm_load_ps(b.tz + i);
+                l.ox = _mm_load_ps(b.ox + i);
+                l.oy = _mm_load_ps(b.oy + i);
+                l.oz = _mm_load_ps(b.oz + i);
+                l.dt = _mm_load_ps(b.dt + i);
+                l.vx = _mm_load_ps(b.vx + i);
+                l.vy = _mm_load_ps(b.vy + i);
+                l.vz = _mm_load_ps(b.vz + i);
+                l.lx = _mm_load_ps(b.lx + i);
+                l.ly = _mm_load_ps(b.ly + i);
+                l.lz = _mm_load_ps(b.lz + i);
+                l.violation = zero;
+
+                // sphere
+                {
+                    auto dx = _mm_sub_ps(l.lx, _mm_load_ps(b.sphereOffset[0] + i));
+                    auto dy = _mm_sub_ps(l.ly, _mm_load_ps(b.sphereOffset[1] + i));
+                    auto dz = _mm_sub_ps(l.lz, _mm_load_ps(b.sphereOffset[2] + i));
+
+                    auto len = _mm_sqrt_ps(Dot(dx, dy, dz, dx, dy, dz));
+                    auto radius = _mm_load_ps(b.sphereRadius + i);
+
+                    auto active = _mm_and_ps(
+                        _mm_cmpgt_ps(_mm_load_ps(b.sphere + i), zero),
+                        _mm_cmpgt_ps(len, radius));
+
+                    ResolveLanes(l, dx, dy, dz, _mm_sub_ps(len, radius), active, b.sphereParams, i);
+                }
+
+                // box
+                {
+                    auto dx = _mm_sub_ps(l.lx, _mm_min_ps(_mm_max_ps(l.lx, _mm_load_ps(b.boxMin[0] + i)), _mm_load_ps(b.boxMax[0] + i)));
+                    auto dy = _mm_sub_ps(l.ly, _mm_min_ps(_mm_max_ps(l.ly, _mm_load_ps(b.boxMin[1] + i)), _mm_load_ps(b.boxMax[1] + i)));
+                    auto dz = _mm_sub_ps(l.lz, _mm_min_ps(_mm_max_ps(l.lz, _mm_load_ps(b.boxMin[2] + i)), _mm_load_ps(b.boxMax[2] + i)));
+
+                    auto outside = _mm_or_ps(
+                        _mm_or_ps(_mm_cmpneq_ps(dx, zero), _mm_cmpneq_ps(dy, zero)),
+                        _mm_cmpneq_ps(dz, zero));
+
+                    auto active = _mm_and_ps(_mm_cmpgt_ps(_mm_load_ps(b.box + i), zero), outside);
+
+                    auto mag = _mm_sqrt_ps(Dot(dx, dy, dz, dx, dy, dz));
+
+                    ResolveLanes(l, dx, dy, dz, mag, active, b.boxParams, i);
+                }
+
+                _mm_store_ps(b.vx + i, l.vx);
+                _mm_store_ps(b.vy + i, l.vy);
+                _mm_store_ps(b.vz + i, l.vz);
+                _mm_store_ps(b.lx + i, l.lx);
+                _mm_store_ps(b.ly + i, l.ly);
+                _mm_store_ps(b.lz + i, l.lz);
+                _mm_store_ps(b.violation + i, l.violation);
+            }
+        }
+
+        struct SKMP_ALIGN(16) benchState_t
+        {
+            btVector3 velocity;
+            btVector3 virtld;
+            btVector3 oldPos;
+            btVector3 target;
+            btScalar violation;
+        };
+
+        struct SKMP_ALIGN(16) benchParams_t
+        {
+            btMatrix3x3 parentRot;
+            btMatrix3x3 invRot;
+
+            btVector3 sphereOffset;
+            btScalar sphereRadius;
+            float sphereParams[4];
+
+            btVector3 boxMin;
+            btVector3 boxMax;
+            float boxParams[4];
+        };
+
+        // SimComponent::ConstrainMotionBox/Sphere as they were before the branch-free rewrite
+        static void SolveBranching(const benchParams_t& a_p, btScalar a_timeStep, benchState_t& a_s)
+        {
+            auto diff(a_s.virtld - a_p.sphereOffset);
+            auto difflen = diff.length();
+
+            if (difflen > a_p.sphereRadius)
+            {
+                auto n = a_p.parentRot * diff;
+                auto l2 = n.length2();
+
+                if (l2 >= _EPSILON * _EPSILON)
+                {
+                    n /= std::sqrtf(l2);
+
+                    btScalar impulse = a_s.velocity.dot(n);
+                    btScalar mag = difflen - a_p.sphereRadius;
+
+                    a_s.violation = std::max(a_s.violation, mag);
+
+                    if (mag > 0.01f) {
+                        impulse += (a_timeStep * a_p.sphereParams[3]) *
+                            std::clamp(mag - 0.01f, 0.0f, a_p.sphereParams[1]);
+                    }
+
+                    if (impulse > 0.0f)
+                    {
+                        btScalar J = (1.0f + a_p.sphereParams[2]) * impulse;
+                        a_s.velocity -= n * (J * a_p.sphereParams[0]);
+                        a_s.virtld = a_p.invRot * ((a_s.oldPos + (a_s.velocity * a_timeStep)) -= a_s.target);
+                    }
+                }
+            }
+
+            btVector3 depth(0.0f, 0.0f, 0.0f);
+            bool skip(true);
+
+            for (int i = 0; i < 3; i++)
+            {
+                btScalar v(a_s.virtld[i]);
+
+                if (v > a_p.boxMax[i])
+                {
+                    depth[i] = v - a_p.boxMax[i];
+                    skip = false;
+                }
+                else if (v < a_p.boxMin[i])
+                {
+                    depth[i] = v - a_p.boxMin[i];
+                    skip = false;
+                }
+            }
+
+            if (skip)
+                return;
+
+            auto n = a_p.parentRot * depth;
+            auto l2 = n.length2();
+
+            if (l2 < _EPSILON * _EPSILON)
+                return;
+
+            n /= std::sqrtf(l2);
+
+            btScalar impulse = a_s.velocity.dot(n);
+            btScalar mag = depth.length();
+
+            a_s.violation = std::max(a_s.violation, mag);
+
+            if (mag > 0.01f) {
+                impulse += (a_timeStep * a_p.boxParams[3]) *
+                    std::clamp(mag - 0.01f, 0.0f, a_p.boxParams[1]);
+            }
+
+            if (impulse <= 0.0f)
+                return;
+
+            btScalar J = (1.0f + a_p.boxParams[2]) * impulse;
+            a_s.velocity -= n * (J * a_p.boxParams[0]);
+            a_s.virtld = a_p.invRot * ((a_s.oldPos + (a_s.velocity * a_timeStep)) -= a_s.target);
+        }
+
+        // same as SimComponent now
+        static void SolveMasked(const benchParams_t& a_p, btScalar a_timeStep, benchState_t& a_s)
+        {
+            auto diff(a_s.virtld - a_p.sphereOffset);
+            auto len = diff.length();
+
+            if (len > a_p.sphereRadius)
+            {
+                Resolve(
+                    a_p.parentRot, a_p.invRot, a_s.oldPos, a_s.target,
+                    diff, len - a_p.sphereRadius, true,
+                    a_p.sphereParams, a_timeStep,
+                    a_s.velocity, a_s.virtld, a_s.violation);
+            }
+
+            auto depth = BoxDepth(a_s.virtld, a_p.boxMin, a_p.boxMax);
+
+            if (AnyNonZero(depth))
+            {
+                Resolve(
+                    a_p.parentRot, a_p.invRot, a_s.oldPos, a_s.target,
+                    depth, depth.length(), true,
+                    a_p.boxParams, a_timeStep,
+                    a_s.velocity, a_s.virtld, a_s.violation);
+            }
+        }
+
+        void RunBenchmark(std::uint32_t a_count, benchmarkResult_t& a_out)
+        {
+            constexpr btScalar TIME_STEP = 1.0f / 60.0f;
+
+            auto count = BenchmarkCount(a_count, 4);
+
+            BenchmarkRandom rnd(0x2545F491);
+
+            benchParams_t p;
+
+            p.parentRot.setEulerZYX(-0.5f, 0.7f, 0.2f);
+            p.invRot = p.parentRot.transpose();
+            p.sphereOffset.setValue(0.0f, 0.0f, 0.0f);
+            p.sphereRadius = 8.0f;
+            p.boxMin.setValue(-6.0f, -6.0f, -4.0f);
+            p.boxMax.setValue(6.0f, 6.0f, 4.0f);
+
+            float response[4]{ 1.0f, 20.0f, 0.2f, 2.0f };
+
+            std::copy(std::begin(response), std::end(response), p.sphereParams);
+            std::copy(std::begin(response), std::end(response), p.boxParams);
+
+            stl::vector_simd<benchState_t> initial(count);
+            stl::vector_simd<benchState_t> states(count);
+            stl::vector_simd<btVector3> reference(count);
+
+            // rotation, sphere flag, offset, radius, params, box flag, min, max, params
+            constexpr std::size_t NUM_SHARED = 9 + 1 + 3 + 1 + 4 + 1 + 3 + 3 + 4;
+
+            // per lane copies of the shared parameters
+            float shared[NUM_SHARED];
+            stl::vector_simd<float> lanes(NUM_SHARED * count);
+            stl::vector_simd<float> soa(14 * count);
+
+            std::size_t k(0);
+
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    shared[k++] = p.parentRot[r][c];
+
+            shared[k++] = 1.0f;
+            for (int i = 0; i < 3; i++)
+                shared[k++] = p.sphereOffset[i];
+            shared[k++] = p.sphereRadius;
+            for (int i = 0; i < 4; i++)
+                shared[k++] = p.sphereParams[i];
+
+            shared[k++] = 1.0f;
+            for (int i = 0; i < 3; i++)
+                shared[k++] = p.boxMin[i];
+            for (int i = 0; i < 3; i++)
+                shared[k++] = p.boxMax[i];
+            for (int i = 0; i < 4; i++)
+                shared[k++] = p.boxParams[i];
+
+            for (std::size_t j = 0; j < NUM_SHARED; j++)
+                std::fill_n(lanes.data() + j * count, count, shared[j]);
+
+            auto lane = [&](std::size_t a_i) { return lanes.data() + a_i * count; };
+            auto field = [&](std::size_t a_i) { return soa.data() + a_i * count; };
+
+            batch_t b;
+
+            for (std::size_t j = 0; j < 9; j++)
+                b.rot[j] = lane(j);
+
+            b.sphere = lane(9);
+            for (std::size_t j = 0; j < 3; j++)
+                b.sphereOffset[j] = lane(10 + j);
+            b.sphereRadius = lane(13);
+            for (std::size_t j = 0; j < 4; j++)
+                b.sphereParams[j] = lane(14 + j);
+
+            b.box = lane(18);
+            for (std::size_t j = 0; j < 3; j++)
+            {
+                b.boxMin[j] = lane(19 + j);
+                b.boxMax[j] = lane(22 + j);
+            }
+            for (std::size_t j = 0; j < 4; j++)
+                b.boxParams[j] = lane(25 + j);
+
+            float* tx = field(0);
+            float* ty = field(1);
+            float* tz = field(2);
+            float* ox = field(3);
+            float* oy = field(4);
+            float* oz = field(5);
+            float* dt = field(6);
+
+            b.tx = tx;
+            b.ty = ty;
+            b.tz = tz;
+            b.ox = ox;
+            b.oy = oy;
+            b.oz = oz;
+            b.dt = dt;
+            b.vx = field(7);
+            b.vy = field(8);
+            b.vz = field(9);
+            b.lx = field(10);
+            b.ly = field(11);
+            b.lz = field(12);
+            b.violation = field(13);
+
+            a_out.count = static_cast<std::uint32_t>(count);
+
+            for (int pass = 0; pass < 2; pass++)
+            {
+                // settled: well inside both limits. noisy: up to twice the box extents, crossing at random
+                btScalar spread = pass == 0 ? 2.0f : 12.0f;
+
+                for (auto& e : initial)
+                {
+                    e.target.setValue(rnd.Signed() * 100.0f, rnd.Signed() * 100.0f, rnd.Signed() * 100.0f);
+                    e.virtld.setValue(rnd.Signed() * spread, rnd.Signed() * spread, rnd.Signed() * spread * 0.7f);
+                    e.velocity.setValue(rnd.Signed() * spread * 30.0f, rnd.Signed() * spread * 30.0f, rnd.Signed() * spread * 30.0f);
+                    e.oldPos = (p.parentRot * e.virtld) + e.target - e.velocity * TIME_STEP;
+                    e.violation = 0.0f;
+                }
+
+                std::copy(initial.begin(), initial.end(), states.begin());
+
+                auto start = IPerfCounter::Query();
+
+                for (auto& e : states)
+                    SolveBranching(p, TIME_STEP, e);
+
+                auto t1 = IPerfCounter::Query();
+
+                a_out.numViolations[pass] = 0;
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    auto& e = states[i];
+
+                    if (e.violation > 0.0f)
+                        a_out.numViolations[pass]++;
+
+                    reference[i] = e.velocity;
+                }
+
+                std::copy(initial.begin(), initial.end(), states.begin());
+
+                auto t2 = IPerfCounter::Query();
+
+                for (auto& e : states)
+                    SolveMasked(p, TIME_STEP, e);
+
+                auto t3 = IPerfCounter::Query();
+
+                btScalar maxError(0.0f);
+
+                for (std::size_t i = 0; i < count; i++)
+                    maxError = std::max(maxError, (states[i].velocity - reference[i]).absolute().maxAxisValue());
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    auto& e = initial[i];
+
+                    tx[i] = e.target.x();
+                    ty[i] = e.target.y();
+                    tz[i] = e.target.z();
+                    ox[i] = e.oldPos.x();
+                    oy[i] = e.oldPos.y();
+                    oz[i] = e.oldPos.z();
+                    dt[i] = TIME_STEP;
+                    b.vx[i] = e.velocity.x();
+                    b.vy[i] = e.velocity.y();
+                    b.vz[i] = e.velocity.z();
+                    b.lx[i] = e.virtld.x();
+                    b.ly[i] = e.virtld.y();
+                    b.lz[i] = e.virtld.z();
+                }
+
+                auto t4 = IPerfCounter::Query();
+
+                Solve(b, count);
+
+                auto t5 = IPerfCounter::Query();
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    auto& r = reference[i];
+
+                    maxError = std::max(maxError, std::fabs(b.vx[i] - r.x()));
+                    maxError = std::max(maxError, std::fabs(b.vy[i] - r.y()));
+                    maxError = std::max(maxError, std::fabs(b.vz[i] - r.z()));
+                }
+
+                a_out.maxError[pass] = maxError;
+                a_out.branchTime[pass] = IPerfCounter::delta_us(start, t1);
+                a_out.maskedTime[pass] = IPerfCounter::delta_us(t2, t3);
+                a_out.batchedTime[pass] = IPerfCounter::delta_us(t4, t5);
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+namespace CBP
+{
+    namespace Constraints
+    {
+        SKMP_FORCEINLINE __m128 BoolMask(bool a_value)
+        {
+            return _mm_castsi128_ps(_mm_set1_epi32(-static_cast<int>(a_value)));
+        }
+
+        // distance past the box faces per axis, zero inside
+        SKMP_FORCEINLINE btVector3 BoxDepth(
+            const btVector3& a_v,
+            const btVector3& a_min,
+            const btVector3& a_max)
+        {
+            return a_v - btVector3(_mm_min_ps(_mm_max_ps(a_v.get128(), a_min.get128()), a_max.get128()));
+        }
+
+        SKMP_FORCEINLINE bool AnyNonZero(const btVector3& a_v)
+        {
+            return (_mm_movemask_ps(_mm_cmpneq_ps(a_v.get128(), _mm_setzero_ps())) & 0x7) != 0;
+        }
+
+        // pushes velocity back along the violation (a_dir, local space) when a_active,
+        // re-derives the local displacement from the corrected velocity.
+        // a_params: response, max bias distance, restitution, bias strength
+        SKMP_FORCEINLINE void Resolve(
+            const btMatrix3x3& a_parentRot,
+            const btMatrix3x3& a_invRot,
+            const btVector3& a_oldPos,
+            const btVector3& a_target,
+            const btVector3& a_dir,
+            btScalar a_mag,
+            bool a_active,
+            const float* a_params,
+            btScalar a_timeStep,
+            btVector3& a_velocity,
+            btVector3& a_virtld,
+            btScalar& a_violation)
+        {
+            auto n = a_parentRot * a_dir;
+
+            auto l2 = n.length2();
+            bool valid = a_active & (l2 >= _EPSILON * _EPSILON);
+
+            n /= std::sqrtf(std::max(l2, _EPSILON * _EPSILON));
+
+            btScalar impulse = a_velocity.dot(n) +
+                (a_timeStep * a_params[3]) * std::clamp(a_mag - 0.01f, 0.0f, a_params[1]);
+
+            a_violation = std::max(a_violation, valid ? a_mag : 0.0f);
+
+            auto apply = BoolMask(valid & (impulse > 0.0f));
+
+            btScalar J = (1.0f + a_params[2]) * impulse;
+
+            a_velocity -= btVector3(_mm_and_ps((n * (J * a_params[0])).get128(), apply));
+
+            auto virtld = a_invRot * ((a_oldPos + (a_velocity * a_timeStep)) -= a_target);
+
+            a_virtld.set128(_mm_or_ps(
+                _mm_and_ps(apply, virtld.get128()),
+                _mm_andnot_ps(apply, a_virtld.get128())));
+        }
+
+        // structure of arrays form, all arrays 16 byte aligned
+        struct batch_t
+        {
+            // parent rotation, row major
+            const float* rot[9];
+
+            const float* tx;
+            const float* ty;
+            const float* tz;
+            const float* ox;
+            const float* oy;
+            const float* oz;
+            const float* dt;
+
+            // in/out
+            float* vx;
+            float* vy;
+            float* vz;
+            float* lx;
+            float* ly;
+            float* lz;
+
+            float* violation;
+
+            // > 0 where the constraint is enabled
+            const float* sphere;
+            const float* sphereOffset[3];
+            const float* sphereRadius;
+            const float* sphereParams[4];
+
+            const float* box;
+            const float* boxMin[3];
+            const float* boxMax[3];
+            const float* boxParams[4];
+        };
+
+        // sphere first, then box, like SimComponent::ConstrainMotion. a_count must be a multiple of 4
+        void Solve(const batch_t& a_batch, std::size_t a_count);
+
+        struct benchmarkResult_t
+        {
+            std::uint32_t count;
+
+            // [0] nodes settled inside their limits, [1] noisy motion crossing them at random
+            // old per axis branches, per node masks behind a single activity branch, SoA without branches
+            long long branchTime[2];
+            long long maskedTime[2];
+            long long batchedTime[2];
+            std::uint32_t numViolations[2];
+
+            // largest velocity difference of the branch-free paths against the branching one
+            float maxError[2];
+        };
+
+        void RunBenchmark(std::uint32_t a_count, benchmarkResult_t& a_out);
+    }
+}
@@ -7,12 +7,15 @@
 #include "SimObject.h"
 #include "SimComponent.h"
 #include "StringHolder.h"
+#include "ThreadPool.h"
 
 #include "Drivers/cbp.h"
 #include "Drivers/tasks.h"
 
 #include "Common/Game.h"
 
+#include <skse64/GameCamera.h>
+
 namespace CBP
 {
     SKMP_FORCEINLINE static bool ActorValid(const Actor* actor)
@@ -42,7 +45,16 @@ namespace CBP
         m_profiler(1000000),
         m_markedActor(0),
         m_ranFrame(true),
-        m_lastFrameTime(1.0f / 60.0f)
+        m_lastFrameTime(1.0f / 60.0f),
+        m_batchedMotion(false),
+        m_scalarMotion(false),
+        m_parallelMotion(false),
+        m_motionTicks(0),
+        m_collisionTicks(0),
+        m_numComponents(0),
+        m_numActiveActors(0),
+        m_numSteps(1),
+        m_numComponentSteps(0)
     {
     }
 
@@ -76,61 +88,320 @@ namespace CBP
                 globalConf.debugRenderer.movingNodesCenterOfGravity,
                 m_markedActor);
 
-            ICollision::GetWorld()->debugDrawWorld();
+            ICollision::DebugDrawWorlds();
 
             renderer->PerfEndGenerate();
         }
         catch (const std::exception&) {}
     }
 
-    void ControllerTask::UpdatePhase1(float a_timeStep)
+    void ControllerTask::UpdateVisibility()
     {
+        const auto& cullConf = IConfig::GetGlobal().culling;
+
         auto data = m_actors.getdata();
         auto size = m_actors.vecsize();
 
+        // recordings are always taken at full rate
+        if (!cullConf.enabled || m_recorder.IsRecording())
+        {
+            for (std::size_t i = 0; i < size; i++)
+                data[i]->SetVisible(true, 0, false);
+
+            return;
+        }
+
+        // last frame's camera
+        Culling::frustum_t frustum;
+        Culling::ExtractFrustum(g_worldToCamMatrix, frustum);
+
+        m_cullBatch.Clear();
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto e = data[i];
+
+            if (e->IsSuspended())
+                continue;
+
+            btVector3 center;
+            btScalar radius;
+
+            e->GetCullBound(center, radius);
+
+            m_cullBatch.Add(center, radius + cullConf.margin);
+        }
+
+        m_cullBatch.Test(frustum);
+
+        std::size_t index(0);
+
         for (std::size_t i = 0; i < size; i++)
         {
-            data[i]->ReadTransforms(a_timeStep);
+            auto e = data[i];
+
+            if (e->IsSuspended())
+                continue;
+
+            e->SetVisible(
+                m_cullBatch.IsVisible(index++),
+                static_cast<std::uint32_t>(cullConf.offscreenLOD),
+                cullConf.freeze);
         }
     }
 
-    void ControllerTask::UpdateActorsPhase2(float a_timeStep)
+    void ControllerTask::UpdateLOD(float a_interval)
     {
+        const auto& lodConf = IConfig::GetGlobal().lod;
+
+        UpdateVisibility();
+
         auto data = m_actors.getdata();
         auto size = m_actors.vecsize();
 
-#if 0
+        NiPoint3 origin;
+        bool lod(false);
 
-        if (DCBP::GetDriverConfig().multiThreadedMotionUpdates)
+        // recordings are always taken at full rate
+        if (lodConf.enabled && !m_recorder.IsRecording())
         {
-            concurrency::structured_task_group task_group;
+            auto camera = PlayerCamera::GetSingleton();
+
+            if (camera && camera->cameraNode)
+            {
+                origin = camera->cameraNode->m_worldTransform.pos;
+                lod = true;
+            }
+            else if (auto player = *g_thePlayer; player)
+            {
+                origin = player->pos;
+                lod = true;
+            }
+        }
 
+        if (!lod)
+        {
             for (std::size_t i = 0; i < size; i++)
             {
-                auto p = data[i];
-                p->SetTimeStep(a_timeStep);
+                auto e = data[i];
 
-                task_group.run(p->GetTask());
+                if (!e->IsSuspended())
+                    e->UpdateLOD(0, 0.0f, a_interval, true);
             }
 
-            task_group.wait();
+            return;
         }
-        else
+
+        float bands[3];
+        float last(0.0f);
+
+        for (std::size_t i = 0; i < std::size(bands); i++)
+        {
+            last = std::max(lodConf.distance[i], last);
+            bands[i] = last * last;
+        }
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto e = data[i];
+
+            if (e->IsSuspended())
+                continue;
+
+            auto& pos = e->GetActor()->pos;
+
+            float dx = pos.x - origin.x;
+            float dy = pos.y - origin.y;
+            float dz = pos.z - origin.z;
+
+            float d2 = dx * dx + dy * dy + dz * dz;
+
+            std::uint32_t level(0);
+
+            while (level < std::size(bands) && d2 > bands[level])
+                level++;
+
+            e->UpdateLOD(
+                level,
+                std::sqrtf(d2),
+                a_interval,
+                level < std::size(bands) || lodConf.farCollisions);
+        }
+    }
+
+    void ControllerTask::UpdatePhase1(float a_timeStep)
+    {
+        auto data = m_actors.getdata();
+        auto size = m_actors.vecsize();
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto e = data[i];
+
+            if (!e->IsLODSkipped())
+                e->ReadTransforms(a_timeStep * e->GetTimeScale());
+        }
+    }
+
+    void ControllerTask::PrepareMotion()
+    {
+        auto data = m_actors.getdata();
+        auto size = m_actors.vecsize();
+
+        m_numActiveActors = 0;
+        m_numComponents = 0;
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto e = data[i];
+
+            if (!e->IsSuspended() && !e->IsLODSkipped())
+            {
+                m_numActiveActors++;
+                m_numComponents += static_cast<std::uint32_t>(e->GetNodeList().size());
+            }
+        }
+
+        if (m_batchedMotion)
+            m_motionBatch.Build(m_actors, m_scalarMotion);
+
+        auto& driverConf = DCBP::GetDriverConfig();
+
+        m_parallelMotion =
+            driverConf.multiThreadedMotionUpdates &&
+            IThreadPool::GetNumThreads() > 0 &&
+            m_numActiveActors >= driverConf.multiThreadedMotionMinActors;
+    }
+
+    std::uint32_t ControllerTask::CountSteps(
+        float a_timeStep,
+        float a_timeTick,
+        float a_maxTime)
+    {
+        std::uint32_t numSteps(1);
+
+        while (a_timeStep >= a_maxTime)
+        {
+            a_timeStep -= a_timeTick;
+            numSteps++;
+        }
+
+        return numSteps;
+    }
+
+    void ControllerTask::SelectSubSteps(std::uint32_t a_numSteps)
+    {
+        auto numSteps = a_numSteps;
+
+        m_numSteps = numSteps;
+
+        auto data = m_actors.getdata();
+        auto size = m_actors.vecsize();
+
+        const auto& physConf = IConfig::GetGlobal().phys;
+
+        if (!physConf.adaptiveSubSteps)
         {
-#endif
             for (std::size_t i = 0; i < size; i++)
+                data[i]->SetSubSteps(data[i]->IsLODSkipped() ? 0 : numSteps);
+
+            m_numComponentSteps = m_numComponents * numSteps;
+
+            return;
+        }
+
+        float invVelocity = 1.0f / physConf.adaptiveVelocity;
+        float invViolation = 1.0f / physConf.adaptiveViolation;
+
+        std::uint32_t total(0);
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto e = data[i];
+
+            if (e->IsSuspended())
+                continue;
+
+            if (e->IsLODSkipped())
             {
-                data[i]->UpdateMotion(a_timeStep);
+                e->SetSubSteps(0);
+                continue;
             }
 
-#if 0
+            total += e->SelectSubSteps(numSteps, invVelocity, invViolation) *
+                static_cast<std::uint32_t>(e->GetNodeList().size());
         }
 
-#endif
-        /*concurrency::parallel_for(std::size_t(0), size, [&](std::size_t a_index) {
-            data[a_index]->UpdateMotion(a_timeStep);
-        });*/
+        auto budget = static_cast<std::uint32_t>(physConf.subStepBudget);
+
+        if (budget > 0 && total > budget)
+        {
+            // scale everyone down evenly, each actor keeps at least one step
+            float scale = static_cast<float>(budget) / static_cast<float>(total);
+
+            total = 0;
+
+            for (std::size_t i = 0; i < size; i++)
+            {
+                auto e = data[i];
+
+                if (e->IsSuspended() || e->IsLODSkipped())
+                    continue;
+
+                auto steps = std::max(static_cast<std::uint32_t>(static_cast<float>(e->GetSubSteps()) * scale), 1U);
+
+                e->SetSubSteps(steps);
+
+                total += steps * static_cast<std::uint32_t>(e->GetNodeList().size());
+            }
+        }
+
+        m_numComponentSteps = total;
+    }
+
+    void ControllerTask::UpdateActorsPhase2(float a_timeStep, std::uint32_t a_step)
+    {
+        auto start = IPerfCounter::Query();
+
+        auto data = m_actors.getdata();
+        auto size = m_actors.vecsize();
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            data[i]->AdvanceSubStep(a_step, m_numSteps, a_timeStep);
+        }
+
+        if (m_batchedMotion)
+        {
+            m_motionBatch.Update(m_parallelMotion);
+        }
+        else
+        {
+            if (m_parallelMotion)
+            {
+                IThreadPool::ParallelFor(static_cast<std::uint32_t>(size), 1,
+                    [&](std::uint32_t a_begin, std::uint32_t a_end)
+                    {
+                        for (auto i = a_begin; i < a_end; i++)
+                        {
+                            auto timeStep = data[i]->GetStepTime();
+                            if (timeStep > 0.0f)
+                                data[i]->UpdateMotion(timeStep);
+                        }
+                    });
+            }
+            else
+            {
+                for (std::size_t i = 0; i < size; i++)
+                {
+                    auto timeStep = data[i]->GetStepTime();
+                    if (timeStep > 0.0f)
+                        data[i]->UpdateMotion(timeStep);
+                }
+            }
+        }
 
+        m_motionTicks += IPerfCounter::Query() - start;
     }
 
     std::uint32_t ControllerTask::UpdatePhase2(
@@ -138,17 +409,19 @@ namespace CBP
         float a_timeTick,
         float a_maxTime)
     {
+        SelectSubSteps(CountSteps(a_timeStep, a_timeTick, a_maxTime));
+
         std::uint32_t c(1);
 
         while (a_timeStep >= a_maxTime)
         {
-            UpdateActorsPhase2(a_timeTick);
+            UpdateActorsPhase2(a_timeTick, c - 1);
             a_timeStep -= a_timeTick;
 
             c++;
         }
 
-        UpdateActorsPhase2(a_timeStep);
+        UpdateActorsPhase2(a_timeStep, c - 1);
 
         return c;
     }
@@ -158,31 +431,70 @@ namespace CBP
         float a_timeTick,
         float a_maxTime)
     {
+        SelectSubSteps(CountSteps(a_timeStep, a_timeTick, a_maxTime));
+
         std::uint32_t c(1);
 
         while (a_timeStep >= a_maxTime)
         {
-            UpdateActorsPhase2(a_timeTick);
-            ICollision::DoCollisionDetection(a_timeTick);
+            UpdateActorsPhase2(a_timeTick, c - 1);
+            DoCollisionDetection(a_timeTick);
             a_timeStep -= a_timeTick;
 
             c++;
         }
 
-        UpdateActorsPhase2(a_timeStep);
-        ICollision::DoCollisionDetection(a_timeStep);
+        UpdateActorsPhase2(a_timeStep, c - 1);
+        DoCollisionDetection(a_timeStep);
 
         return c;
     }
 
-    void ControllerTask::UpdatePhase3()
+    std::uint32_t ControllerTask::UpdatePhase2Fixed(
+        std::uint32_t a_numSteps,
+        float a_timeTick,
+        bool a_collisions)
+    {
+        SelectSubSteps(a_numSteps);
+
+        auto data = m_actors.getdata();
+        auto size = m_actors.vecsize();
+
+        for (std::uint32_t i = 0; i < a_numSteps; i++)
+        {
+            // render interpolation blends between the last two full ticks
+            if (i == a_numSteps - 1)
+            {
+                for (std::size_t j = 0; j < size; j++)
+                    data[j]->SaveInterpolationSource();
+            }
+
+            UpdateActorsPhase2(a_timeTick, i);
+
+            if (a_collisions)
+                DoCollisionDetection(a_timeTick);
+        }
+
+        return a_numSteps;
+    }
+
+    void ControllerTask::DoCollisionDetection(float a_timeStep)
+    {
+        auto start = IPerfCounter::Query();
+
+        ICollision::DoCollisionDetection(a_timeStep);
+
+        m_collisionTicks += IPerfCounter::Query() - start;
+    }
+
+    void ControllerTask::UpdatePhase3(float a_alpha, bool a_interpolate)
     {
         auto data = m_actors.getdata();
         auto size = m_actors.vecsize();
 
         for (std::size_t i = 0; i < size; i++)
         {
-            data[i]->WriteTransforms();
+            data[i]->WriteTransforms(a_alpha, a_interpolate);
         }
     }
 
@@ -220,15 +532,35 @@ namespace CBP
 
         std::uint32_t steps;
 
-        if (m_timeAccum > timeTick * 0.25f)
+        if (globalConfig.phys.fixedRate)
+        {
+            steps = UpdatePhysicsFixed();
+        }
+        else if (m_timeAccum > timeTick * 0.25f)
         {
             float timeStep = std::min(m_timeAccum,
                 timeTick * globalConfig.phys.maxSubSteps);
 
+            m_batchedMotion = globalConfig.phys.batchedMotion;
+
+            UpdateLOD(m_timeAccum);
             UpdatePhase1(m_timeAccum);
+            PrepareMotion();
 
             float maxTime = timeTick * 1.25f;
 
+            if (m_recorder.IsRecording())
+            {
+                m_recorder.RecordFrame(
+                    m_actors,
+                    m_timeAccum,
+                    timeStep,
+                    timeTick,
+                    maxTime,
+                    globalConfig.phys.collision,
+                    0);
+            }
+
             if (globalConfig.phys.collision) {
                 steps = UpdatePhase2Collisions(timeStep, timeTick, maxTime);
             }
@@ -236,7 +568,10 @@ namespace CBP
                 steps = UpdatePhase2(timeStep, timeTick, maxTime);
             }
 
-            UpdatePhase3();
+            UpdatePhase3(1.0f, false);
+
+            if (m_batchedMotion)
+                m_motionBatch.Clear();
 
 #ifdef _CBP_ENABLE_DEBUG
             UpdateDebugInfo();
@@ -255,6 +590,57 @@ namespace CBP
         return steps;
     }
 
+    std::uint32_t ControllerTask::UpdatePhysicsFixed()
+    {
+        const auto& globalConfig = IConfig::GetGlobal();
+
+        float timeTick = globalConfig.phys.timeTick;
+
+        // don't try to catch up on more than one frame's worth of steps after a hitch
+        m_timeAccum = std::min(m_timeAccum, timeTick * globalConfig.phys.maxSubSteps);
+
+        auto numSteps = static_cast<std::uint32_t>(m_timeAccum / timeTick);
+
+        if (numSteps > 0)
+        {
+            float timeStep = timeTick * static_cast<float>(numSteps);
+
+            m_batchedMotion = globalConfig.phys.batchedMotion;
+
+            UpdateLOD(timeStep);
+            UpdatePhase1(timeStep);
+            PrepareMotion();
+
+            if (m_recorder.IsRecording())
+            {
+                m_recorder.RecordFrame(
+                    m_actors,
+                    timeStep,
+                    timeStep,
+                    timeTick,
+                    timeTick,
+                    globalConfig.phys.collision,
+                    numSteps);
+            }
+
+            UpdatePhase2Fixed(numSteps, timeTick, globalConfig.phys.collision);
+
+            if (m_batchedMotion)
+                m_motionBatch.Clear();
+
+#ifdef _CBP_ENABLE_DEBUG
+            UpdateDebugInfo();
+#endif
+
+            m_timeAccum = std::max(m_timeAccum - timeStep, 0.0f);
+        }
+
+        // remainder carries over, render between the last two ticks
+        UpdatePhase3(std::min(m_timeAccum / timeTick, 1.0f), true);
+
+        return numSteps;
+    }
+
     void ControllerTask::PhysicsTick(Game::BSMain* a_main, float a_interval)
     {
         const auto& globalConfig = IConfig::GetGlobal();
@@ -264,10 +650,206 @@ namespace CBP
         if (profiling)
             m_profiler.Begin();
 
+        m_motionTicks = 0;
+        m_collisionTicks = 0;
+        m_numComponents = 0;
+        m_numActiveActors = 0;
+        m_numComponentSteps = 0;
+
         auto steps = UpdatePhysics(a_main, a_interval);
 
+        std::uint32_t sleeps, wakes;
+        SimComponent::ConsumeSleepStats(sleeps, wakes);
+
         if (profiling)
+        {
+            std::uint32_t sleeping(0);
+
+            if (globalConfig.phys.sleep)
+            {
+                for (auto e : m_actors.getvec())
+                {
+                    if (e->IsSuspended())
+                        continue;
+
+                    for (auto& f : e->GetNodeList())
+                        sleeping += f->IsSleeping();
+                }
+            }
+
+            m_profiler.AddSleepStats(sleeping, sleeps, wakes);
+
+            if (globalConfig.phys.collision)
+            {
+                BroadphaseType type;
+                long long ticks;
+                std::uint32_t numSteps;
+
+                ICollision::ConsumeBroadphaseStats(type, ticks, numSteps);
+
+                m_profiler.AddBroadphaseTime(
+                    static_cast<std::uint32_t>(type) - 1,
+                    IPerfCounter::delta_us(0, ticks),
+                    numSteps);
+
+                poolStats_t poolStats;
+                ICollision::GetPoolStats(poolStats);
+
+                m_profiler.AddManifoldCount(poolStats.numManifolds);
+            }
+
+            m_profiler.AddMotionTime(IPerfCounter::delta_us(0, m_motionTicks), m_numComponentSteps);
             m_profiler.End(static_cast<std::uint32_t>(m_actors.size()), steps, a_interval);
+        }
+    }
+
+    void ControllerTask::StartRecording()
+    {
+        for (auto e : m_actors.getvec())
+        {
+            if (!e->IsSuspended())
+                e->ClearLOD();
+        }
+
+        m_recorder.Begin(m_actors);
+    }
+
+    std::unique_ptr<SimRecording> ControllerTask::StopRecording()
+    {
+        return m_recorder.End(m_actors);
+    }
+
+    bool ControllerTask::Replay(
+        const SimRecording& a_recording,
+        replayResult_t& a_result)
+    {
+        if (m_recorder.IsRecording())
+        {
+            Warning("Can't replay while recording");
+            return false;
+        }
+
+        std::uint32_t configMismatches;
+
+        if (!SimRecorder::Match(m_actors, a_recording, configMismatches))
+        {
+            Warning("Recorded actors/nodes don't match the current scene");
+            return false;
+        }
+
+        auto daz = _MM_GET_DENORMALS_ZERO_MODE();
+        auto ftz = _MM_GET_FLUSH_ZERO_MODE();
+
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+
+        const auto& globalConfig = IConfig::GetGlobal();
+
+        m_batchedMotion = globalConfig.phys.batchedMotion;
+        m_motionTicks = 0;
+        m_collisionTicks = 0;
+
+        for (auto e : m_actors.getvec())
+        {
+            if (!e->IsSuspended())
+                e->ClearLOD();
+        }
+
+        long long readTicks(0);
+
+        auto steps = ReplayFrames(a_recording, a_result.finalState, readTicks);
+
+        a_result.motionTime = IPerfCounter::delta_us(0, m_motionTicks);
+        a_result.collisionTime = IPerfCounter::delta_us(0, m_collisionTicks);
+
+        // level ordered execution must reproduce the serial per-actor node order bit for bit. Both
+        // runs use the scalar integrator so SIMD rounding doesn't show up as an ordering error
+        a_result.orderChecked = m_batchedMotion;
+
+        if (m_batchedMotion)
+        {
+            std::vector<float> levelState;
+            std::vector<float> serialState;
+            long long ticks(0);
+
+            m_scalarMotion = true;
+            ReplayFrames(a_recording, levelState, ticks);
+            m_scalarMotion = false;
+
+            m_batchedMotion = false;
+            ReplayFrames(a_recording, serialState, ticks);
+
+            SimRecorder::CompareState(
+                levelState,
+                serialState,
+                a_result.numOrderMismatches,
+                a_result.maxOrderError);
+        }
+        else
+        {
+            a_result.numOrderMismatches = 0;
+            a_result.maxOrderError = 0.0f;
+        }
+
+        a_result.orderPassed = a_result.numOrderMismatches == 0;
+
+        _MM_SET_DENORMALS_ZERO_MODE(daz);
+        _MM_SET_FLUSH_ZERO_MODE(ftz);
+
+        a_result.numFrames = static_cast<std::uint32_t>(a_recording.frames.size());
+        a_result.numSteps = steps;
+        a_result.numComponents = static_cast<std::uint32_t>(a_recording.components.size());
+        a_result.numConfigMismatches = configMismatches;
+        a_result.readTime = IPerfCounter::delta_us(0, readTicks);
+
+        SimRecorder::CompareState(
+            a_recording.finalState,
+            a_result.finalState,
+            a_result.numStateMismatches,
+            a_result.maxStateError);
+
+        // hand the nodes back to the live simulation
+        for (auto& e : m_actors)
+            e.second.Reset();
+
+        return true;
+    }
+
+    std::uint32_t ControllerTask::ReplayFrames(
+        const SimRecording& a_recording,
+        std::vector<float>& a_finalState,
+        long long& a_readTicks)
+    {
+        std::uint32_t steps(0);
+
+        SimRecorder::RestoreState(m_actors, a_recording.initialState);
+
+        for (auto& e : a_recording.frames)
+        {
+            auto start = IPerfCounter::Query();
+
+            SimRecorder::InjectTransforms(m_actors, e);
+            PrepareMotion();
+
+            a_readTicks += IPerfCounter::Query() - start;
+
+            if (e.fixedSteps) {
+                steps += UpdatePhase2Fixed(e.fixedSteps, e.timeTick, e.collisions);
+            }
+            else if (e.collisions) {
+                steps += UpdatePhase2Collisions(e.timeStep, e.timeTick, e.maxTime);
+            }
+            else {
+                steps += UpdatePhase2(e.timeStep, e.timeTick, e.maxTime);
+            }
+
+            if (m_batchedMotion)
+                m_motionBatch.Clear();
+        }
+
+        SimRecorder::CaptureState(m_actors, a_finalState);
+
+        return steps;
     }
 
     void ControllerTask::Run()
@@ -578,6 +1160,12 @@ namespace CBP
         }
     }
 
+    void ControllerTask::ApplyForces(const std::vector<impulseRequest_t>& a_requests)
+    {
+        for (auto& e : a_requests)
+            ApplyForce(e.handle, e.steps, e.component, e.force);
+    }
+
     void ControllerTask::ClearActors(
         bool a_noNotify, 
         bool a_release, 
@@ -898,6 +1486,18 @@ namespace CBP
         }
     }
 
+    void ControllerTask::UpdateBoneCastColliders()
+    {
+        std::vector<Game::VMHandle> handles;
+
+        if (!IBoneCast::ProcessCompleted(handles))
+            return;
+
+        // swaps the proxy shapes for the finished geometry
+        for (auto& e : handleSet_t(handles.begin(), handles.end()))
+            UpdateConfig(e);
+    }
+
     void ControllerTask::ProcessTasks()
     {
         for (;;)
@@ -963,6 +1563,8 @@ namespace CBP
                 break;
             }
         }
+
+        UpdateBoneCastColliders();
     }
 
     void ControllerTask::GatherActors(handleSet_t& a_out)
@@ -8,6 +8,9 @@
 #include "Profiling.h"
 #include "ControllerInstruction.h"
 #include "SimObject.h"
+#include "MotionBatch.h"
+#include "SimRecorder.h"
+#include "Culling.h"
 
 namespace Game
 {
@@ -43,10 +46,17 @@ namespace CBP
 
     private:
 
+        SKMP_FORCEINLINE void UpdateVisibility();
+        SKMP_FORCEINLINE void UpdateLOD(float a_interval);
         SKMP_FORCEINLINE void UpdatePhase1(float a_timeStep);
-        SKMP_FORCEINLINE void UpdateActorsPhase2(float a_timeStep);
+        SKMP_FORCEINLINE void PrepareMotion();
+        SKMP_FORCEINLINE static std::uint32_t CountSteps(float a_timeStep, float a_timeTick, float a_maxTime);
+        SKMP_FORCEINLINE void SelectSubSteps(std::uint32_t a_numSteps);
+        SKMP_FORCEINLINE void UpdateActorsPhase2(float a_timeStep, std::uint32_t a_step);
+        SKMP_FORCEINLINE void DoCollisionDetection(float a_timeStep);
 
         SKMP_FORCEINLINE std::uint32_t UpdatePhysics(Game::BSMain* a_main, float a_interval);
+        SKMP_FORCEINLINE std::uint32_t UpdatePhysicsFixed();
 
 #ifdef _CBP_ENABLE_DEBUG
         SKMP_FORCEINLINE void UpdateDebugInfo();
@@ -62,7 +72,14 @@ namespace CBP
             float a_timeTick,
             float a_maxTime);
 
-        SKMP_FORCEINLINE void UpdatePhase3();
+        SKMP_FORCEINLINE std::uint32_t UpdatePhase2Fixed(
+            std::uint32_t a_numSteps,
+            float a_timeTick,
+            bool a_collisions);
+
+        SKMP_FORCEINLINE void UpdatePhase3(float a_alpha, bool a_interpolate);
+
+        std::uint32_t ReplayFrames(const SimRecording& a_recording, std::vector<float>& a_finalState, long long& a_readTicks);
 
         void AddActor(Game::VMHandle a_handle);
         simActorList_t::iterator RemoveActor(simActorList_t::iterator a_iterator);
@@ -80,6 +97,7 @@ namespace CBP
         void UpdateArmorOverridesAll();
         void ClearArmorOverrides();
         void ValidateNodes(Game::VMHandle a_handle);
+        void UpdateBoneCastColliders();
 
     public:
         void RemoveActor(Game::VMHandle a_handle);
@@ -94,11 +112,21 @@ namespace CBP
             const stl::fixed_string& a_component,
             const btVector3& a_force);
 
+        void ApplyForces(const std::vector<impulseRequest_t>& a_requests);
+
         void UpdateConfig(Game::VMHandle a_handle, bool a_addIfMissing = false);
         void UpdateConfig(Game::VMHandle a_handle, Actor* a_actor, bool a_addIfMissing = false);
 
         void UpdateDebugRenderer();
 
+        void StartRecording();
+        [[nodiscard]] std::unique_ptr<SimRecording> StopRecording();
+        bool Replay(const SimRecording& a_recording, replayResult_t& a_result);
+
+        [[nodiscard]] SKMP_FORCEINLINE const auto& GetRecorder() const {
+            return m_recorder;
+        }
+
         SKMP_FORCEINLINE const auto& GetSimActorList() const {
             return m_actors;
         };
@@ -162,6 +190,22 @@ namespace CBP
         float m_timeAccum;
         float m_averageInterval;
 
+        MotionBatch m_motionBatch;
+        bool m_batchedMotion;
+        bool m_scalarMotion;
+        bool m_parallelMotion;
+
+        long long m_motionTicks;
+        long long m_collisionTicks;
+        std::uint32_t m_numComponents;
+        std::uint32_t m_numActiveActors;
+        std::uint32_t m_numSteps;
+        std::uint32_t m_numComponentSteps;
+
+        SimRecorder m_recorder;
+
+        Culling::SphereBatch m_cullBatch;
+
         Profiler m_profiler;
         //PerfTimerInt m_pt;
     };
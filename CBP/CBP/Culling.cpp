@@ -0,0 +1,261 @@
+#include "pch.h"
+
+#include "Culling.h"
+#include "Benchmark.h"
+
+namespace CBP
+{
+    namespace Culling
+    {
+        SKMP_FORCEINLINE static void SetPlane(
+            float (&a_plane)[4],
+            float a_x,
+            float a_y,
+            float a_z,
+            float a_w)
+        {
+            auto l = std::sqrtf(a_x * a_x + a_y * a_y + a_z * a_z);
+            auto inv = l > _EPSILON ? 1.0f / l : 0.0f;
+
+            a_plane[0] = a_x * inv;
+            a_plane[1] = a_y * inv;
+            a_plane[2] = a_z * inv;
+            a_plane[3] = a_w * inv;
+        }
+
+        void ExtractFrustum(const float* a_m, frustum_t& a_out)
+        {
+            auto r0 = a_m;
+            auto r1 = a_m + 4;
+            auto r3 = a_m + 12;
+
+            SetPlane(a_out.planes[0], r3[0] + r0[0], r3[1] + r0[1], r3[2] + r0[2], r3[3] + r0[3]);
+            SetPlane(a_out.planes[1], r3[0] - r0[0], r3[1] - r0[1], r3[2] - r0[2], r3[3] - r0[3]);
+            SetPlane(a_out.planes[2], r3[0] + r1[0], r3[1] + r1[1], r3[2] + r1[2], r3[3] + r1[3]);
+            SetPlane(a_out.planes[3], r3[0] - r1[0], r3[1] - r1[1], r3[2] - r1[2], r3[3] - r1[3]);
+
+            // w > 0, no far plane - distance is up to the LOD bands
+            SetPlane(a_out.planes[4], r3[0], r3[1], r3[2], r3[3]);
+        }
+
+        void MakeViewProjection(
+            const btVector3& a_eye,
+            const btVector3& a_dir,
+            const btVector3& a_up,
+            float a_fovY,
+            float a_aspect,
+            float a_near,
+            float a_far,
+            float (&a_out)[4][4])
+        {
+            auto f = a_dir.normalized();
+            auto s = f.cross(a_up).normalized();
+            auto u = s.cross(f);
+
+            auto sy = 1.0f / std::tanf(a_fovY * 0.5f);
+            auto sx = sy / a_aspect;
+            auto sz = a_far / (a_far - a_near);
+
+            auto row = [&](float(&a_row)[4], const btVector3& a_axis, float a_scale, float a_offset)
+            {
+                a_row[0] = a_axis.x() * a_scale;
+                a_row[1] = a_axis.y() * a_scale;
+                a_row[2] = a_axis.z() * a_scale;
+                a_row[3] = -a_axis.dot(a_eye) * a_scale + a_offset;
+            };
+
+            row(a_out[0], s, sx, 0.0f);
+            row(a_out[1], u, sy, 0.0f);
+            row(a_out[2], f, sz, -a_near * sz);
+            row(a_out[3], f, 1.0f, 0.0f);
+        }
+
+        bool TestSphere(
+            const frustum_t& a_frustum,
+            const btVector3& a_center,
+            float a_radius)
+        {
+            for (auto& p : a_frustum.planes)
+            {
+                if (p[0] * a_center.x() + p[1] * a_center.y() + p[2] * a_center.z() + p[3] < -a_radius)
+                    return false;
+            }
+
+            return true;
+        }
+
+        void TestSpheres(
+            const frustum_t& a_frustum,
+            const float* a_x,
+            const float* a_y,
+            const float* a_z,
+            const float* a_radius,
+            std::uint8_t* a_out,
+            std::size_t a_count)
+        {
+            __m128 planes[NUM_PLANES][4];
+
+            for (std::size_t i = 0; i < NUM_PLANES; i++)
+                for (std::size_t j = 0; j < 4; j++)
+                    planes[i][j] = _mm_set_ps1(a_frustum.planes[i][j]);
+
+            auto zero = _mm_setzero_ps();
+
+            for (std::size_t i = 0; i < a_count; i += 4)
+            {
+                auto x = _mm_load_ps(a_x + i);
+                auto y = _mm_load_ps(a_y + i);
+                auto z = _mm_load_ps(a_z + i);
+                auto r = _mm_load_ps(a_radius + i);
+
+                auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+                for (auto& p : planes)
+                {
+                    auto d = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(p[0], x), _mm_mul_ps(p[1], y)),
+                        _mm_add_ps(_mm_mul_ps(p[2], z), _mm_add_ps(p[3], r)));
+
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+                }
+
+                auto mask = _mm_movemask_ps(inside);
+
+                a_out[i] = mask & 0x1;
+                a_out[i + 1] = (mask >> 1) & 0x1;
+                a_out[i + 2] = (mask >> 2) & 0x1;
+                a_out[i + 3] = (mask >> 3) & 0x1;
+            }
+        }
+
+        void SphereBatch::Clear()
+        {
+            m_count = 0;
+        }
+
+        void SphereBatch::Add(const btVector3& a_center, float a_radius)
+        {
+            if (m_count == m_x.size())
+            {
+                auto size = std::max<std::size_t>(m_x.size() * 2, 64);
+
+                m_x.resize(size);
+                m_y.resize(size);
+                m_z.resize(size);
+                m_radius.resize(size);
+                m_visible.resize(size);
+            }
+
+            m_x[m_count] = a_center.x();
+            m_y[m_count] = a_center.y();
+            m_z[m_count] = a_center.z();
+            m_radius[m_count] = a_radius;
+
+            m_count++;
+        }
+
+        void SphereBatch::Test(const frustum_t& a_frustum)
+        {
+            // capacity is always a multiple of 4, padding lanes are never read
+            TestSpheres(
+                a_frustum,
+                m_x.data(),
+                m_y.data(),
+                m_z.data(),
+                m_radius.data(),
+                m_visible.data(),
+                (m_count + 3) & ~std::size_t(3));
+        }
+
+        void RunSelfTest(std::uint32_t a_count, selfTestResult_t& a_out)
+        {
+            constexpr std::uint32_t NUM_FRUSTA = 16;
+
+            BenchmarkRandom rnd(0x9E3779B9);
+
+            auto count = BenchmarkCount(a_count, 4);
+
+            stl::vector_simd<btVector3> centers(count);
+            std::vector<float> radii(count);
+
+            SphereBatch batch;
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                centers[i].setValue(rnd.Signed() * 3000.0f, rnd.Signed() * 3000.0f, rnd.Signed() * 3000.0f);
+
+                // every fourth sphere is a point, checked against the projection itself
+                radii[i] = (i & 3) == 0 ? 0.0f : 105.0f + rnd.Signed() * 95.0f;
+
+                batch.Add(centers[i], radii[i]);
+            }
+
+            std::vector<std::uint8_t> scalar(count);
+
+            a_out = selfTestResult_t{ NUM_FRUSTA, static_cast<std::uint32_t>(count), 0, 0, 0, 0, 0 };
+
+            for (std::uint32_t f = 0; f < NUM_FRUSTA; f++)
+            {
+                btVector3 eye(rnd.Signed() * 1000.0f, rnd.Signed() * 1000.0f, rnd.Signed() * 1000.0f);
+                btVector3 dir(rnd.Signed(), rnd.Signed(), rnd.Signed() * 0.5f);
+
+                if (dir.length2() < 0.01f)
+                    dir.setValue(1.0f, 0.0f, 0.0f);
+
+                float m[4][4];
+
+                MakeViewProjection(
+                    eye, dir, btVector3(0.0f, 0.0f, 1.0f),
+                    65.0f * std::numbers::pi_v<float> / 180.0f,
+                    16.0f / 9.0f, 15.0f, 350000.0f, m);
+
+                frustum_t frustum;
+                ExtractFrustum(std::addressof(m[0][0]), frustum);
+
+                auto start = IPerfCounter::Query();
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    scalar[i] = TestSphere(frustum, centers[i], radii[i]) ? 1 : 0;
+                }
+
+                auto t1 = IPerfCounter::Query();
+
+                batch.Test(frustum);
+
+                auto t2 = IPerfCounter::Query();
+
+                a_out.scalarTime += IPerfCounter::delta_us(start, t1);
+                a_out.simdTime += IPerfCounter::delta_us(t1, t2);
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    bool visible = batch.IsVisible(i);
+
+                    if (visible)
+                        a_out.numVisible++;
+
+                    if (visible != (scalar[i] != 0))
+                        a_out.numMismatches++;
+
+                    if ((i & 3) != 0)
+                        continue;
+
+                    auto& c = centers[i];
+
+                    float p[4];
+
+                    for (int r = 0; r < 4; r++)
+                        p[r] = m[r][0] * c.x() + m[r][1] * c.y() + m[r][2] * c.z() + m[r][3];
+
+                    bool projected = p[3] > 1e-5f &&
+                        std::fabs(p[0] / p[3]) <= 1.0f &&
+                        std::fabs(p[1] / p[3]) <= 1.0f;
+
+                    if (visible != projected)
+                        a_out.numPointMismatches++;
+                }
+            }
+        }
+    }
+}
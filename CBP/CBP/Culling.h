@@ -0,0 +1,85 @@
+#pragma once
+
+namespace CBP
+{
+    namespace Culling
+    {
+        static constexpr std::size_t NUM_PLANES = 5;
+
+        // left, right, bottom, top and the plane through the eye, normals point inwards, w = distance
+        struct SKMP_ALIGN(16) frustum_t
+        {
+            float planes[NUM_PLANES][4];
+        };
+
+        // a_m: 4x4 row major world to clip matrix as used by WorldPtToScreenPt3 (rows x, y, z, w)
+        void ExtractFrustum(const float* a_m, frustum_t& a_out);
+
+        void MakeViewProjection(
+            const btVector3& a_eye,
+            const btVector3& a_dir,
+            const btVector3& a_up,
+            float a_fovY,
+            float a_aspect,
+            float a_near,
+            float a_far,
+            float (&a_out)[4][4]);
+
+        [[nodiscard]] bool TestSphere(
+            const frustum_t& a_frustum,
+            const btVector3& a_center,
+            float a_radius);
+
+        // arrays must be 16 byte aligned, a_count a multiple of 4
+        void TestSpheres(
+            const frustum_t& a_frustum,
+            const float* a_x,
+            const float* a_y,
+            const float* a_z,
+            const float* a_radius,
+            std::uint8_t* a_out,
+            std::size_t a_count);
+
+        class SphereBatch
+        {
+        public:
+
+            void Clear();
+            void Add(const btVector3& a_center, float a_radius);
+            void Test(const frustum_t& a_frustum);
+
+            [[nodiscard]] SKMP_FORCEINLINE bool IsVisible(std::size_t a_index) const {
+                return m_visible[a_index] != 0;
+            }
+
+            [[nodiscard]] SKMP_FORCEINLINE std::size_t Size() const {
+                return m_count;
+            }
+
+        private:
+
+            stl::vector_simd<float> m_x;
+            stl::vector_simd<float> m_y;
+            stl::vector_simd<float> m_z;
+            stl::vector_simd<float> m_radius;
+            std::vector<std::uint8_t> m_visible;
+
+            std::size_t m_count{ 0 };
+        };
+
+        struct selfTestResult_t
+        {
+            std::uint32_t numFrusta;
+            std::uint32_t numSpheres;
+            std::uint32_t numVisible;
+            std::uint32_t numMismatches;
+            std::uint32_t numPointMismatches;
+
+            long long scalarTime;
+            long long simdTime;
+        };
+
+        // synthetic cameras and spheres, SIMD against scalar results and zero radius spheres against projected points
+        void RunSelfTest(std::uint32_t a_count, selfTestResult_t& a_out);
+    }
+}
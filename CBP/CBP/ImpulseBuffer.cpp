@@ -0,0 +1,88 @@
+#include "pch.h"
+
+#include "ImpulseBuffer.h"
+
+namespace CBP
+{
+    IImpulseBuffer IImpulseBuffer::m_Instance;
+
+    IImpulseBuffer::IImpulseBuffer()
+    {
+        m_data.reserve(INITIAL_SLOTS * DEFAULT_SLOT_CAPACITY);
+        m_slots.reserve(INITIAL_SLOTS);
+    }
+
+    void IImpulseBuffer::SetSlotCapacity(std::uint32_t a_capacity)
+    {
+        auto& inst = m_Instance;
+
+        // slot offsets depend on it
+        if (!inst.m_slots.empty())
+            return;
+
+        inst.m_capacity = std::clamp(a_capacity, 1U, MAX_SLOT_CAPACITY);
+
+        inst.m_data.clear();
+        inst.m_data.shrink_to_fit();
+        inst.m_data.reserve(INITIAL_SLOTS * inst.m_capacity);
+    }
+
+    std::uint32_t IImpulseBuffer::Allocate()
+    {
+        auto& inst = m_Instance;
+
+        std::uint32_t slot;
+
+        if (!inst.m_free.empty())
+        {
+            slot = inst.m_free.back();
+            inst.m_free.pop_back();
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(inst.m_slots.size());
+
+            inst.m_slots.emplace_back();
+            inst.m_data.resize(inst.m_data.size() + inst.m_capacity);
+        }
+
+        inst.m_slots[slot] = slot_t{ 0, 0 };
+
+        return slot;
+    }
+
+    void IImpulseBuffer::Release(std::uint32_t a_slot)
+    {
+        if (a_slot == INVALID_SLOT)
+            return;
+
+        m_Instance.m_slots[a_slot].count = 0;
+        m_Instance.m_free.emplace_back(a_slot);
+    }
+
+    bool IImpulseBuffer::Push(
+        std::uint32_t a_slot,
+        std::uint32_t a_steps,
+        const btVector3& a_force)
+    {
+        auto& inst = m_Instance;
+        auto& slot = inst.m_slots[a_slot];
+
+        auto capacity = inst.m_capacity;
+
+        if (slot.count == capacity)
+        {
+            inst.m_numDropped++;
+            return false;
+        }
+
+        auto& e = inst.m_data[a_slot * capacity + (slot.head + slot.count) % capacity];
+
+        e.force = a_force;
+        e.numImpulses = a_steps;
+
+        slot.count++;
+
+        return true;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+namespace CBP
+{
+    struct impulseRequest_t
+    {
+        Game::VMHandle handle;
+        std::uint32_t steps;
+        stl::fixed_string component;
+        btVector3 force;
+    };
+
+    // queued ApplyForce impulses, one fixed size ring per component slot in a single preallocated array
+    class IImpulseBuffer
+    {
+        struct SKMP_ALIGN(16) impulse_t
+        {
+            btVector3 force;
+            std::uint32_t numImpulses;
+        };
+
+        struct slot_t
+        {
+            std::uint32_t head;
+            std::uint32_t count;
+        };
+
+    public:
+
+        // impulses pending per component, overflow is dropped and counted. The old per-node queues capped at 1000
+        static constexpr std::uint32_t DEFAULT_SLOT_CAPACITY = 16;
+        static constexpr std::uint32_t MAX_SLOT_CAPACITY = 1000;
+        static constexpr std::uint32_t INITIAL_SLOTS = 512;
+        static constexpr std::uint32_t INVALID_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+        // before the first Allocate only
+        static void SetSlotCapacity(std::uint32_t a_capacity);
+
+        [[nodiscard]] static std::uint32_t Allocate();
+        static void Release(std::uint32_t a_slot);
+
+        static bool Push(std::uint32_t a_slot, std::uint32_t a_steps, const btVector3& a_force);
+
+        SKMP_FORCEINLINE static void Clear(std::uint32_t a_slot)
+        {
+            m_Instance.m_slots[a_slot].count = 0;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE static bool Empty(std::uint32_t a_slot)
+        {
+            return m_Instance.m_slots[a_slot].count == 0;
+        }
+
+        // current impulse of the slot, moves on to the next one after it has been applied numImpulses + 1 times
+        SKMP_FORCEINLINE static bool Consume(std::uint32_t a_slot, btVector3& a_out)
+        {
+            auto& slot = m_Instance.m_slots[a_slot];
+
+            if (!slot.count)
+                return false;
+
+            auto capacity = m_Instance.m_capacity;
+
+            auto& e = m_Instance.m_data[a_slot * capacity + slot.head];
+
+            a_out = e.force;
+
+            if (!e.numImpulses--)
+            {
+                slot.head = (slot.head + 1) % capacity;
+                slot.count--;
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE static std::size_t GetNumSlots() {
+            return m_Instance.m_slots.size() - m_Instance.m_free.size();
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE static std::uint64_t GetNumDropped() {
+            return m_Instance.m_numDropped;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE static std::uint32_t GetSlotCapacity() {
+            return m_Instance.m_capacity;
+        }
+
+        IImpulseBuffer(const IImpulseBuffer&) = delete;
+        IImpulseBuffer(IImpulseBuffer&&) = delete;
+        IImpulseBuffer& operator=(const IImpulseBuffer&) = delete;
+        IImpulseBuffer& operator=(IImpulseBuffer&&) = delete;
+
+    private:
+        IImpulseBuffer();
+
+        stl::vector_simd<impulse_t> m_data;
+        std::vector<slot_t> m_slots;
+        std::vector<std::uint32_t> m_free;
+
+        std::uint32_t m_capacity{ DEFAULT_SLOT_CAPACITY };
+        std::uint64_t m_numDropped{ 0 };
+
+        static IImpulseBuffer m_Instance;
+    };
+}
@@ -0,0 +1,563 @@
+#include "pch.h"
+
+#include "MotionBatch.h"
+#include "SimObject.h"
+#include "SimComponent.h"
+#include "ThreadPool.h"
+#include "Rotation.h"
+#include "Constraints.h"
+
+namespace CBP
+{
+
+#if defined(__AVX2__)
+
+    typedef __m256 vfloat_t;
+
+    SKMP_FORCEINLINE static vfloat_t vload(const float* a_p) { return _mm256_load_ps(a_p); }
+    SKMP_FORCEINLINE static void vstore(float* a_p, vfloat_t a_v) { _mm256_store_ps(a_p, a_v); }
+    SKMP_FORCEINLINE static vfloat_t vset1(float a_v) { return _mm256_set1_ps(a_v); }
+    SKMP_FORCEINLINE static vfloat_t vzero() { return _mm256_setzero_ps(); }
+    SKMP_FORCEINLINE static vfloat_t vadd(vfloat_t a_a, vfloat_t a_b) { return _mm256_add_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vsub(vfloat_t a_a, vfloat_t a_b) { return _mm256_sub_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vmul(vfloat_t a_a, vfloat_t a_b) { return _mm256_mul_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vdiv(vfloat_t a_a, vfloat_t a_b) { return _mm256_div_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vmin(vfloat_t a_a, vfloat_t a_b) { return _mm256_min_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vmax(vfloat_t a_a, vfloat_t a_b) { return _mm256_max_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vsqrt(vfloat_t a_v) { return _mm256_sqrt_ps(a_v); }
+    SKMP_FORCEINLINE static vfloat_t vor(vfloat_t a_a, vfloat_t a_b) { return _mm256_or_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vcmpgt(vfloat_t a_a, vfloat_t a_b) { return _mm256_cmp_ps(a_a, a_b, _CMP_GT_OQ); }
+    SKMP_FORCEINLINE static vfloat_t vcmpge(vfloat_t a_a, vfloat_t a_b) { return _mm256_cmp_ps(a_a, a_b, _CMP_GE_OQ); }
+    SKMP_FORCEINLINE static vfloat_t vsel(vfloat_t a_mask, vfloat_t a_a, vfloat_t a_b) { return _mm256_blendv_ps(a_b, a_a, a_mask); }
+    SKMP_FORCEINLINE static std::uint32_t vmovemask(vfloat_t a_v) { return static_cast<std::uint32_t>(_mm256_movemask_ps(a_v)); }
+    SKMP_FORCEINLINE static vfloat_t vabs(vfloat_t a_v) {
+        return _mm256_and_ps(a_v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)));
+    }
+
+#else
+
+    typedef __m128 vfloat_t;
+
+    SKMP_FORCEINLINE static vfloat_t vload(const float* a_p) { return _mm_load_ps(a_p); }
+    SKMP_FORCEINLINE static void vstore(float* a_p, vfloat_t a_v) { _mm_store_ps(a_p, a_v); }
+    SKMP_FORCEINLINE static vfloat_t vset1(float a_v) { return _mm_set_ps1(a_v); }
+    SKMP_FORCEINLINE static vfloat_t vzero() { return _mm_setzero_ps(); }
+    SKMP_FORCEINLINE static vfloat_t vadd(vfloat_t a_a, vfloat_t a_b) { return _mm_add_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vsub(vfloat_t a_a, vfloat_t a_b) { return _mm_sub_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vmul(vfloat_t a_a, vfloat_t a_b) { return _mm_mul_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vdiv(vfloat_t a_a, vfloat_t a_b) { return _mm_div_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vmin(vfloat_t a_a, vfloat_t a_b) { return _mm_min_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vmax(vfloat_t a_a, vfloat_t a_b) { return _mm_max_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vsqrt(vfloat_t a_v) { return _mm_sqrt_ps(a_v); }
+    SKMP_FORCEINLINE static vfloat_t vor(vfloat_t a_a, vfloat_t a_b) { return _mm_or_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vcmpgt(vfloat_t a_a, vfloat_t a_b) { return _mm_cmpgt_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vcmpge(vfloat_t a_a, vfloat_t a_b) { return _mm_cmpge_ps(a_a, a_b); }
+    SKMP_FORCEINLINE static vfloat_t vsel(vfloat_t a_mask, vfloat_t a_a, vfloat_t a_b) {
+        return _mm_or_ps(_mm_and_ps(a_mask, a_a), _mm_andnot_ps(a_mask, a_b));
+    }
+    SKMP_FORCEINLINE static std::uint32_t vmovemask(vfloat_t a_v) { return static_cast<std::uint32_t>(_mm_movemask_ps(a_v)); }
+    SKMP_FORCEINLINE static vfloat_t vabs(vfloat_t a_v) {
+        return _mm_and_ps(a_v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+    }
+
+#endif
+
+    SKMP_FORCEINLINE static vfloat_t vdot(
+        vfloat_t a_x, vfloat_t a_y, vfloat_t a_z,
+        vfloat_t a_bx, vfloat_t a_by, vfloat_t a_bz)
+    {
+        return vadd(vadd(vmul(a_x, a_bx), vmul(a_y, a_by)), vmul(a_z, a_bz));
+    }
+
+    void MotionBatch::Clear()
+    {
+        for (std::size_t i = 0; i < m_numLevels; i++)
+        {
+            m_levels[i].batched.clear();
+            m_levels[i].scalar.clear();
+        }
+
+        m_numBlocks = 0;
+        m_numLevels = 0;
+        m_numBatched = 0;
+        m_numScalar = 0;
+    }
+
+    void MotionBatch::Build(const simActorList_t& a_actors, bool a_scalarOnly)
+    {
+        Clear();
+
+        auto data = a_actors.getdata();
+        auto size = a_actors.vecsize();
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            auto e = data[i];
+
+            if (e->IsSuspended() || e->IsLODSkipped())
+                continue;
+
+            std::size_t numLevels = e->GetNumLevels();
+
+            if (numLevels > m_levels.size())
+                m_levels.resize(numLevels);
+
+            m_numLevels = std::max(m_numLevels, numLevels);
+
+            for (auto& n : e->GetNodeList())
+            {
+                auto sc = n.get();
+                auto& level = m_levels[sc->GetLevel()];
+
+                // the SIMD kernel only implements the default integrator
+                if (!a_scalarOnly &&
+                    sc->m_motion && !sc->m_sleeping &&
+                    sc->m_dp.integrator == IntegratorType::Legacy)
+                {
+                    level.batched.emplace_back(sc);
+                }
+                else
+                {
+                    level.scalar.emplace_back(sc);
+                    m_numScalar++;
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < m_numLevels; i++)
+        {
+            auto& level = m_levels[i];
+
+            level.firstBlock = m_numBlocks;
+            level.numBlocks = 0;
+
+            for (auto e : level.batched)
+                Add(level, e);
+        }
+    }
+
+    void MotionBatch::Add(level_t& a_level, SimComponent* a_sc)
+    {
+        if (!a_level.numBlocks || m_blocks[m_numBlocks - 1].count == NUM_LANES)
+        {
+            if (m_numBlocks == m_blocks.size())
+                m_blocks.emplace_back();
+
+            auto& b = m_blocks[m_numBlocks++];
+
+            a_level.numBlocks++;
+
+            std::memset(std::addressof(b), 0x0, sizeof(block_t));
+
+            // padding lanes must not produce resets or infinities
+            for (std::size_t i = 0; i < NUM_LANES; i++)
+            {
+                b.invMass[i] = 1.0f;
+                b.slackInvRange[i] = 1.0f;
+                b.maxVelocity[i] = 1.0f;
+                b.maxVelocity2[i] = std::numeric_limits<float>::max();
+            }
+        }
+
+        auto& b = m_blocks[m_numBlocks - 1];
+        auto i = b.count++;
+
+        m_numBatched++;
+
+        auto& dp = a_sc->m_dp;
+
+        b.sc[i] = a_sc;
+
+        SetTarget(b, i, a_sc);
+
+        b.stiffness[i] = dp.stiffness;
+        b.stiffness2[i] = dp.stiffness2;
+        b.slack[i] = dp.springSlack ? 1.0f : 0.0f;
+        b.slackOffset[i] = dp.slackOffset;
+        b.slackInvRange[i] = dp.slackInvRange;
+        b.gravForce[i] = dp.gravForce;
+        b.invMass[i] = dp.invMass;
+        b.damping[i] = dp.damping;
+        b.resistance[i] = dp.resistanceOn ? dp.resistance : 0.0f;
+        b.maxVelocity[i] = dp.maxVelocity;
+        b.maxVelocity2[i] = dp.maxVelocity2;
+
+        auto& fp = a_sc->m_conf.fp;
+
+        if ((dp.motionConstraints & MotionConstraints::Sphere) == MotionConstraints::Sphere)
+        {
+            b.sphere[i] = 1.0f;
+            b.sphereRadius[i] = fp.f32.maxOffsetSphereRadius;
+
+            for (int j = 0; j < 3; j++)
+                b.sphereOffset[j][i] = fp.vec.maxOffsetSphereOffset[j];
+
+            for (int j = 0; j < 4; j++)
+                b.sphereParams[j][i] = fp.f32.maxOffsetParamsSphere[j];
+
+            b.constrained = true;
+        }
+
+        if ((dp.motionConstraints & MotionConstraints::Box) == MotionConstraints::Box)
+        {
+            b.box[i] = 1.0f;
+
+            for (int j = 0; j < 3; j++)
+            {
+                b.boxMin[j][i] = fp.vec.maxOffsetN[j];
+                b.boxMax[j][i] = fp.vec.maxOffsetP[j];
+            }
+
+            for (int j = 0; j < 4; j++)
+                b.boxParams[j][i] = fp.f32.maxOffsetParamsBox[j];
+
+            b.constrained = true;
+        }
+    }
+
+    void MotionBatch::SetTarget(block_t& a_block, std::uint32_t a_index, SimComponent* a_sc)
+    {
+        auto& b = a_block;
+        auto i = a_index;
+
+        auto& parentWd = a_sc->GetParentWorldData();
+
+        auto target(((parentWd.m_rotation * a_sc->m_dp.cogOffset) *=
+            a_sc->m_objParent->m_worldTransform.scale) += parentWd.m_position);
+
+        b.tx[i] = target.x();
+        b.ty[i] = target.y();
+        b.tz[i] = target.z();
+
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                b.rot[r * 3 + c][i] = parentWd.m_rotation[r][c];
+    }
+
+    void MotionBatch::Gather(block_t& a_block, bool a_refreshTarget)
+    {
+        auto& b = a_block;
+
+        b.stepMask = 0;
+
+        for (std::uint32_t i = 0; i < b.count; i++)
+        {
+            auto sc = b.sc[i];
+
+            // actors skipping this step keep dt = 0 and are left untouched in Scatter
+            auto timeStep = sc->m_parent.GetStepTime();
+
+            if (timeStep > 0.0f)
+            {
+                // fell asleep earlier this frame, let the scalar path do the wake check
+                if (sc->m_sleeping)
+                {
+                    sc->UpdateMotion(timeStep);
+                    timeStep = 0.0f;
+                }
+                else
+                {
+                    // parent is simulated and has moved since the previous step
+                    if (a_refreshTarget)
+                        SetTarget(b, i, sc);
+
+                    b.stepMask |= 1U << i;
+                }
+            }
+
+            b.dt[i] = timeStep;
+
+            b.ox[i] = sc->m_oldWorldPos.x();
+            b.oy[i] = sc->m_oldWorldPos.y();
+            b.oz[i] = sc->m_oldWorldPos.z();
+
+            b.vx[i] = sc->m_velocity.x();
+            b.vy[i] = sc->m_velocity.y();
+            b.vz[i] = sc->m_velocity.z();
+
+            b.lx[i] = sc->m_virtld.x();
+            b.ly[i] = sc->m_virtld.y();
+            b.lz[i] = sc->m_virtld.z();
+
+            btVector3 impulse;
+
+            if (timeStep > 0.0f && IImpulseBuffer::Consume(sc->m_impulseSlot, impulse))
+            {
+                auto force(((sc->GetParentWorldData().m_rotation * impulse) *=
+                    sc->m_dp.mass) /= timeStep);
+
+                b.ex[i] = force.x();
+                b.ey[i] = force.y();
+                b.ez[i] = force.z();
+            }
+            else
+            {
+                b.ex[i] = 0.0f;
+                b.ey[i] = 0.0f;
+                b.ez[i] = 0.0f;
+            }
+        }
+    }
+
+    void MotionBatch::Integrate(block_t& a_block, btScalar a_maxDiff)
+    {
+        auto& b = a_block;
+
+        auto dt = vload(b.dt);
+        auto zero = vzero();
+        auto one = vset1(1.0f);
+
+        auto tx = vload(b.tx);
+        auto ty = vload(b.ty);
+        auto tz = vload(b.tz);
+
+        auto ox = vload(b.ox);
+        auto oy = vload(b.oy);
+        auto oz = vload(b.oz);
+
+        auto dx = vsub(tx, ox);
+        auto dy = vsub(ty, oy);
+        auto dz = vsub(tz, oz);
+
+        auto adx = vabs(dx);
+        auto ady = vabs(dy);
+        auto adz = vabs(dz);
+
+        auto md = vset1(a_maxDiff);
+
+        b.resetMask = vmovemask(vor(vor(vcmpgt(adx, md), vcmpgt(ady, md)), vcmpgt(adz, md)));
+
+        auto k = vload(b.stiffness);
+        auto k2 = vload(b.stiffness2);
+
+        auto fx = vadd(vmul(dx, k), vmul(vmul(dx, adx), k2));
+        auto fy = vadd(vmul(dy, k), vmul(vmul(dy, ady), k2));
+        auto fz = vadd(vmul(dz, k), vmul(vmul(dz, adz), k2));
+
+        auto lx = vload(b.lx);
+        auto ly = vload(b.ly);
+        auto lz = vload(b.lz);
+
+        auto sm = vmin(vmax(vmul(vsub(vsqrt(vdot(lx, ly, lz, lx, ly, lz)), vload(b.slackOffset)), vload(b.slackInvRange)), zero), one);
+        sm = vsel(vcmpgt(vload(b.slack), zero), vmul(sm, sm), one);
+
+        fx = vadd(vmul(fx, sm), vload(b.ex));
+        fy = vadd(vmul(fy, sm), vload(b.ey));
+        fz = vadd(vsub(vmul(fz, sm), vload(b.gravForce)), vload(b.ez));
+
+        auto vx = vload(b.vx);
+        auto vy = vload(b.vy);
+        auto vz = vload(b.vz);
+
+        auto speed = vsqrt(vdot(vx, vy, vz, vx, vy, vz));
+        auto res = vadd(vmul(vsub(one, vdiv(one, vadd(vmul(speed, vset1(0.0075f)), one))), vload(b.resistance)), one);
+        auto damp = vmul(vmul(vload(b.damping), res), dt);
+
+        auto idt = vmul(vload(b.invMass), dt);
+
+        vx = vadd(vsub(vx, vmul(vx, damp)), vmul(fx, idt));
+        vy = vadd(vsub(vy, vmul(vy, damp)), vmul(fy, idt));
+        vz = vadd(vsub(vz, vmul(vz, damp)), vmul(fz, idt));
+
+        auto len2 = vdot(vx, vy, vz, vx, vy, vz);
+        auto clamp = vcmpge(len2, vload(b.maxVelocity2));
+        auto scale = vdiv(vload(b.maxVelocity), vsqrt(len2));
+
+        vx = vsel(clamp, vmul(vx, scale), vx);
+        vy = vsel(clamp, vmul(vy, scale), vy);
+        vz = vsel(clamp, vmul(vz, scale), vz);
+
+        vstore(b.vx, vx);
+        vstore(b.vy, vy);
+        vstore(b.vz, vz);
+
+        auto px = vsub(vadd(ox, vmul(vx, dt)), tx);
+        auto py = vsub(vadd(oy, vmul(vy, dt)), ty);
+        auto pz = vsub(vadd(oz, vmul(vz, dt)), tz);
+
+        // transposed parent rotation
+        vstore(b.lx, vdot(vload(b.rot[0]), vload(b.rot[3]), vload(b.rot[6]), px, py, pz));
+        vstore(b.ly, vdot(vload(b.rot[1]), vload(b.rot[4]), vload(b.rot[7]), px, py, pz));
+        vstore(b.lz, vdot(vload(b.rot[2]), vload(b.rot[5]), vload(b.rot[8]), px, py, pz));
+    }
+
+    void MotionBatch::Constrain(block_t& a_block)
+    {
+        auto& b = a_block;
+
+        Constraints::batch_t batch;
+
+        for (std::size_t i = 0; i < 9; i++)
+            batch.rot[i] = b.rot[i];
+
+        batch.tx = b.tx;
+        batch.ty = b.ty;
+        batch.tz = b.tz;
+        batch.ox = b.ox;
+        batch.oy = b.oy;
+        batch.oz = b.oz;
+        batch.dt = b.dt;
+        batch.vx = b.vx;
+        batch.vy = b.vy;
+        batch.vz = b.vz;
+        batch.lx = b.lx;
+        batch.ly = b.ly;
+        batch.lz = b.lz;
+        batch.violation = b.violation;
+
+        batch.sphere = b.sphere;
+        batch.sphereRadius = b.sphereRadius;
+        batch.box = b.box;
+
+        for (std::size_t i = 0; i < 3; i++)
+        {
+            batch.sphereOffset[i] = b.sphereOffset[i];
+            batch.boxMin[i] = b.boxMin[i];
+            batch.boxMax[i] = b.boxMax[i];
+        }
+
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            batch.sphereParams[i] = b.sphereParams[i];
+            batch.boxParams[i] = b.boxParams[i];
+        }
+
+        Constraints::Solve(batch, NUM_LANES);
+    }
+
+    void MotionBatch::Scatter(block_t& a_block)
+    {
+        auto& b = a_block;
+
+        b.doneMask = 0;
+        b.rotMask = 0;
+
+        for (std::uint32_t i = 0; i < b.count; i++)
+        {
+            if (!(b.stepMask & (1U << i)))
+                continue;
+
+            auto sc = b.sc[i];
+
+            if (b.resetMask & (1U << i))
+            {
+                sc->Reset();
+                continue;
+            }
+
+            sc->m_velocity.setValue(b.vx[i], b.vy[i], b.vz[i]);
+            sc->m_virtld.setValue(b.lx[i], b.ly[i], b.lz[i]);
+
+            if (!sc->UpdateMotionBatched(btVector3(b.tx[i], b.ty[i], b.tz[i]), b.violation[i]))
+                continue;
+
+            b.doneMask |= 1U << i;
+
+            if (sc->m_rotScaleOn)
+            {
+                auto axis = sc->GetRotationAxis();
+
+                b.rx[i] = axis.x();
+                b.ry[i] = axis.y();
+                b.rz[i] = axis.z();
+
+                b.rotMask |= 1U << i;
+            }
+            else
+            {
+                b.rx[i] = 0.0f;
+                b.ry[i] = 0.0f;
+                b.rz[i] = 0.0f;
+            }
+        }
+
+        if (b.rotMask)
+        {
+            Rotation::AxisAngleToQuat(
+                b.rx, b.ry, b.rz, b.ra,
+                b.qx, b.qy, b.qz, b.qw,
+                NUM_LANES);
+        }
+
+        for (std::uint32_t i = 0; i < b.count; i++)
+        {
+            if (!(b.doneMask & (1U << i)))
+                continue;
+
+            auto sc = b.sc[i];
+
+            if (b.rotMask & (1U << i))
+            {
+                sc->m_rotParams.m_axis.setValue(b.rx[i], b.ry[i], b.rz[i]);
+                sc->m_rotParams.m_angle = b.ra[i];
+
+                sc->ApplyRotation(sc->GetParentWorldData(), btQuaternion(b.qx[i], b.qy[i], b.qz[i], b.qw[i]));
+            }
+
+            sc->FinishMotionBatched(b.dt[i], btVector3(b.tx[i], b.ty[i], b.tz[i]));
+        }
+    }
+
+    void MotionBatch::Update(bool a_parallel)
+    {
+        btScalar maxDiff(IConfig::GetGlobal().phys.maxDiff);
+
+        // a level reads the world transforms written by the previous one, nothing within a level depends on each other
+        for (std::size_t l = 0; l < m_numLevels; l++)
+        {
+            auto& level = m_levels[l];
+
+            bool refreshTarget = l > 0;
+
+            auto blocks = m_blocks.data() + level.firstBlock;
+
+            auto func = [&](std::uint32_t a_begin, std::uint32_t a_end)
+            {
+                for (auto i = a_begin; i < a_end; i++)
+                {
+                    auto& b = blocks[i];
+
+                    Gather(b, refreshTarget);
+
+                    if (!b.stepMask)
+                        continue;
+
+                    Integrate(b, maxDiff);
+
+                    if (b.constrained)
+                        Constrain(b);
+
+                    Scatter(b);
+                }
+            };
+
+            auto scalar = level.scalar.data();
+
+            auto funcScalar = [&](std::uint32_t a_begin, std::uint32_t a_end)
+            {
+                for (auto i = a_begin; i < a_end; i++)
+                {
+                    auto e = scalar[i];
+
+                    auto timeStep = e->m_parent.GetStepTime();
+                    if (timeStep > 0.0f)
+                        e->UpdateMotion(timeStep);
+                }
+            };
+
+            auto numScalar = static_cast<std::uint32_t>(level.scalar.size());
+
+            if (a_parallel)
+            {
+                IThreadPool::ParallelFor(static_cast<std::uint32_t>(level.numBlocks), 1, func);
+                IThreadPool::ParallelFor(numScalar, NUM_LANES, funcScalar);
+            }
+            else
+            {
+                func(0, static_cast<std::uint32_t>(level.numBlocks));
+                funcScalar(0, numScalar);
+            }
+        }
+    }
+
+}
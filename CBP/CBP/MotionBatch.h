@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Data.h"
+
+namespace CBP
+{
+    class SimComponent;
+
+    class MotionBatch
+    {
+    public:
+
+#if defined(__AVX2__)
+        static constexpr std::size_t NUM_LANES = 8;
+#else
+        static constexpr std::size_t NUM_LANES = 4;
+#endif
+
+    private:
+
+        struct SKMP_ALIGN(32) block_t
+        {
+            // per-tick constants
+            float tx[NUM_LANES];
+            float ty[NUM_LANES];
+            float tz[NUM_LANES];
+            float rot[9][NUM_LANES];
+
+            float stiffness[NUM_LANES];
+            float stiffness2[NUM_LANES];
+            float slackOffset[NUM_LANES];
+            float slackInvRange[NUM_LANES];
+            float slack[NUM_LANES];
+            float gravForce[NUM_LANES];
+            float invMass[NUM_LANES];
+            float damping[NUM_LANES];
+            float resistance[NUM_LANES];
+            float maxVelocity[NUM_LANES];
+            float maxVelocity2[NUM_LANES];
+
+            // per-step state
+            float ox[NUM_LANES];
+            float oy[NUM_LANES];
+            float oz[NUM_LANES];
+            float vx[NUM_LANES];
+            float vy[NUM_LANES];
+            float vz[NUM_LANES];
+            float lx[NUM_LANES];
+            float ly[NUM_LANES];
+            float lz[NUM_LANES];
+            float ex[NUM_LANES];
+            float ey[NUM_LANES];
+            float ez[NUM_LANES];
+            float dt[NUM_LANES];
+
+            // rotation axis / angle and quaternion, see Rotation::AxisAngleToQuat
+            float rx[NUM_LANES];
+            float ry[NUM_LANES];
+            float rz[NUM_LANES];
+            float ra[NUM_LANES];
+            float qx[NUM_LANES];
+            float qy[NUM_LANES];
+            float qz[NUM_LANES];
+            float qw[NUM_LANES];
+
+            // motion constraints, see Constraints::Solve
+            float sphere[NUM_LANES];
+            float sphereOffset[3][NUM_LANES];
+            float sphereRadius[NUM_LANES];
+            float sphereParams[4][NUM_LANES];
+            float box[NUM_LANES];
+            float boxMin[3][NUM_LANES];
+            float boxMax[3][NUM_LANES];
+            float boxParams[4][NUM_LANES];
+            float violation[NUM_LANES];
+
+            SimComponent* sc[NUM_LANES];
+            std::uint32_t count;
+            std::uint32_t resetMask;
+            std::uint32_t stepMask;
+            std::uint32_t doneMask;
+            std::uint32_t rotMask;
+            bool constrained;
+        };
+
+        // components with the same number of simulated ancestors, blocks are a contiguous range of m_blocks
+        struct level_t
+        {
+            std::size_t firstBlock;
+            std::size_t numBlocks;
+
+            std::vector<SimComponent*> batched;
+            std::vector<SimComponent*> scalar;
+        };
+
+    public:
+
+        MotionBatch() = default;
+
+        MotionBatch(const MotionBatch&) = delete;
+        MotionBatch(MotionBatch&&) = delete;
+        MotionBatch& operator=(const MotionBatch&) = delete;
+        MotionBatch& operator=(MotionBatch&&) = delete;
+
+        // a_scalarOnly keeps the level order but runs everything through SimComponent::UpdateMotion
+        void Build(const simActorList_t& a_actors, bool a_scalarOnly = false);
+        void Update(bool a_parallel);
+        void Clear();
+
+        [[nodiscard]] SKMP_FORCEINLINE std::size_t GetNumComponents() const {
+            return m_numBatched + m_numScalar;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::size_t GetNumBatched() const {
+            return m_numBatched;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::size_t GetNumLevels() const {
+            return m_numLevels;
+        }
+
+    private:
+
+        SKMP_FORCEINLINE void Add(level_t& a_level, SimComponent* a_sc);
+        SKMP_FORCEINLINE static void SetTarget(block_t& a_block, std::uint32_t a_index, SimComponent* a_sc);
+        SKMP_FORCEINLINE void Gather(block_t& a_block, bool a_refreshTarget);
+        SKMP_FORCEINLINE void Integrate(block_t& a_block, btScalar a_maxDiff);
+        SKMP_FORCEINLINE void Constrain(block_t& a_block);
+        SKMP_FORCEINLINE void Scatter(block_t& a_block);
+
+        std::vector<block_t> m_blocks;
+        std::vector<level_t> m_levels;
+
+        std::size_t m_numBlocks{ 0 };
+        std::size_t m_numLevels{ 0 };
+        std::size_t m_numBatched{ 0 };
+        std::size_t m_numScalar{ 0 };
+    };
+}
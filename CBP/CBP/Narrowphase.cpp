@@ -0,0 +1,285 @@
+#include "pch.h"
+
+#include "Narrowphase.h"
+#include "Benchmark.h"
+
+namespace CBP
+{
+    namespace Narrowphase
+    {
+        void GetShape(const btCollisionObject* a_object, shape_t& a_out)
+        {
+            auto& transform = a_object->getWorldTransform();
+            auto shape = a_object->getCollisionShape();
+
+            if (shape->getShapeType() == CAPSULE_SHAPE_PROXYTYPE)
+            {
+                auto capsule = static_cast<const btCapsuleShape*>(shape);
+
+                auto axis(transform.getBasis().getColumn(capsule->getUpAxis()) * capsule->getHalfHeight());
+
+                a_out.p0 = transform.getOrigin() - axis;
+                a_out.p1 = transform.getOrigin() + axis;
+                a_out.radius = capsule->getRadius();
+                a_out.segment = true;
+            }
+            else
+            {
+                a_out.p0 = transform.getOrigin();
+                a_out.p1 = transform.getOrigin();
+                a_out.radius = static_cast<const btSphereShape*>(shape)->getRadius();
+                a_out.segment = false;
+            }
+        }
+
+        // Ericson, Real-Time Collision Detection 5.1.9
+        SKMP_FORCEINLINE static void ClosestPtSegmentSegment(
+            const btVector3& a_p1,
+            const btVector3& a_q1,
+            const btVector3& a_p2,
+            const btVector3& a_q2,
+            btVector3& a_c1,
+            btVector3& a_c2)
+        {
+            auto d1(a_q1 - a_p1);
+            auto d2(a_q2 - a_p2);
+            auto r(a_p1 - a_p2);
+
+            auto a = d1.length2();
+            auto e = d2.length2();
+            auto f = d2.dot(r);
+
+            btScalar s, t;
+
+            if (a <= _EPSILON && e <= _EPSILON)
+            {
+                s = t = 0.0f;
+            }
+            else if (a <= _EPSILON)
+            {
+                s = 0.0f;
+                t = std::clamp(f / e, 0.0f, 1.0f);
+            }
+            else
+            {
+                auto c = d1.dot(r);
+
+                if (e <= _EPSILON)
+                {
+                    t = 0.0f;
+                    s = std::clamp(-c / a, 0.0f, 1.0f);
+                }
+                else
+                {
+                    auto b = d1.dot(d2);
+                    auto denom = a * e - b * b;
+
+                    // parallel segments pick s = 0
+                    s = denom != 0.0f ? std::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+                    t = (b * s + f) / e;
+
+                    if (t < 0.0f)
+                    {
+                        t = 0.0f;
+                        s = std::clamp(-c / a, 0.0f, 1.0f);
+                    }
+                    else if (t > 1.0f)
+                    {
+                        t = 1.0f;
+                        s = std::clamp((b - c) / a, 0.0f, 1.0f);
+                    }
+                }
+            }
+
+            a_c1 = a_p1 + d1 * s;
+            a_c2 = a_p2 + d2 * t;
+        }
+
+        bool Collide(
+            const shape_t& a_a,
+            const shape_t& a_b,
+            btVector3& a_normalOnB,
+            btScalar& a_depth)
+        {
+            btVector3 ca, cb;
+
+            if (a_a.segment || a_b.segment)
+            {
+                ClosestPtSegmentSegment(a_a.p0, a_a.p1, a_b.p0, a_b.p1, ca, cb);
+            }
+            else
+            {
+                ca = a_a.p0;
+                cb = a_b.p0;
+            }
+
+            auto diff(ca - cb);
+            auto r = a_a.radius + a_b.radius;
+            auto l2 = diff.length2();
+
+            if (l2 >= r * r)
+                return false;
+
+            auto len = std::sqrtf(l2);
+
+            if (len > _EPSILON)
+                a_normalOnB = diff / len;
+            else
+                // same as btSphereSphereCollisionAlgorithm
+                a_normalOnB.setValue(1.0f, 0.0f, 0.0f);
+
+            a_depth = r - len;
+
+            return true;
+        }
+
+        struct deepestContactCallback_t :
+            public btCollisionWorld::ContactResultCallback
+        {
+            deepestContactCallback_t(const btCollisionObject* a_objA) :
+                m_objA(a_objA),
+                m_distance(std::numeric_limits<btScalar>::max())
+            {
+            }
+
+            virtual btScalar addSingleResult(
+                btManifoldPoint& a_cp,
+                const btCollisionObjectWrapper* a_colObj0Wrap,
+                int,
+                int,
+                const btCollisionObjectWrapper*,
+                int,
+                int) override
+            {
+                if (a_cp.getDistance() < m_distance)
+                {
+                    m_distance = a_cp.getDistance();
+                    m_normalOnB = a_colObj0Wrap->getCollisionObject() == m_objA ?
+                        a_cp.m_normalWorldOnB : -a_cp.m_normalWorldOnB;
+                }
+
+                return 0.0f;
+            }
+
+            const btCollisionObject* m_objA;
+            btScalar m_distance;
+            btVector3 m_normalOnB;
+        };
+
+        void RunSelfTest(std::uint32_t a_count, selfTestResult_t& a_out)
+        {
+            // contacts shallower than this may legitimately differ between GJK and the closed form
+            constexpr btScalar AMBIGUOUS_DEPTH = 0.05f;
+
+            BenchmarkRandom rnd(0x2545F491);
+
+            auto count = std::max(a_count, 1U);
+
+            std::vector<std::unique_ptr<btCollisionShape>> shapes;
+            std::vector<std::unique_ptr<btCollisionObject>> objects;
+
+            shapes.reserve(std::size_t(count) * 2);
+            objects.reserve(std::size_t(count) * 2);
+
+            for (std::uint32_t i = 0; i < count * 2; i++)
+            {
+                auto radius = 2.0f + rnd.Unit() * 8.0f;
+
+                if (rnd.Unit() < 0.5f)
+                    shapes.emplace_back(std::make_unique<btSphereShape>(radius));
+                else
+                    shapes.emplace_back(std::make_unique<btCapsuleShape>(radius, 4.0f + rnd.Unit() * 20.0f));
+
+                btVector3 axis(rnd.Unit() - 0.5f, rnd.Unit() - 0.5f, rnd.Unit() - 0.5f);
+                if (axis.length2() < 0.01f)
+                    axis.setValue(0.0f, 0.0f, 1.0f);
+
+                btTransform transform(
+                    btQuaternion(axis.normalized(), rnd.Unit() * std::numbers::pi_v<float> * 2.0f),
+                    btVector3(rnd.Unit() * 30.0f, rnd.Unit() * 30.0f, rnd.Unit() * 30.0f));
+
+                auto& object = objects.emplace_back(std::make_unique<btCollisionObject>());
+
+                object->setCollisionShape(shapes.back().get());
+                object->setWorldTransform(transform);
+            }
+
+            btDefaultCollisionConfiguration configuration;
+            btCollisionDispatcher dispatcher(std::addressof(configuration));
+            btDbvtBroadphase broadphase;
+            btCollisionWorld world(
+                std::addressof(dispatcher),
+                std::addressof(broadphase),
+                std::addressof(configuration));
+
+            a_out = selfTestResult_t{ count, 0, 0, 0, 0.0f, 0.0f, 0, 0 };
+
+            stl::vector_simd<contact_t> native(count);
+            std::vector<std::uint8_t> hits(count);
+
+            auto start = IPerfCounter::Query();
+
+            for (std::uint32_t i = 0; i < count; i++)
+            {
+                shape_t sa, sb;
+
+                GetShape(objects[i * 2].get(), sa);
+                GetShape(objects[i * 2 + 1].get(), sb);
+
+                hits[i] = Collide(sa, sb, native[i].normalOnB, native[i].depth) ? 1 : 0;
+            }
+
+            auto t1 = IPerfCounter::Query();
+
+            std::vector<deepestContactCallback_t> results;
+            results.reserve(count);
+
+            for (std::uint32_t i = 0; i < count; i++)
+            {
+                auto& result = results.emplace_back(objects[i * 2].get());
+                world.contactPairTest(objects[i * 2].get(), objects[i * 2 + 1].get(), result);
+            }
+
+            auto t2 = IPerfCounter::Query();
+
+            a_out.nativeTime = IPerfCounter::delta_us(start, t1);
+            a_out.bulletTime = IPerfCounter::delta_us(t1, t2);
+
+            for (std::uint32_t i = 0; i < count; i++)
+            {
+                auto& result = results[i];
+
+                bool hit = hits[i] != 0;
+                bool bulletHit = result.m_distance < 0.0f;
+
+                if (hit)
+                    a_out.numContacts++;
+
+                if (bulletHit)
+                    a_out.numBulletContacts++;
+
+                if (hit != bulletHit)
+                {
+                    auto depth = hit ? native[i].depth : -result.m_distance;
+
+                    if (depth > AMBIGUOUS_DEPTH)
+                        a_out.numMismatches++;
+
+                    continue;
+                }
+
+                if (!hit)
+                    continue;
+
+                a_out.maxDepthError = std::max(a_out.maxDepthError,
+                    std::fabs(native[i].depth + result.m_distance));
+
+                if (native[i].depth > AMBIGUOUS_DEPTH)
+                {
+                    a_out.maxNormalError = std::max(a_out.maxNormalError,
+                        1.0f - native[i].normalOnB.dot(result.m_normalOnB));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+namespace CBP
+{
+    class SimComponent;
+
+    namespace Narrowphase
+    {
+        // normal points from b to a, same as btManifoldPoint::m_normalWorldOnB
+        struct SKMP_ALIGN(16) contact_t
+        {
+            btVector3 normalOnB;
+            btScalar depth;
+            SimComponent* a;
+            SimComponent* b;
+        };
+
+        // spheres are capsules with a zero length segment
+        struct SKMP_ALIGN(16) shape_t
+        {
+            btVector3 p0;
+            btVector3 p1;
+            btScalar radius;
+            bool segment;
+        };
+
+        [[nodiscard]] SKMP_FORCEINLINE bool IsSupported(const btCollisionShape* a_shape)
+        {
+            auto type = a_shape->getShapeType();
+            return type == SPHERE_SHAPE_PROXYTYPE || type == CAPSULE_SHAPE_PROXYTYPE;
+        }
+
+        // a_object must have a supported shape
+        void GetShape(const btCollisionObject* a_object, shape_t& a_out);
+
+        // true when the shapes penetrate, a_depth > 0
+        [[nodiscard]] bool Collide(
+            const shape_t& a_a,
+            const shape_t& a_b,
+            btVector3& a_normalOnB,
+            btScalar& a_depth);
+
+        struct selfTestResult_t
+        {
+            std::uint32_t numPairs;
+            std::uint32_t numContacts;
+            std::uint32_t numBulletContacts;
+            std::uint32_t numMismatches;
+
+            float maxDepthError;
+            float maxNormalError;
+
+            long long nativeTime;
+            long long bulletTime;
+        };
+
+        // random sphere and capsule pairs against Bullet's own algorithms in a private collision world
+        void RunSelfTest(std::uint32_t a_count, selfTestResult_t& a_out);
+    }
+}
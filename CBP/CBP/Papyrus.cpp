@@ -61,6 +61,78 @@ namespace CBP
         DCBP::OpenUI(a_open);
     }
 
+    static bool GetForceHandle(Actor* a_actor, Game::VMHandle& a_out)
+    {
+        if (!a_actor)
+        {
+            a_out = Game::VMHandle(0);
+            return true;
+        }
+
+        return a_out.Get(a_actor);
+    }
+
+    static void PP_ApplyForce(StaticFunctionTag*, Actor* actor, BSFixedString component, float x, float y, float z, SInt32 steps)
+    {
+        if (steps <= 0)
+            return;
+
+        Game::VMHandle handle;
+        if (!GetForceHandle(actor, handle))
+            return;
+
+        DCBP::ApplyForce(handle, static_cast<std::uint32_t>(steps), stl::fixed_string(component.c_str()), btVector3(x, y, z));
+    }
+
+    // one task for the whole batch, forces holds 3 floats per entry
+    static void PP_ApplyForces(
+        StaticFunctionTag*,
+        VMArray<Actor*> actors,
+        VMArray<BSFixedString> components,
+        VMArray<float> forces,
+        VMArray<SInt32> steps)
+    {
+        auto count = actors.Length();
+
+        if (components.Length() != count ||
+            steps.Length() != count ||
+            forces.Length() != count * 3)
+        {
+            return;
+        }
+
+        std::vector<impulseRequest_t> requests;
+        requests.reserve(count);
+
+        for (UInt32 i = 0; i < count; i++)
+        {
+            Actor* actor;
+            BSFixedString component;
+            SInt32 numSteps;
+            float f[3];
+
+            actors.Get(&actor, i);
+            components.Get(&component, i);
+            steps.Get(&numSteps, i);
+
+            for (UInt32 j = 0; j < 3; j++)
+                forces.Get(&f[j], i * 3 + j);
+
+            Game::VMHandle handle;
+
+            if (numSteps <= 0 || !GetForceHandle(actor, handle))
+                continue;
+
+            requests.emplace_back(impulseRequest_t{
+                handle,
+                static_cast<std::uint32_t>(numSteps),
+                stl::fixed_string(component.c_str()),
+                btVector3(f[0], f[1], f[2]) });
+        }
+
+        DCBP::ApplyForces(std::move(requests));
+    }
+
     bool RegisterFuncs(VMClassRegistry* registry)
     {
         registry->RegisterFunction(
@@ -75,11 +147,17 @@ namespace CBP
             new NativeFunction5<StaticFunctionTag, bool, Actor*, BSFixedString, BSFixedString, bool, float>("SetActorConfig", "CBP", PP_SetActorConfig, registry));
         registry->RegisterFunction(
             new NativeFunction1<StaticFunctionTag, void, bool>("OpenUI", "CBP", PP_OpenUI, registry));
+        registry->RegisterFunction(
+            new NativeFunction6<StaticFunctionTag, void, Actor*, BSFixedString, float, float, float, SInt32>("ApplyForce", "CBP", PP_ApplyForce, registry));
+        registry->RegisterFunction(
+            new NativeFunction4<StaticFunctionTag, void, VMArray<Actor*>, VMArray<BSFixedString>, VMArray<float>, VMArray<SInt32>>("ApplyForces", "CBP", PP_ApplyForces, registry));
 
 
         registry->SetFunctionFlags("CBP", "OpenUI", VMClassRegistry::kFunctionFlag_NoWait);
         registry->SetFunctionFlags("CBP", "ResetAllActors", VMClassRegistry::kFunctionFlag_NoWait);
         registry->SetFunctionFlags("CBP", "UpdateAllActors", VMClassRegistry::kFunctionFlag_NoWait);
+        registry->SetFunctionFlags("CBP", "ApplyForce", VMClassRegistry::kFunctionFlag_NoWait);
+        registry->SetFunctionFlags("CBP", "ApplyForces", VMClassRegistry::kFunctionFlag_NoWait);
 
         return true;
     }
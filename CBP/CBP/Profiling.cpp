@@ -38,11 +38,40 @@ namespace CBP
                     m_current.avgStepRate = 0;
 
                 m_current.avgFrameTime = m_frameTimeAccum / static_cast<double>(m_runCount);
+                m_current.avgMotionTime = m_motionTimeAccum / static_cast<long long>(m_runCount);
+
+                if (m_numComponentStepsAccum)
+                    m_current.avgComponentStepTime = static_cast<double>(m_motionTimeAccum * 1000LL) / static_cast<double>(m_numComponentStepsAccum);
+                else
+                    m_current.avgComponentStepTime = 0.0;
+
+                m_current.avgSleeping = static_cast<std::uint32_t>(m_numSleepingAccum / m_runCount);
+                m_current.avgSleepsPerFrame = static_cast<double>(m_numSleepsAccum) / static_cast<double>(m_runCount);
+                m_current.avgWakesPerFrame = static_cast<double>(m_numWakesAccum) / static_cast<double>(m_runCount);
+                m_current.avgManifolds = static_cast<double>(m_numManifoldsAccum) / static_cast<double>(m_runCount);
+
+                for (std::uint32_t i = 0; i < NUM_BROADPHASES; i++)
+                {
+                    if (m_numBroadphaseStepsAccum[i])
+                    {
+                        m_current.avgBroadphaseTime[i] = static_cast<double>(m_broadphaseTimeAccum[i]) /
+                            static_cast<double>(m_numBroadphaseStepsAccum[i]);
+                    }
+
+                    m_broadphaseTimeAccum[i] = 0;
+                    m_numBroadphaseStepsAccum[i] = 0;
+                }
 
                 m_runCount = 0;
                 m_numActorsAccum = 0;
                 m_numStepsAccum = 0;
                 m_frameTimeAccum = 0.0;
+                m_motionTimeAccum = 0;
+                m_numComponentStepsAccum = 0;
+                m_numSleepingAccum = 0;
+                m_numSleepsAccum = 0;
+                m_numWakesAccum = 0;
+                m_numManifoldsAccum = 0;
 
                 m_uid++;
             }
@@ -63,6 +92,12 @@ namespace CBP
         m_numActorsAccum = 0;
         m_numStepsAccum = 0;
         m_frameTimeAccum = 0.0;
+        m_motionTimeAccum = 0;
+        m_numComponentStepsAccum = 0;
+        m_numSleepingAccum = 0;
+        m_numSleepsAccum = 0;
+        m_numWakesAccum = 0;
+        m_numManifoldsAccum = 0;
         m_uid = 0;
         m_current.avgActorCount = 0;
         m_current.avgTime = 0;
@@ -70,5 +105,18 @@ namespace CBP
         m_current.avgStepsPerUpdate = 0.0;
         m_current.avgTime = 0.0;
         m_current.avgFrameTime = 0.0;
+        m_current.avgMotionTime = 0;
+        m_current.avgComponentStepTime = 0.0;
+        m_current.avgSleeping = 0;
+        m_current.avgSleepsPerFrame = 0.0;
+        m_current.avgWakesPerFrame = 0.0;
+        m_current.avgManifolds = 0.0;
+
+        for (std::uint32_t i = 0; i < NUM_BROADPHASES; i++)
+        {
+            m_broadphaseTimeAccum[i] = 0;
+            m_numBroadphaseStepsAccum[i] = 0;
+            m_current.avgBroadphaseTime[i] = -1.0;
+        }
     }
 }
\ No newline at end of file
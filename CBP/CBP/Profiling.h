@@ -4,6 +4,13 @@ namespace CBP
 {
     class Profiler
     {
+    public:
+
+        // DBVT, sweep and prune, spatial hash
+        static constexpr std::uint32_t NUM_BROADPHASES = 3;
+
+    private:
+
         struct Stats
         {
             long long avgTime;
@@ -11,6 +18,15 @@ namespace CBP
             double avgStepRate;
             double avgStepsPerUpdate;
             double avgFrameTime;
+            long long avgMotionTime;
+            double avgComponentStepTime;
+            std::uint32_t avgSleeping;
+            double avgSleepsPerFrame;
+            double avgWakesPerFrame;
+            double avgManifolds;
+
+            // microseconds per step, last interval each one was in use. < 0 if never measured
+            double avgBroadphaseTime[NUM_BROADPHASES];
         };
 
     public:
@@ -19,6 +35,30 @@ namespace CBP
         void Begin();
         void End(std::uint32_t a_actors, std::uint32_t a_steps, float a_time);
 
+        SKMP_FORCEINLINE void AddMotionTime(long long a_time, std::uint32_t a_componentSteps)
+        {
+            m_motionTimeAccum += a_time;
+            m_numComponentStepsAccum += a_componentSteps;
+        }
+
+        SKMP_FORCEINLINE void AddSleepStats(std::uint32_t a_sleeping, std::uint32_t a_sleeps, std::uint32_t a_wakes)
+        {
+            m_numSleepingAccum += a_sleeping;
+            m_numSleepsAccum += a_sleeps;
+            m_numWakesAccum += a_wakes;
+        }
+
+        SKMP_FORCEINLINE void AddBroadphaseTime(std::uint32_t a_index, long long a_time, std::uint32_t a_steps)
+        {
+            m_broadphaseTimeAccum[a_index] += a_time;
+            m_numBroadphaseStepsAccum[a_index] += a_steps;
+        }
+
+        SKMP_FORCEINLINE void AddManifoldCount(std::uint32_t a_count)
+        {
+            m_numManifoldsAccum += a_count;
+        }
+
         void SetInterval(long long a_interval);
         void Reset();
 
@@ -38,6 +78,14 @@ namespace CBP
         std::uint32_t m_numActorsAccum;
         std::uint32_t m_numStepsAccum;
         double m_frameTimeAccum;
+        long long m_motionTimeAccum;
+        std::uint64_t m_numComponentStepsAccum;
+        std::uint64_t m_numSleepingAccum;
+        std::uint64_t m_numSleepsAccum;
+        std::uint64_t m_numWakesAccum;
+        std::uint64_t m_numManifoldsAccum;
+        long long m_broadphaseTimeAccum[NUM_BROADPHASES];
+        std::uint64_t m_numBroadphaseStepsAccum[NUM_BROADPHASES];
         std::uint32_t m_runCount;
 
         std::uint32_t m_uid;
@@ -0,0 +1,186 @@
+#include "pch.h"
+
+#include "Rotation.h"
+#include "Benchmark.h"
+
+namespace CBP
+{
+    namespace Rotation
+    {
+        void AxisAngleToQuat(
+            float* a_x,
+            float* a_y,
+            float* a_z,
+            float* a_angle,
+            float* a_qx,
+            float* a_qy,
+            float* a_qz,
+            float* a_qw,
+            std::size_t a_count)
+        {
+            auto eps2 = _mm_set_ps1(_EPSILON * _EPSILON);
+            auto one = _mm_set_ps1(1.0f);
+            auto half = _mm_set_ps1(0.5f);
+            auto toRad = _mm_set_ps1(std::numbers::pi_v<float> / 180.0f);
+
+            for (std::size_t i = 0; i < a_count; i += 4)
+            {
+                auto x = _mm_load_ps(a_x + i);
+                auto y = _mm_load_ps(a_y + i);
+                auto z = _mm_load_ps(a_z + i);
+
+                auto l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+                auto valid = _mm_cmpge_ps(l2, eps2);
+
+                auto l = _mm_sqrt_ps(l2);
+                auto inv = _mm_and_ps(valid, _mm_div_ps(one, l));
+
+                // degenerate lanes get rotationParams_t::Zero() (1, 0, 0), 0
+                x = _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(x, inv)), _mm_andnot_ps(valid, one));
+                y = _mm_mul_ps(y, inv);
+                z = _mm_mul_ps(z, inv);
+
+                auto angle = _mm_and_ps(valid, _mm_mul_ps(l, toRad));
+
+                DirectX::XMVECTOR s, c;
+                DirectX::XMVectorSinCos(&s, &c, _mm_mul_ps(angle, half));
+
+                _mm_store_ps(a_x + i, x);
+                _mm_store_ps(a_y + i, y);
+                _mm_store_ps(a_z + i, z);
+                _mm_store_ps(a_angle + i, angle);
+
+                _mm_store_ps(a_qx + i, _mm_mul_ps(x, s));
+                _mm_store_ps(a_qy + i, _mm_mul_ps(y, s));
+                _mm_store_ps(a_qz + i, _mm_mul_ps(z, s));
+                _mm_store_ps(a_qw + i, c);
+            }
+        }
+
+        SKMP_FORCEINLINE static void NormalizeAxis(btVector3& a_axis, btScalar& a_angle)
+        {
+            auto l2 = a_axis.length2();
+
+            if (l2 >= _EPSILON * _EPSILON)
+            {
+                auto l = std::sqrtf(l2);
+                a_axis /= l;
+                a_angle = l * std::numbers::pi_v<btScalar> / 180.0f;
+            }
+            else
+            {
+                a_axis.setValue(1.0f, 0.0f, 0.0f);
+                a_angle = 0.0f;
+            }
+        }
+
+        void RunBenchmark(std::uint32_t a_count, benchmarkResult_t& a_out)
+        {
+            constexpr std::size_t CHUNK = 64;
+
+            struct SKMP_ALIGN(16) lanes_t
+            {
+                float x[CHUNK];
+                float y[CHUNK];
+                float z[CHUNK];
+                float angle[CHUNK];
+                float qx[CHUNK];
+                float qy[CHUNK];
+                float qz[CHUNK];
+                float qw[CHUNK];
+            };
+
+            auto count = BenchmarkCount(a_count, CHUNK);
+
+            stl::vector_simd<btVector3> axes(count);
+
+            // deterministic input, up to ~60 degrees per axis like a strongly swinging node
+            BenchmarkRandom rnd(0x2545F491);
+
+            for (auto& e : axes)
+                e.setValue(rnd.Signed() * 35.0f, rnd.Signed() * 35.0f, rnd.Signed() * 35.0f);
+
+            btMatrix3x3 nodeRot;
+            nodeRot.setEulerZYX(0.3f, -0.2f, 0.1f);
+
+            btQuaternion nodeQuat;
+            nodeRot.getRotation(nodeQuat);
+
+            btMatrix3x3 parentRot;
+            parentRot.setEulerZYX(-0.5f, 0.7f, 0.2f);
+
+            btScalar sink(0.0f);
+
+            // matrix path (before quaternion composition)
+            auto start = IPerfCounter::Query();
+
+            for (auto& e : axes)
+            {
+                auto axis(e);
+                btScalar angle;
+
+                NormalizeAxis(axis, angle);
+
+                btMatrix3x3 ld(nodeRot * btMatrix3x3(mkQuat(axis, 1.0f, angle)));
+                auto wd(parentRot * ld);
+
+                sink += wd[0].x();
+            }
+
+            auto t1 = IPerfCounter::Query();
+
+            // scalar quaternion path
+            for (auto& e : axes)
+            {
+                auto axis(e);
+                btScalar angle;
+
+                NormalizeAxis(axis, angle);
+
+                btMatrix3x3 ld(nodeQuat * mkQuat(axis, 1.0f, angle));
+                auto wd(parentRot * ld);
+
+                sink += wd[0].x();
+            }
+
+            auto t2 = IPerfCounter::Query();
+
+            // SIMD kernel + quaternion composition
+            lanes_t lanes;
+
+            for (std::size_t i = 0; i < count; i += CHUNK)
+            {
+                for (std::size_t j = 0; j < CHUNK; j++)
+                {
+                    auto& e = axes[i + j];
+
+                    lanes.x[j] = e.x();
+                    lanes.y[j] = e.y();
+                    lanes.z[j] = e.z();
+                }
+
+                AxisAngleToQuat(
+                    lanes.x, lanes.y, lanes.z, lanes.angle,
+                    lanes.qx, lanes.qy, lanes.qz, lanes.qw,
+                    CHUNK);
+
+                for (std::size_t j = 0; j < CHUNK; j++)
+                {
+                    btMatrix3x3 ld(nodeQuat * btQuaternion(lanes.qx[j], lanes.qy[j], lanes.qz[j], lanes.qw[j]));
+                    auto wd(parentRot * ld);
+
+                    sink += wd[0].x();
+                }
+            }
+
+            auto t3 = IPerfCounter::Query();
+
+            BenchmarkSink(sink);
+
+            a_out.count = static_cast<std::uint32_t>(count);
+            a_out.matrixTime = IPerfCounter::delta_us(start, t1);
+            a_out.quatTime = IPerfCounter::delta_us(t1, t2);
+            a_out.quatSIMDTime = IPerfCounter::delta_us(t2, t3);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+namespace CBP
+{
+    namespace Rotation
+    {
+        SKMP_FORCEINLINE btQuaternion mkQuat(
+            const btVector3& a_axis,
+            btScalar a_axisLength,
+            btScalar a_angle)
+        {
+            btScalar s;
+            btScalar c;
+
+            DirectX::XMScalarSinCos(&s, &c, a_angle * 0.5f);
+
+            s /= a_axisLength;
+
+            return btQuaternion(a_axis.x() * s, a_axis.y() * s, a_axis.z() * s, c);
+        }
+
+        // in: unnormalized axis scaled by angle in degrees (SimComponent rotational params)
+        // out: unit axis (in place), angle in radians and the rotation quaternion
+        // arrays must be 16 byte aligned, a_count a multiple of 4
+        void AxisAngleToQuat(
+            float* a_x,
+            float* a_y,
+            float* a_z,
+            float* a_angle,
+            float* a_qx,
+            float* a_qy,
+            float* a_qz,
+            float* a_qw,
+            std::size_t a_count);
+
+        struct benchmarkResult_t
+        {
+            std::uint32_t count;
+
+            long long matrixTime;
+            long long quatTime;
+            long long quatSIMDTime;
+        };
+
+        // local + world rotation update as done per node step, synthetic data
+        void RunBenchmark(std::uint32_t a_count, benchmarkResult_t& a_out);
+    }
+}
@@ -546,7 +546,45 @@ namespace CBP
                 data.phys.timeTick = std::clamp(phys.get("timeTick", 1.0f / 60.0f).asFloat(), 1.0f / 300.0f, 1.0f);
                 data.phys.maxSubSteps = std::max(phys.get("maxSubSteps", 5.0f).asFloat(), 1.0f);
                 data.phys.maxDiff = std::clamp(phys.get("maxDiff", 355.0f).asFloat(), 200.0f, 2000.0f);
+                data.phys.fixedRate = phys.get("fixedRate", false).asBool();
                 data.phys.collision = phys.get("collisions", true).asBool();
+                data.phys.nativeNarrowphase = phys.get("nativeNarrowphase", true).asBool();
+                data.phys.collisionIslands = phys.get("collisionIslands", false).asBool();
+                data.phys.broadphase = static_cast<BroadphaseType>(std::clamp(phys.get("broadphase", 1U).asUInt(), 0U, 3U));
+                data.phys.broadphaseCellSize = std::clamp(phys.get("broadphaseCellSize", 0.0f).asFloat(), 0.0f, 1000.0f);
+                data.phys.poolAutoGrow = phys.get("poolAutoGrow", true).asBool();
+                data.phys.parallelResponseMin = std::clamp(phys.get("parallelResponseMin", 1024).asInt(), 0, 100000);
+                data.phys.mtDispatch = phys.get("mtDispatch", true).asBool();
+                data.phys.mtDispatchThreads = std::clamp(phys.get("mtDispatchThreads", 0).asInt(), 0, 64);
+                data.phys.mtDispatchMinPairs = std::clamp(phys.get("mtDispatchMinPairs", 256).asInt(), 0, 100000);
+                data.phys.batchedMotion = phys.get("batchedMotion", false).asBool();
+                data.phys.adaptiveSubSteps = phys.get("adaptiveSubSteps", false).asBool();
+                data.phys.adaptiveVelocity = std::clamp(phys.get("adaptiveVelocity", 200.0f).asFloat(), 10.0f, 2000.0f);
+                data.phys.adaptiveViolation = std::clamp(phys.get("adaptiveViolation", 2.0f).asFloat(), 0.1f, 50.0f);
+                data.phys.subStepBudget = std::clamp(phys.get("subStepBudget", 0).asInt(), 0, 100000);
+                data.phys.sleep = phys.get("sleep", false).asBool();
+                data.phys.sleepVelocity = std::clamp(phys.get("sleepVelocity", 1.0f).asFloat(), 0.01f, 20.0f);
+                data.phys.sleepSteps = std::clamp(phys.get("sleepSteps", 30).asInt(), 1, 1000);
+                data.phys.wakeDistance = std::clamp(phys.get("wakeDistance", 0.5f).asFloat(), 0.01f, 20.0f);
+            }
+
+            if (root.isMember("lod"))
+            {
+                const auto& lod = root["lod"];
+
+                data.lod.enabled = lod.get("enabled", false).asBool();
+                ParseFloatArray(lod["distance"], data.lod.distance);
+                data.lod.farCollisions = lod.get("farCollisions", false).asBool();
+            }
+
+            if (root.isMember("culling"))
+            {
+                const auto& culling = root["culling"];
+
+                data.culling.enabled = culling.get("enabled", false).asBool();
+                data.culling.freeze = culling.get("freeze", false).asBool();
+                data.culling.offscreenLOD = std::clamp(culling.get("offscreenLOD", 2).asInt(), 1, 3);
+                data.culling.margin = culling.get("margin", 50.0f).asFloat();
             }
 
             if (root.isMember("ui"))
@@ -805,7 +843,39 @@ namespace CBP
             phys["timeTick"] = data.phys.timeTick;
             phys["maxSubSteps"] = data.phys.maxSubSteps;
             phys["maxDiff"] = data.phys.maxDiff;
+            phys["fixedRate"] = data.phys.fixedRate;
             phys["collisions"] = data.phys.collision;
+            phys["nativeNarrowphase"] = data.phys.nativeNarrowphase;
+            phys["collisionIslands"] = data.phys.collisionIslands;
+            phys["broadphase"] = static_cast<std::uint32_t>(data.phys.broadphase);
+            phys["broadphaseCellSize"] = data.phys.broadphaseCellSize;
+            phys["poolAutoGrow"] = data.phys.poolAutoGrow;
+            phys["parallelResponseMin"] = data.phys.parallelResponseMin;
+            phys["mtDispatch"] = data.phys.mtDispatch;
+            phys["mtDispatchThreads"] = data.phys.mtDispatchThreads;
+            phys["mtDispatchMinPairs"] = data.phys.mtDispatchMinPairs;
+            phys["batchedMotion"] = data.phys.batchedMotion;
+            phys["adaptiveSubSteps"] = data.phys.adaptiveSubSteps;
+            phys["adaptiveVelocity"] = data.phys.adaptiveVelocity;
+            phys["adaptiveViolation"] = data.phys.adaptiveViolation;
+            phys["subStepBudget"] = data.phys.subStepBudget;
+            phys["sleep"] = data.phys.sleep;
+            phys["sleepVelocity"] = data.phys.sleepVelocity;
+            phys["sleepSteps"] = data.phys.sleepSteps;
+            phys["wakeDistance"] = data.phys.wakeDistance;
+
+            auto& lod = root["lod"];
+
+            lod["enabled"] = data.lod.enabled;
+            CreateFloatArray(data.lod.distance, lod["distance"]);
+            lod["farCollisions"] = data.lod.farCollisions;
+
+            auto& culling = root["culling"];
+
+            culling["enabled"] = data.culling.enabled;
+            culling["freeze"] = data.culling.freeze;
+            culling["offscreenLOD"] = data.culling.offscreenLOD;
+            culling["margin"] = data.culling.margin;
 
             auto& ui = root["ui"];
 
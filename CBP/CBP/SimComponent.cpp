@@ -6,6 +6,8 @@
 #include "Profile.h"
 #include "GeometryTools.h"
 #include "StringHolder.h"
+#include "Rotation.h"
+#include "Constraints.h"
 
 #include "Common/Game.h"
 
@@ -35,21 +37,6 @@ namespace CBP
         return mmg(a_val / 100.0f, a_min, a_max);
     }
 
-    SKMP_FORCEINLINE static btQuaternion mkQuat(
-        const btVector3& a_axis,
-        btScalar a_axisLength,
-        btScalar a_angle)
-    {
-        btScalar s;
-        btScalar c;
-
-        DirectX::XMScalarSinCos(&s, &c, a_angle * 0.5f);
-
-        s /= a_axisLength;
-
-        return btQuaternion(a_axis.x() * s, a_axis.y() * s, a_axis.z() * s, c);
-    }
-
     SKMP_FORCEINLINE static void btVectorClamp(
         btVector3& a_vec,
         const btVector3& a_min,
@@ -402,7 +389,8 @@ namespace CBP
         m_doPositionScaling(false),
         m_doRotationScaling(false),
         m_offsetParent(false),
-        m_bonecast(false)
+        m_bonecast(false),
+        m_bcPending(false)
     {
     }
 
@@ -427,6 +415,14 @@ namespace CBP
                     {
                         if (bonecast)
                         {
+                            if (m_bcPending &&
+                                IBoneCast::IsPending(
+                                    m_parent.m_parent.GetActorHandle(),
+                                    m_parent.m_nodeName))
+                            {
+                                return true;
+                            }
+
                             bool result = IBoneCast::Get(
                                 m_parent.m_parent.GetActorHandle(),
                                 m_parent.m_nodeName,
@@ -494,7 +490,45 @@ namespace CBP
 
             if (a_nodeConf.bl.b.boneCast)
             {
-                if (!boneCastResult)
+                if (IBoneCast::IsAsync())
+                {
+                    if (!boneCastResult)
+                    {
+                        BoneCastCache::iterator it;
+                        if (IBoneCast::Get(
+                            m_parent.m_parent.GetActorHandle(),
+                            m_parent.m_nodeName,
+                            false,
+                            it))
+                        {
+                            boneCastResult = it;
+                        }
+                    }
+
+                    // anything past a cache hit with matching settings goes to the workers
+                    if (!boneCastResult ||
+                        (*boneCastResult)->second.m_data != a_nodeConf)
+                    {
+                        if (!IBoneCast::Queue(
+                            m_parent.m_parent.GetActorHandle(),
+                            m_parent.m_nodeName,
+                            a_nodeConf,
+                            boneCastResult ?
+                                std::addressof((*boneCastResult)->second.m_data.first) :
+                                nullptr))
+                        {
+                            return false;
+                        }
+
+                        colshape = std::make_unique<CollisionShapeCapsule>(
+                            collider.get(), m_parent.m_colRad, m_parent.m_colHeight);
+
+                        m_bcPending = true;
+
+                        break;
+                    }
+                }
+                else if (!boneCastResult)
                 {
                     if (!IBoneCast::Get(
                         m_parent.m_parent.GetActorHandle(),
@@ -612,6 +646,7 @@ namespace CBP
 
         m_meshShape = stl::fixed_string();
         m_bonecast = false;
+        m_bcPending = false;
 
         m_created = false;
 
@@ -683,7 +718,7 @@ namespace CBP
 
         auto& objmat =
             (m_parent.m_motion && m_parent.m_rotScaleOn && m_doRotationScaling) ?
-            parentWd.m_rotation * (m_parent.m_nodeRotation * btMatrix3x3(mkQuat(m_parent.m_rotParams.m_axis, 1.0f, m_parent.m_rotParams.m_angle * m_rotationScale))) :
+            parentWd.m_rotation * btMatrix3x3(m_parent.m_nodeRotationQuat * Rotation::mkQuat(m_parent.m_rotParams.m_axis, 1.0f, m_parent.m_rotParams.m_angle * m_rotationScale)) :
             m_parent.m_wdObject.m_rotation;
 
         auto& transform = m_collider->getWorldTransform();
@@ -794,7 +829,10 @@ namespace CBP
         m_colRad(1.0f),
         m_colHeight(0.001f),
         m_nodeScale(1.0f),
-        m_gravityCorrection(s_vecZero),
+        m_violation(0.0f),
+        m_sleeping(false),
+        m_sleepSteps(0),
+        m_lastTarget(s_vecZero),
         m_itrInitialPos(
             a_obj->m_localTransform.pos.x,
             a_obj->m_localTransform.pos.y,
@@ -809,13 +847,21 @@ namespace CBP
             a_obj->m_localTransform.rot.arr[6],
             a_obj->m_localTransform.rot.arr[7],
             a_obj->m_localTransform.rot.arr[8]),
-        m_scParent(nullptr)
+        m_scParent(nullptr),
+        m_level(0),
+        m_impulseSlot(IImpulseBuffer::Allocate())
     {
         m_nodeRotation = m_itrInitialRot;
         m_nodePosition = m_itrInitialPos;
 
         UpdateConfig(a_actor, a_obj->m_parent, nullptr, a_nodeConf, a_collisions, a_motion);
 
+        m_ldObject.m_position = m_nodePosition;
+        m_ldObject.m_rotation = m_nodeRotation;
+        m_ldRotation = m_nodeRotationQuat;
+        m_ldPrev = m_ldObject;
+        m_ldPrevRotation = m_ldRotation;
+
         m_oldWorldPos.setValue(
             a_obj->m_worldTransform.pos.x,
             a_obj->m_worldTransform.pos.y,
@@ -824,6 +870,8 @@ namespace CBP
 
     SimComponent::~SimComponent() noexcept
     {
+        IImpulseBuffer::Release(m_impulseSlot);
+
         bool actorLoaded = m_parent.GetActor()->loadedState != nullptr;
 
         if (m_motion)
@@ -954,6 +1002,8 @@ namespace CBP
             }
         }
 
+        m_nodeRotation.getRotation(m_nodeRotationQuat);
+
         if (a_collisions)
         {
             ColUpdateWeightData(a_actor, m_conf, a_nodeConf);
@@ -999,15 +1049,7 @@ namespace CBP
             m_collider.Destroy();
         }
 
-        m_gravityCorrection.setZ(m_conf.fp.f32.gravityCorrection);
-
-        if (m_conf.fp.f32.resistance > 0.0f) {
-            m_resistanceOn = true;
-            m_conf.fp.f32.resistance = std::min(m_conf.fp.f32.resistance, 250.0f);
-        }
-        else {
-            m_resistanceOn = false;
-        }
+        m_conf.fp.f32.resistance = std::clamp(m_conf.fp.f32.resistance, 0.0f, 250.0f);
 
         btVectorClamp(m_conf.fp.vec.linear, s_vecZero, s_vec10);
         btVectorClamp(m_conf.fp.vec.rotational, -s_vec10, s_vec10);
@@ -1022,7 +1064,6 @@ namespace CBP
         m_conf.fp.f32.mass = std::clamp(m_conf.fp.f32.mass, 0.001f, 10000.0f);
         m_conf.fp.f32.colPenMass = a_motion ? std::clamp(m_conf.fp.f32.colPenMass, 1.0f, 100.0f) : 1.0f;
         m_conf.fp.f32.maxVelocity = std::clamp(m_conf.fp.f32.maxVelocity, 4.0f, 20000.0f);
-        m_maxVelocity2 = m_conf.fp.f32.maxVelocity * m_conf.fp.f32.maxVelocity;
 
         m_conf.fp.f32.maxOffsetParamsBox[0] = std::clamp(m_conf.fp.f32.maxOffsetParamsBox[0], 0.0f, 1.0f);
         m_conf.fp.f32.maxOffsetParamsBox[1] = std::clamp(m_conf.fp.f32.maxOffsetParamsBox[1], 0.0f, 20000.0f);
@@ -1041,12 +1082,11 @@ namespace CBP
         m_invMass = a_motion ? 1.0f / m_conf.fp.f32.mass : 0.0f;
 
         m_conf.fp.f32.gravityBias = std::clamp(m_conf.fp.f32.gravityBias, 0.0f, 20000.0f);
-        m_gravForce = m_conf.fp.f32.gravityBias * m_conf.fp.f32.mass;
 
         m_conf.fp.f32.springSlackOffset = std::max(m_conf.fp.f32.springSlackOffset, 0.0f);
         m_conf.fp.f32.springSlackMag = std::max(m_conf.fp.f32.springSlackMag, 0.0f);
 
-        m_hasSpringSlack = m_conf.fp.f32.springSlackOffset > 0.0f || m_conf.fp.f32.springSlackMag > 0.0f;
+        bool springSlack = m_conf.fp.f32.springSlackOffset > 0.0f || m_conf.fp.f32.springSlackMag > 0.0f;
 
         m_conf.fp.f32.springSlackMag += m_conf.fp.f32.springSlackOffset;
 
@@ -1056,6 +1096,29 @@ namespace CBP
         m_conf.fp.f32.stiffness = std::clamp(m_conf.fp.f32.stiffness, 0.0f, 20000.0f);
         m_conf.fp.f32.stiffness2 = std::clamp(m_conf.fp.f32.stiffness2, 0.0f, 20000.0f);
 
+        auto& conf = m_conf.fp.f32;
+
+        m_dp.cogOffset = m_conf.fp.vec.cogOffset;
+        m_dp.linear = m_conf.fp.vec.linear;
+        m_dp.gravityCorrection.setValue(0.0f, 0.0f, conf.gravityCorrection);
+        m_dp.rotScale.setValue(conf.rotational[2], conf.rotational[0], conf.rotational[1]);
+        m_dp.stiffness = conf.stiffness;
+        m_dp.stiffness2 = conf.stiffness2;
+        m_dp.mass = conf.mass;
+        m_dp.invMass = 1.0f / conf.mass;
+        m_dp.damping = conf.damping;
+        m_dp.resistance = conf.resistance;
+        m_dp.maxVelocity = conf.maxVelocity;
+        m_dp.maxVelocity2 = conf.maxVelocity * conf.maxVelocity;
+        m_dp.gravForce = conf.gravityBias * conf.mass;
+        m_dp.slackOffset = conf.springSlackOffset;
+        m_dp.slackInvRange = 1.0f / std::max(conf.springSlackMag - conf.springSlackOffset, _EPSILON);
+        m_dp.rotOffset = conf.rotGravityCorrection * conf.rotational[2];
+        m_dp.integrator = m_conf.ex.integrator;
+        m_dp.motionConstraints = m_conf.ex.motionConstraints;
+        m_dp.resistanceOn = conf.resistance > 0.0f;
+        m_dp.springSlack = springSlack;
+
         if (a_nodeConf.bl.b.overrideScale)
         {
             m_hasScaleOverride = true;
@@ -1111,105 +1174,129 @@ namespace CBP
         m_virtld.setZero();
         m_velocity.setZero();
         //m_angularVelocity.setZero();
+        m_violation = 0.0f;
         m_ld.setZero();
         m_rotParams.Zero();
 
+        ResetSleepState();
+
         ReadTransforms();
-        m_ldObject = positionData_t();
+
+        // rest pose, interpolation may blend from it before the next step
+        m_ldObject.m_position = m_nodePosition;
+        m_ldObject.m_rotation = m_nodeRotation;
+        m_ldRotation = m_nodeRotationQuat;
+        m_ldPrev = m_ldObject;
+        m_ldPrevRotation = m_ldRotation;
 
         m_collider.Update();
 
-        if (!m_applyForceQueue.empty()) {
-            m_applyForceQueue.swap(decltype(m_applyForceQueue)());
-        }
+        IImpulseBuffer::Clear(m_impulseSlot);
     }
 
-    void SimComponent::ClampVelocity()
+    bool SimComponent::TryWake(
+        const positionData_t& a_parentWd,
+        const btVector3& a_target)
     {
-        btScalar len2 = m_velocity.length2();
-        if (len2 < m_maxVelocity2)
-            return;
+        const auto& physConf = IConfig::GetGlobal().phys;
 
-        m_velocity /= std::sqrtf(len2);
-        m_velocity *= m_conf.fp.f32.maxVelocity;
+        if (physConf.sleep && IImpulseBuffer::Empty(m_impulseSlot))
+        {
+            // where the node would be now if it kept its local offset, covers parent rotation as well
+            auto pos((a_parentWd.m_rotation * m_virtld) += a_target);
+
+            if ((pos -= m_oldWorldPos).length2() <= physConf.wakeDistance * physConf.wakeDistance)
+                return false;
+        }
+
+        Wake(a_parentWd, a_target);
+
+        return true;
     }
 
-    void SimComponent::ConstrainMotionBox(
-        const btMatrix3x3& a_parentRot,
-        const btMatrix3x3& a_invRot,
+    void SimComponent::UpdateSleepState(
         const btVector3& a_target,
-        btScalar a_timeStep
-    )
+        btScalar a_timeStep)
     {
-        btVector3 depth(s_vecZero);
-        bool skip(true);
-
-        btScalar v(m_virtld.x());
-
-        if (v > m_conf.fp.vec.maxOffsetP.x())
-        {
-            depth.setX(v - m_conf.fp.vec.maxOffsetP.x());
-            skip = false;
-        }
-        else if (v < m_conf.fp.vec.maxOffsetN.x())
-        {
-            depth.setX(v - m_conf.fp.vec.maxOffsetN.x());
-            skip = false;
-        }
+        const auto& physConf = IConfig::GetGlobal().phys;
 
-        v = m_virtld.y();
+        if (!physConf.sleep)
+            return;
 
-        if (v > m_conf.fp.vec.maxOffsetP.y())
-        {
-            depth.setY(v - m_conf.fp.vec.maxOffsetP.y());
-            skip = false;
-        }
-        else if (v < m_conf.fp.vec.maxOffsetN.y())
-        {
-            depth.setY(v - m_conf.fp.vec.maxOffsetN.y());
-            skip = false;
-        }
+        auto delta(a_target - m_lastTarget);
+        m_lastTarget = a_target;
 
-        v = m_virtld.z();
+        btScalar v2(physConf.sleepVelocity * physConf.sleepVelocity);
 
-        if (v > m_conf.fp.vec.maxOffsetP.z())
+        if (m_velocity.length2() >= v2 ||
+            delta.length2() >= v2 * (a_timeStep * a_timeStep) ||
+            !IImpulseBuffer::Empty(m_impulseSlot))
         {
-            depth.setZ(v - m_conf.fp.vec.maxOffsetP.z());
-            skip = false;
-        }
-        else if (v < m_conf.fp.vec.maxOffsetN.z())
-        {
-            depth.setZ(v - m_conf.fp.vec.maxOffsetN.z());
-            skip = false;
+            m_sleepSteps = 0;
+            return;
         }
 
-        if (skip)
+        if (++m_sleepSteps < static_cast<std::uint32_t>(physConf.sleepSteps))
             return;
 
-        auto n = a_parentRot * depth;
+        m_sleeping = true;
+        m_velocity.setZero();
 
-        auto l2 = n.length2();
-        if (l2 < _EPSILON * _EPSILON)
-            return;
+        s_numSleeps.fetch_add(1, std::memory_order_relaxed);
+    }
 
-        n /= std::sqrtf(l2);
+    void SimComponent::ConsumeSleepStats(std::uint32_t& a_sleeps, std::uint32_t& a_wakes)
+    {
+        a_sleeps = s_numSleeps.exchange(0, std::memory_order_relaxed);
+        a_wakes = s_numWakes.exchange(0, std::memory_order_relaxed);
+    }
 
-        btScalar impulse = m_velocity.dot(n);
-        btScalar mag = depth.length();
+    btVector3 SimComponent::SpringForce(const btVector3& a_diff, btScalar a_slack) const
+    {
+        auto force = a_diff * m_dp.stiffness;
+        force += (a_diff * a_diff.absolute()) *= m_dp.stiffness2;
 
-        if (mag > 0.01f) {
-            impulse += (a_timeStep * m_conf.fp.f32.maxOffsetParamsBox[3]) *
-                std::clamp(mag - 0.01f, 0.0f, m_conf.fp.f32.maxOffsetParamsBox[1]);
-        }
+        return force *= a_slack;
+    }
 
-        if (impulse <= 0.0f)
+    void SimComponent::ClampVelocity()
+    {
+        btScalar len2 = m_velocity.length2();
+        if (len2 < m_dp.maxVelocity2)
             return;
 
-        btScalar J = (1.0f + m_conf.fp.f32.maxOffsetParamsBox[2]) * impulse;
+        m_velocity /= std::sqrtf(len2);
+        m_velocity *= m_dp.maxVelocity;
+    }
+
+    void SimComponent::ConstrainMotionBox(
+        const btMatrix3x3& a_parentRot,
+        const btMatrix3x3& a_invRot,
+        const btVector3& a_target,
+        btScalar a_timeStep
+    )
+    {
+        auto depth = Constraints::BoxDepth(
+            m_virtld,
+            m_conf.fp.vec.maxOffsetN,
+            m_conf.fp.vec.maxOffsetP);
 
-        m_velocity -= n * (J * m_conf.fp.f32.maxOffsetParamsBox[0]);
+        if (!Constraints::AnyNonZero(depth))
+            return;
 
-        m_virtld = a_invRot * ((m_oldWorldPos + (m_velocity * a_timeStep)) -= a_target);
+        Constraints::Resolve(
+            a_parentRot,
+            a_invRot,
+            m_oldWorldPos,
+            a_target,
+            depth,
+            depth.length(),
+            true,
+            m_conf.fp.f32.maxOffsetParamsBox,
+            a_timeStep,
+            m_velocity,
+            m_virtld,
+            m_violation);
     }
 
     void SimComponent::ConstrainMotionSphere(
@@ -1227,30 +1314,104 @@ namespace CBP
         if (difflen <= radius)
             return;
 
-        auto n = a_parentRot * diff;
+        Constraints::Resolve(
+            a_parentRot,
+            a_invRot,
+            m_oldWorldPos,
+            a_target,
+            diff,
+            difflen - radius,
+            true,
+            m_conf.fp.f32.maxOffsetParamsSphere,
+            a_timeStep,
+            m_velocity,
+            m_virtld,
+            m_violation);
+    }
+
+    void SimComponent::ConstrainMotion(
+        const btMatrix3x3& a_parentRot,
+        const btMatrix3x3& a_invRot,
+        const btVector3& a_target,
+        btScalar a_timeStep)
+    {
+        m_violation = 0.0f;
+
+        if ((m_dp.motionConstraints & MotionConstraints::Sphere) == MotionConstraints::Sphere) {
+            ConstrainMotionSphere(a_parentRot, a_invRot, a_target, a_timeStep);
+        }
 
-        auto l2 = n.length2();
-        if (l2 < _EPSILON * _EPSILON)
-            return;
+        if ((m_dp.motionConstraints & MotionConstraints::Box) == MotionConstraints::Box) {
+            ConstrainMotionBox(a_parentRot, a_invRot, a_target, a_timeStep);
+        }
+    }
 
-        n /= std::sqrtf(l2);
+    bool SimComponent::PostIntegrate(
+        const positionData_t& a_parentWd,
+        const btMatrix3x3& a_invRot,
+        const btVector3& a_target)
+    {
+        m_oldWorldPos = (a_parentWd.m_rotation * m_virtld) += a_target;
+
+        m_ld = (m_virtld * m_dp.linear) += a_invRot * m_dp.gravityCorrection;
 
-        btScalar impulse = m_velocity.dot(n);
-        btScalar mag = difflen - radius;
+        m_ldObject.m_position = m_nodePosition + m_ld;
 
-        if (mag > 0.01f) {
-            impulse += (a_timeStep * m_conf.fp.f32.maxOffsetParamsSphere[3]) *
-                std::clamp(mag - 0.01f, 0.0f, m_conf.fp.f32.maxOffsetParamsSphere[1]);
+        if (btVectorIsInfinite(m_ldObject.m_position) ||
+            btVectorIsNaN(m_ldObject.m_position))
+        {
+            Reset();
+            return false;
         }
 
-        if (impulse <= 0.0f)
-            return;
+        m_wdObject.m_position = ((a_parentWd.m_rotation * m_ldObject.m_position) *= m_objParent->m_worldTransform.scale) += a_parentWd.m_position;
+
+        return true;
+    }
+
+    void SimComponent::UpdateRotation(const positionData_t& a_parentWd)
+    {
+        if (m_rotScaleOn)
+        {
+            m_rotParams.m_axis = GetRotationAxis();
+
+            auto l2 = m_rotParams.m_axis.length2();
+
+            if (l2 >= _EPSILON * _EPSILON) {
+                auto l = std::sqrtf(l2);
+                m_rotParams.m_axis /= l;
+                m_rotParams.m_angle = l * std::numbers::pi_v<btScalar> / 180.0f;
+            }
+            else {
+                m_rotParams.Zero();
+            }
 
-        btScalar J = (1.0f + m_conf.fp.f32.maxOffsetParamsSphere[2]) * impulse;
+            /*btQuaternion q(s_vecZero.get128());
 
-        m_velocity -= n * (J * m_conf.fp.f32.maxOffsetParamsSphere[0]);
+            auto av = m_angularVelocity * a_timeStep;
 
-        m_virtld = a_invRot * ((m_oldWorldPos + (m_velocity * a_timeStep)) -= a_target);
+            l2 = av.length2();
+            if (l2 >= _EPSILON * _EPSILON)
+            {
+                auto l = std::sqrtf(l2);
+                auto n = av / l;
+                q = mkQuat(n, 1.0f, l * std::numbers::pi_v<btScalar> / 180.0f);
+            }
+            else
+            {
+            }*/
+
+            ApplyRotation(a_parentWd, Rotation::mkQuat(m_rotParams.m_axis, 1.0f, m_rotParams.m_angle));
+        }
+        else
+        {
+            if (m_hasRotationOverride)
+            {
+                m_ldRotation = m_nodeRotationQuat;
+                m_ldObject.m_rotation = m_nodeRotation;
+                m_wdObject.m_rotation = a_parentWd.m_rotation * m_ldObject.m_rotation;
+            }
+        }
     }
 
     void SimComponent::UpdateMotion(btScalar a_timeStep)
@@ -1259,7 +1420,16 @@ namespace CBP
         {
             auto& parentWd = GetParentWorldData();
 
-            auto target(((parentWd.m_rotation * m_conf.fp.vec.cogOffset) *= m_objParent->m_worldTransform.scale) += parentWd.m_position);
+            auto& dp = m_dp;
+
+            auto target(((parentWd.m_rotation * dp.cogOffset) *= m_objParent->m_worldTransform.scale) += parentWd.m_position);
+
+            // sleeping nodes hold their last local transform, the collider still follows the parent
+            if (m_sleeping && !TryWake(parentWd, target))
+            {
+                m_collider.Update();
+                return;
+            }
 
             auto diff = target - m_oldWorldPos;
             auto adiff = diff.absolute();
@@ -1271,125 +1441,149 @@ namespace CBP
                 return;
             }
 
-            auto force = diff * m_conf.fp.f32.stiffness;
-            force += (diff *= adiff) *= m_conf.fp.f32.stiffness2;
+            auto force = diff * dp.stiffness;
+            force += (diff *= adiff) *= dp.stiffness2;
 
-            if (m_hasSpringSlack)
+            btScalar slack(1.0f);
+
+            if (dp.springSlack)
             {
-                auto m = Math::NormalizeClamp(m_virtld.length(), m_conf.fp.f32.springSlackOffset, m_conf.fp.f32.springSlackMag);
+                auto m = std::clamp((m_virtld.length() - dp.slackOffset) * dp.slackInvRange, 0.0f, 1.0f);
 
-                force *= m * m;
+                slack = m * m;
+                force *= slack;
             }
 
-            force.setZ(force.z() - m_gravForce);
+            auto spring(force);
 
-            if (!m_applyForceQueue.empty())
-            {
-                auto& current = m_applyForceQueue.front();
+            force.setZ(force.z() - dp.gravForce);
 
-                force += ((parentWd.m_rotation * current.m_force) *=
-                    m_conf.fp.f32.mass) /= a_timeStep;
+            btVector3 impulse;
 
-                if (!current.m_numImpulses--)
-                    m_applyForceQueue.pop();
+            if (IImpulseBuffer::Consume(m_impulseSlot, impulse))
+            {
+                force += ((parentWd.m_rotation * impulse) *=
+                    dp.mass) /= a_timeStep;
             }
 
-            btScalar res(m_resistanceOn ?
+            btScalar res(dp.resistanceOn ?
                 (1.0f - 1.0f / (m_velocity.length() * 0.0075f + 1.0f)) *
-                m_conf.fp.f32.resistance + 1.0f : 1.0f);
+                dp.resistance + 1.0f : 1.0f);
 
-            m_velocity -= m_velocity * ((m_conf.fp.f32.damping * res) * a_timeStep);
-            m_velocity += (force / m_conf.fp.f32.mass * a_timeStep);
+            auto invRot = parentWd.m_rotation.transpose();
 
-            ClampVelocity();
+            btScalar damping(dp.damping * res);
 
-            auto invRot = parentWd.m_rotation.transpose();
-            m_virtld = invRot * ((m_oldWorldPos + (m_velocity * a_timeStep)) -= target);
+            switch (dp.integrator)
+            {
+            case IntegratorType::SemiImplicit:
+            {
+                m_velocity += force * (a_timeStep * dp.invMass);
+                m_velocity /= 1.0f + damping * a_timeStep;
 
-            if ((m_conf.ex.motionConstraints & MotionConstraints::Sphere) == MotionConstraints::Sphere) {
-                ConstrainMotionSphere(parentWd.m_rotation, invRot, target, a_timeStep);
-            }
+                ClampVelocity();
 
-            if ((m_conf.ex.motionConstraints & MotionConstraints::Box) == MotionConstraints::Box) {
-                ConstrainMotionBox(parentWd.m_rotation, invRot, target, a_timeStep);
+                m_virtld = invRot * ((m_oldWorldPos + (m_velocity * a_timeStep)) -= target);
             }
+            break;
+            case IntegratorType::Verlet:
+            {
+                auto accel = (force * dp.invMass) -= m_velocity * damping;
+                auto pos = (m_oldWorldPos + m_velocity * a_timeStep) += accel * (0.5f * a_timeStep * a_timeStep);
 
-            m_oldWorldPos = (parentWd.m_rotation * m_virtld) += target;
+                // re-evaluate the spring at the new position, external forces stay constant over the step
+                auto accelNext = ((SpringForce(target - pos, slack) += force) -= spring) *= dp.invMass;
 
-            m_ld = (m_virtld * m_conf.fp.vec.linear) += invRot * m_gravityCorrection;
+                m_velocity += (accel += accelNext) *= (0.5f * a_timeStep);
+                m_velocity /= 1.0f + damping * (0.5f * a_timeStep);
 
-            m_ldObject.m_position = m_nodePosition + m_ld;
+                ClampVelocity();
 
-            if (btVectorIsInfinite(m_ldObject.m_position) ||
-                btVectorIsNaN(m_ldObject.m_position))
-            {
-                Reset();
-                return;
+                m_virtld = invRot * (pos -= target);
             }
-
-            if (m_rotScaleOn)
+            break;
+            case IntegratorType::Implicit:
             {
-                m_rotParams.m_axis.setX((m_virtld.z() + m_conf.fp.f32.rotGravityCorrection) * m_conf.fp.f32.rotational[2]);
-                m_rotParams.m_axis.setY(m_virtld.x() * m_conf.fp.f32.rotational[0]);
-                m_rotParams.m_axis.setZ(m_virtld.y() * m_conf.fp.f32.rotational[1]);
+                // linearized backward Euler, (1 + c*dt + K*dt^2/m) * v' = v + F*dt/m with K = -dF/dx per axis
+                btScalar dtm(a_timeStep * dp.invMass);
 
-                auto l2 = m_rotParams.m_axis.length2();
+                auto k = ((adiff * (2.0f * dp.stiffness2)) += btVector3(
+                    dp.stiffness,
+                    dp.stiffness,
+                    dp.stiffness)) *= slack;
 
-                if (l2 >= _EPSILON * _EPSILON) {
-                    auto l = std::sqrtf(l2);
-                    m_rotParams.m_axis /= l;
-                    m_rotParams.m_angle = l * std::numbers::pi_v<btScalar> / 180.0f;
-                }
-                else {
-                    m_rotParams.Zero();
-                }
+                btScalar d(1.0f + damping * a_timeStep);
 
-                /*btQuaternion q(s_vecZero.get128());
+                m_velocity += force * dtm;
+                m_velocity = m_velocity / ((k *= a_timeStep * dtm) += btVector3(d, d, d));
 
-                auto av = m_angularVelocity * a_timeStep;
+                ClampVelocity();
 
-                l2 = av.length2();
-                if (l2 >= _EPSILON * _EPSILON)
-                {
-                    auto l = std::sqrtf(l2);
-                    auto n = av / l;
-                    q = mkQuat(n, 1.0f, l * std::numbers::pi_v<btScalar> / 180.0f);
-                }
-                else
-                {
-                }*/
+                m_virtld = invRot * ((m_oldWorldPos + (m_velocity * a_timeStep)) -= target);
+            }
+            break;
+            default:
 
-                m_ldObject.m_rotation = m_nodeRotation * btMatrix3x3(mkQuat(m_rotParams.m_axis, 1.0f, m_rotParams.m_angle));
-                m_wdObject.m_rotation = parentWd.m_rotation * m_ldObject.m_rotation;
+                m_velocity -= m_velocity * (damping * a_timeStep);
+                m_velocity += force * (dp.invMass * a_timeStep);
 
+                ClampVelocity();
+
+                m_virtld = invRot * ((m_oldWorldPos + (m_velocity * a_timeStep)) -= target);
+
+                break;
             }
-            else
-            {
-                if (m_hasRotationOverride)
-                {
-                    m_ldObject.m_rotation = m_nodeRotation;
-                    m_wdObject.m_rotation = parentWd.m_rotation * m_ldObject.m_rotation;
-                }
-            }
 
-            m_wdObject.m_position = ((parentWd.m_rotation * m_ldObject.m_position) *= m_objParent->m_worldTransform.scale) += parentWd.m_position;
+            ConstrainMotion(parentWd.m_rotation, invRot, target, a_timeStep);
+
+            if (!PostIntegrate(parentWd, invRot, target))
+                return;
+
+            UpdateRotation(parentWd);
+            UpdateSleepState(target, a_timeStep);
         }
 
         m_collider.Update();
     }
 
+    bool SimComponent::UpdateMotionBatched(const btVector3& a_target, btScalar a_violation)
+    {
+        auto& parentWd = GetParentWorldData();
+
+        // constraints were solved by MotionBatch
+        m_violation = a_violation;
+
+        return PostIntegrate(parentWd, parentWd.m_rotation.transpose(), a_target);
+    }
+
+    void SimComponent::FinishMotionBatched(btScalar a_timeStep, const btVector3& a_target)
+    {
+        // rotation scaled nodes were handled by MotionBatch
+        if (!m_rotScaleOn)
+            UpdateRotation(GetParentWorldData());
+
+        UpdateSleepState(a_target, a_timeStep);
+
+        m_collider.Update();
+    }
+
     void SimComponent::ApplyForce(std::uint32_t a_steps, const btVector3& a_force)
     {
         if (!a_steps || !m_motion)
             return;
 
-        if (m_applyForceQueue.size() > 1000)
+        if (a_force.length2() < _EPSILON * _EPSILON)
             return;
 
-        if (a_force.length2() < _EPSILON * _EPSILON)
+        if (!IImpulseBuffer::Push(m_impulseSlot, a_steps, a_force))
             return;
 
-        m_applyForceQueue.emplace(a_steps, a_force);
+        Wake();
+    }
+
+    CollisionIsland& SimComponent::GetCollisionIsland() const
+    {
+        return m_parent.GetCollisionIsland();
     }
 
 #ifdef _CBP_ENABLE_DEBUG
@@ -2,6 +2,7 @@
 
 #include "Config.h"
 #include "BoneCast.h"
+#include "ImpulseBuffer.h"
 #include "Common/BulletExtensions.h"
 
 namespace CBP
@@ -9,6 +10,7 @@ namespace CBP
     class SimObject;
     class SimComponent;
     class Collider;
+    class CollisionIsland;
 
 #ifdef _CBP_ENABLE_DEBUG
     struct SimDebugInfo
@@ -291,6 +293,11 @@ namespace CBP
             return m_bonecast;
         }
 
+        // proxy capsule in place until the worker finishes the geometry
+        [[nodiscard]] SKMP_FORCEINLINE bool IsBoneCastPending() const {
+            return m_bcPending;
+        }
+
         [[nodiscard]] SKMP_FORCEINLINE const auto& GetSphereOffset() const {
             return m_bodyOffset;
         }
@@ -331,6 +338,7 @@ namespace CBP
         ColliderShapeType m_shape;
 
         bool m_bonecast;
+        bool m_bcPending;
         BoneCacheUpdateID m_bcUpdateID;
 
         btScalar m_nodeScale;
@@ -352,25 +360,9 @@ namespace CBP
         SimComponent& m_parent;
     };
 
-    class SKMP_ALIGN_AUTO SimComponent
+    // 64 so m_dp starts on a cache line
+    class SKMP_ALIGN(64) SimComponent
     {
-        struct SKMP_ALIGN_AUTO Force
-        {
-            SKMP_DECLARE_ALIGNED_ALLOCATOR_AUTO();
-
-            Force(
-                std::uint32_t a_steps,
-                const btVector3 & a_norm)
-                :
-                m_numImpulses(a_steps),
-                m_force(a_norm)
-            {
-            }
-
-            btVector3 m_force;
-            std::uint32_t m_numImpulses;
-        };
-
         struct SKMP_ALIGN_AUTO rotationParams_t
         {
             SKMP_FORCEINLINE rotationParams_t();
@@ -394,13 +386,55 @@ namespace CBP
 
         };
         
+        // config derived values, the only per-node data the integrator reads. rebuilt in UpdateConfig
+        struct SKMP_ALIGN(64) derivedParams_t
+        {
+            btVector3 cogOffset;
+            btVector3 linear;
+            btVector3 gravityCorrection;
+            btVector3 rotScale;  // rotational (z, x, y), matches the virtld -> axis mapping
+
+            btScalar stiffness;
+            btScalar stiffness2;
+            btScalar mass;
+            btScalar invMass;
+            btScalar damping;
+            btScalar resistance;
+            btScalar maxVelocity;
+            btScalar maxVelocity2;
+            btScalar gravForce;
+            btScalar slackOffset;
+            btScalar slackInvRange;
+            btScalar rotOffset;  // rotGravityCorrection * rotational z
+
+            IntegratorType integrator;
+            MotionConstraints motionConstraints;
+
+            bool resistanceOn;
+            bool springSlack;
+        };
+
+        static_assert(sizeof(derivedParams_t) == 128);
+
+        derivedParams_t m_dp;
+
         positionData_t m_wdObject;
         positionData_t m_ldObject;
+        positionData_t m_ldPrev;
         positionData_t m_wdParent;
 
+        // local rotation, m_ldObject.m_rotation is built from it
+        btQuaternion m_ldRotation;
+        btQuaternion m_ldPrevRotation;
+
         SimComponent* m_scParent;
 
+        // number of simulated ancestors, components of one level only depend on lower ones
+        std::uint32_t m_level;
+
         friend class Collider;
+        friend class MotionBatch;
+        friend class SimRecorder;
 
     private:
 
@@ -410,6 +444,7 @@ namespace CBP
             const configNode_t & a_nodeConf);
 
         SKMP_FORCEINLINE void ClampVelocity();
+        [[nodiscard]] SKMP_FORCEINLINE btVector3 SpringForce(const btVector3& a_diff, btScalar a_slack) const;
 
         SKMP_FORCEINLINE void ConstrainMotionBox(
             const btMatrix3x3& a_parentRot,
@@ -425,12 +460,66 @@ namespace CBP
             btScalar a_timeStep
         );
 
+        SKMP_FORCEINLINE bool TryWake(const positionData_t& a_parentWd, const btVector3& a_target);
+
+        SKMP_FORCEINLINE void Wake(const positionData_t& a_parentWd, const btVector3& a_target)
+        {
+            m_sleeping = false;
+            m_sleepSteps = 0;
+
+            // the held local transform followed the parent while m_oldWorldPos didn't
+            m_oldWorldPos = (a_parentWd.m_rotation * m_virtld) += a_target;
+            m_velocity.setZero();
+
+            s_numWakes.fetch_add(1, std::memory_order_relaxed);
+        }
+        SKMP_FORCEINLINE void UpdateSleepState(const btVector3& a_target, btScalar a_timeStep);
+
+        SKMP_FORCEINLINE void ResetSleepState()
+        {
+            m_sleeping = false;
+            m_sleepSteps = 0;
+            m_lastTarget.setZero();
+        }
+
+        SKMP_FORCEINLINE void ConstrainMotion(
+            const btMatrix3x3& a_parentRot,
+            const btMatrix3x3& a_invRot,
+            const btVector3& a_target,
+            btScalar a_timeStep
+        );
+
+        SKMP_FORCEINLINE bool PostIntegrate(
+            const positionData_t& a_parentWd,
+            const btMatrix3x3& a_invRot,
+            const btVector3& a_target
+        );
+
+        SKMP_FORCEINLINE void UpdateRotation(const positionData_t& a_parentWd);
+
+        [[nodiscard]] SKMP_FORCEINLINE btVector3 GetRotationAxis() const
+        {
+            btVector3 axis(m_virtld.z(), m_virtld.x(), m_virtld.y());
+
+            axis *= m_dp.rotScale;
+            axis.setX(axis.x() + m_dp.rotOffset);
+
+            return axis;
+        }
+
+        SKMP_FORCEINLINE void ApplyRotation(const positionData_t& a_parentWd, const btQuaternion& a_rot)
+        {
+            m_ldRotation = m_nodeRotationQuat * a_rot;
+            m_ldObject.m_rotation.setRotation(m_ldRotation);
+            m_wdObject.m_rotation = a_parentWd.m_rotation * m_ldObject.m_rotation;
+        }
+
         //SKMP_FORCEINLINE void SIMDFillObj();
         //SKMP_FORCEINLINE void SIMDFillParent();
 
 
     public:
-        SKMP_DECLARE_ALIGNED_ALLOCATOR_AUTO();
+        SKMP_DECLARE_ALIGNED_ALLOCATOR(64);
 
         SimComponent(
             SimObject & a_parent,
@@ -464,6 +553,8 @@ namespace CBP
             bool a_motion) noexcept;
 
         void UpdateMotion(btScalar timeStep);
+        bool UpdateMotionBatched(const btVector3& a_target, btScalar a_violation);
+        void FinishMotionBatched(btScalar a_timeStep, const btVector3& a_target);
         SKMP_FORCEINLINE void UpdateVelocity(float a_timeStep);
         SKMP_NOINLINE void Reset();
 
@@ -474,13 +565,31 @@ namespace CBP
 #endif
 
         SKMP_FORCEINLINE void AddVelocity(const btVector3 & a_vel) {
+            Wake();
             m_velocity += a_vel;
         }
 
         SKMP_FORCEINLINE void SubVelocity(const btVector3 & a_vel) {
+            Wake();
             m_velocity -= a_vel;
         }
 
+        SKMP_FORCEINLINE void Wake()
+        {
+            if (m_sleeping)
+            {
+                auto& parentWd = GetParentWorldData();
+
+                Wake(parentWd, ((parentWd.m_rotation * m_dp.cogOffset) *= m_objParent->m_worldTransform.scale) += parentWd.m_position);
+            }
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE bool IsSleeping() const {
+            return m_sleeping;
+        }
+
+        static void ConsumeSleepStats(std::uint32_t& a_sleeps, std::uint32_t& a_wakes);
+
         [[nodiscard]] SKMP_FORCEINLINE const auto& GetVelocity() const {
             return m_velocity;
         }
@@ -543,6 +652,10 @@ namespace CBP
         [[nodiscard]] SKMP_FORCEINLINE const auto& GetVirtualPos() const {
             return m_virtld;
         }
+
+        [[nodiscard]] SKMP_FORCEINLINE btScalar GetConstraintViolation() const {
+            return m_violation;
+        }
         
         [[nodiscard]] SKMP_FORCEINLINE const auto &GetNodeLocalPos() const {
             return m_nodePosition;
@@ -596,8 +709,22 @@ namespace CBP
             return m_scParent;
         }
 
+        SKMP_FORCEINLINE void SetLevel(std::uint32_t a_level) {
+            m_level = a_level;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE auto GetLevel() const {
+            return m_level;
+        }
+
         SKMP_FORCEINLINE void ReadTransforms();
         SKMP_FORCEINLINE void WriteTransforms();
+        SKMP_FORCEINLINE void WriteTransforms(btScalar a_t);
+
+        SKMP_FORCEINLINE void SaveInterpolationSource() {
+            m_ldPrev = m_ldObject;
+            m_ldPrevRotation = m_ldRotation;
+        }
 
         
         /*[[nodiscard]] SKMP_FORCEINLINE bool HasBound() const {
@@ -608,15 +735,17 @@ namespace CBP
             return m_bound;
         }*/
 
-#if 0
-        SKMP_FORCEINLINE void Lock() const {
-            m_mutex.lock();
+        // colour of the last collision response job touching this component during a_pass, 0 if none
+        [[nodiscard]] SKMP_FORCEINLINE std::uint32_t GetResponseColour(std::uint32_t a_pass) const {
+            return m_responsePass == a_pass ? m_responseColour : 0;
         }
 
-        SKMP_FORCEINLINE void Unlock() const {
-            m_mutex.unlock();
+        SKMP_FORCEINLINE void SetResponseColour(std::uint32_t a_pass, std::uint32_t a_colour) {
+            m_responsePass = a_pass;
+            m_responseColour = a_colour;
         }
-#endif
+
+        [[nodiscard]] CollisionIsland& GetCollisionIsland() const;
 
 #ifdef _CBP_ENABLE_DEBUG
         [[nodiscard]] SKMP_FORCEINLINE const auto& GetDebugInfo() const {
@@ -640,14 +769,13 @@ namespace CBP
         //btMatrix3x3 m_itrMatParent;
 
         btMatrix3x3 m_nodeRotation;
+        btQuaternion m_nodeRotationQuat;
         btVector3 m_nodePosition;
         rotationParams_t m_rotParams;
 
         btVector3 m_itrInitialPos;
         //btVector3 m_itrPosParent;
 
-        btVector3 m_gravityCorrection;
-
         btVector3 m_oldWorldPos;
         btVector3 m_virtld;
         btVector3 m_ld;
@@ -665,8 +793,7 @@ namespace CBP
         btScalar m_colHeight;
         btScalar m_nodeScale;
         btScalar m_invMass;
-        btScalar m_maxVelocity2;
-        btScalar m_gravForce;
+        btScalar m_violation;
 
         uint64_t m_groupId;
 
@@ -675,14 +802,19 @@ namespace CBP
         bool m_collisions;
         bool m_motion;
 
-        bool m_resistanceOn;
         bool m_rotScaleOn;
         bool m_hasScaleOverride;
         bool m_hasRotationOverride;
         bool m_hasPositionOverride;
-        bool m_hasSpringSlack;
         bool m_hasFriction;
 
+        bool m_sleeping;
+        std::uint32_t m_sleepSteps;
+        btVector3 m_lastTarget;
+
+        inline static std::atomic<std::uint32_t> s_numSleeps{ 0 };
+        inline static std::atomic<std::uint32_t> s_numWakes{ 0 };
+
         //bool m_hasBound;
 
         NiPointer<NiAVObject> m_obj;
@@ -692,7 +824,7 @@ namespace CBP
         stl::fixed_string m_nodeName;
         stl::fixed_string m_configGroupName;
 
-        stl::queue_simd<Force> m_applyForceQueue;
+        std::uint32_t m_impulseSlot;
 
 #ifdef _CBP_ENABLE_DEBUG
         SimDebugInfo m_debugInfo;
@@ -700,9 +832,8 @@ namespace CBP
 
         Game::FormID m_formid;
 
-#if 0
-        mutable btSpinMutex m_mutex;
-#endif
+        std::uint32_t m_responsePass{ 0 };
+        std::uint32_t m_responseColour{ 0 };
 
         Collider m_collider;
 
@@ -752,7 +883,7 @@ namespace CBP
     {
         auto obj = m_obj.get();
 
-        if (m_motion)
+        if (m_motion && !m_sleeping)
         {
             if (m_rotScaleOn || m_hasRotationOverride)
             {
@@ -770,4 +901,27 @@ namespace CBP
         //obj->UpdateWorldData(&m_updateCtx);
     }
 
+    void SimComponent::WriteTransforms(btScalar a_t)
+    {
+        if (!m_motion || m_sleeping)
+            return;
+
+        auto obj = m_obj.get();
+
+        if (m_rotScaleOn || m_hasRotationOverride)
+        {
+            btMatrix3x3 rot(m_ldPrevRotation.slerp(m_ldRotation, a_t));
+
+            _mm_storeu_ps(obj->m_localTransform.rot.data[0], rot[0].get128());
+            _mm_storeu_ps(obj->m_localTransform.rot.data[1], rot[1].get128());
+            _mm_storeu_ps(obj->m_localTransform.rot.data[2], rot[2].get128());
+        }
+
+        auto pos(m_ldPrev.m_position.lerp(m_ldObject.m_position, a_t));
+
+        obj->m_localTransform.pos.x = pos.x();
+        obj->m_localTransform.pos.y = pos.y();
+        obj->m_localTransform.pos.z = pos.z();
+    }
+
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "SimObject.h"
 #include "SimComponent.h"
 #include "StringHolder.h"
+#include "GeometryTools.h"
 
 namespace CBP
 {
@@ -220,11 +221,24 @@ namespace CBP
         m_sex(a_sex),
         m_suspended(false),
         m_markedForDelete(false),
+        m_subSteps(1),
+        m_pendingTime(0.0f),
+        m_stepTime(0.0f),
+        m_activity(0.0f),
+        m_lod(0),
+        m_lodFrame(0),
+        m_lodTime(0.0f),
+        m_lodDistance(0.0f),
+        m_timeScale(1.0f),
+        m_lodSkip(false),
+        m_lodInterp(false),
+        m_lodNoCollisions(false),
+        m_cullLOD(0),
+        m_visible(true),
+        m_frozen(false),
         m_actor(a_actor),
+        m_objRoot(a_rootNode),
         m_handle(a_handle)
-#if 0
-        , m_task(this)
-#endif
     {
 
 #ifdef _CBP_ENABLE_DEBUG
@@ -277,6 +291,16 @@ namespace CBP
 
         m_objHead = a_rootNode->GetObjectByName(
             BSStringHolder::GetSingleton()->npcHead);
+
+        // most skins don't weight the root, fall back to a humanoid sized sphere
+        if (!Geometry::FindNiBound(a_actor, BSStringHolder::GetSingleton()->npcRoot, m_cullBound) ||
+            m_cullBound.m_radius <= 0.0f)
+        {
+            m_cullBound = Bullet::btBound(btVector3(0.0f, 0.0f, 64.0f), 96.0f);
+        }
+
+        UpdateLevels();
+        UpdateGroupIndex();
 }
 
     SimObject::~SimObject()
@@ -293,6 +317,9 @@ namespace CBP
     {
         for (auto& e : m_nodes)
             e->Reset();
+
+        m_activity = 0.0f;
+        m_lodInterp = false;
     }
 
     void SimObject::InvalidateHandle()
@@ -377,6 +404,9 @@ namespace CBP
                 return IsObjectBelow(n, n->m_parent);
             });
 
+        UpdateLevels();
+        UpdateGroupIndex();
+
     }
 
     bool SimObject::HasNewNode(Actor* a_actor, const nodeMap_t& a_nodeMap)
@@ -443,6 +473,40 @@ namespace CBP
                 ++it;
             }
         }
+
+        UpdateLevels();
+        UpdateGroupIndex();
+    }
+
+    void SimObject::UpdateLevels()
+    {
+        m_numLevels = 0;
+
+        for (auto& e : m_nodes)
+        {
+            std::uint32_t level(0);
+
+            for (auto p = e->GetSimComponentParent(); p && level < m_nodes.size(); p = p->GetSimComponentParent())
+                level++;
+
+            e->SetLevel(level);
+
+            m_numLevels = std::max(m_numLevels, level + 1);
+        }
+
+        // parents always update before their children, serial and batched paths step in the same order
+        std::stable_sort(m_nodes.begin(), m_nodes.end(),
+            [](const auto& a_lhs, const auto& a_rhs) {
+                return a_lhs->GetLevel() < a_rhs->GetLevel();
+            });
+    }
+
+    void SimObject::UpdateGroupIndex()
+    {
+        m_groups.clear();
+
+        for (auto& e : m_nodes)
+            m_groups[e->GetConfigGroupName()].emplace_back(e.get());
     }
 
     void SimObject::ApplyForce(
@@ -450,12 +514,12 @@ namespace CBP
         const stl::fixed_string& a_component,
         const btVector3& a_force)
     {
-        for (auto& e : m_nodes)
-        {
-            if (e->GetConfigGroupName() == a_component) {
-                e->ApplyForce(a_steps, a_force);
-            }
-        }
+        auto it = m_groups.find(a_component);
+        if (it == m_groups.end())
+            return;
+
+        for (auto e : it->second)
+            e->ApplyForce(a_steps, a_force);
     }
 
 #ifdef _CBP_ENABLE_DEBUG
@@ -469,6 +533,10 @@ namespace CBP
     void SimObject::SetSuspended(bool a_switch)
     {
         m_suspended = a_switch;
+        m_lodNoCollisions = false;
+        m_lodFrame = 0;
+        m_lodTime = 0.0f;
+        m_lodSkip = false;
 
         for (auto& e : m_nodes)
             e->GetCollider().SetShouldProcess(!a_switch);
@@ -486,6 +554,152 @@ namespace CBP
             e->UpdateMotion(a_timeStep);
     }
 
+    std::uint32_t SimObject::SelectSubSteps(
+        std::uint32_t a_maxSteps,
+        float a_invVelocity,
+        float a_invViolation)
+    {
+        float activity(0.0f);
+
+        for (auto& e : m_nodes)
+        {
+            if (!e->HasMotion())
+                continue;
+
+            activity = std::max(activity, std::max(
+                e->GetVelocity().length() * a_invVelocity,
+                e->GetConstraintViolation() * a_invViolation));
+        }
+
+        // react to bursts immediately, settle over a few frames
+        m_activity = std::min(std::max(m_activity * 0.8f, activity), 1.0f);
+
+        auto steps = static_cast<std::uint32_t>(std::ceilf(m_activity * static_cast<float>(a_maxSteps)));
+
+        SetSubSteps(std::clamp(steps, 1U, a_maxSteps));
+
+        return m_subSteps;
+    }
+
+    void SimObject::UpdateLOD(
+        std::uint32_t a_lod,
+        float a_distance,
+        float a_interval,
+        bool a_collisions)
+    {
+        m_lodDistance = a_distance;
+
+        // hold the current pose, the first visible frame steps right away
+        if (m_frozen)
+        {
+            m_lod = a_lod;
+            m_lodSkip = true;
+            m_lodInterp = false;
+            m_lodFrame = 1U << 3;
+            m_lodTime = 0.0f;
+            return;
+        }
+
+        a_lod = std::max(a_lod, m_cullLOD);
+
+        m_lod = a_lod;
+
+        if (a_collisions == m_lodNoCollisions)
+        {
+            m_lodNoCollisions = !a_collisions;
+
+            for (auto& e : m_nodes)
+                e->GetCollider().SetShouldProcess(a_collisions);
+        }
+
+        m_lodTime += a_interval;
+
+        if (++m_lodFrame < (1U << a_lod))
+        {
+            m_lodSkip = true;
+            return;
+        }
+
+        m_lodSkip = false;
+        m_timeScale = m_lodTime / a_interval;
+        m_lodFrame = 0;
+        m_lodTime = 0.0f;
+
+        // ease back in from off-screen one rate step per simulated frame
+        if (m_visible && m_cullLOD > 0)
+            m_cullLOD--;
+
+        // interpolate from the last simulated pose towards the one produced this frame
+        m_lodInterp = a_lod > 0;
+
+        if (m_lodInterp)
+        {
+            for (auto& e : m_nodes)
+                e->SaveInterpolationSource();
+        }
+    }
+
+    void SimObject::ClearLOD()
+    {
+        if (m_lodNoCollisions)
+        {
+            m_lodNoCollisions = false;
+
+            for (auto& e : m_nodes)
+                e->GetCollider().SetShouldProcess(true);
+        }
+
+        m_lod = 0;
+        m_lodFrame = 0;
+        m_lodTime = 0.0f;
+        m_timeScale = 1.0f;
+        m_lodSkip = false;
+        m_lodInterp = false;
+
+        m_cullLOD = 0;
+        m_visible = true;
+        m_frozen = false;
+    }
+
+    void SimObject::SetVisible(
+        bool a_visible,
+        std::uint32_t a_offscreenLOD,
+        bool a_freeze)
+    {
+        m_visible = a_visible;
+
+        if (a_visible)
+        {
+            m_frozen = false;
+            return;
+        }
+
+        m_cullLOD = a_freeze ? 3 : a_offscreenLOD;
+
+        if (a_freeze && !m_frozen)
+        {
+            m_frozen = true;
+
+            // nothing left to interpolate towards
+            for (auto& e : m_nodes)
+                e->SaveInterpolationSource();
+        }
+    }
+
+    void SimObject::GetCullBound(btVector3& a_center, btScalar& a_radius) const
+    {
+        auto& tf = m_objRoot->m_worldTransform;
+        auto& m = tf.rot.data;
+        auto& p = m_cullBound.m_pos;
+
+        a_center.setValue(
+            (m[0][0] * p.x() + m[0][1] * p.y() + m[0][2] * p.z()) * tf.scale + tf.pos.x,
+            (m[1][0] * p.x() + m[1][1] * p.y() + m[1][2] * p.z()) * tf.scale + tf.pos.y,
+            (m[2][0] * p.x() + m[2][1] * p.y() + m[2][2] * p.z()) * tf.scale + tf.pos.z);
+
+        a_radius = m_cullBound.m_radius * tf.scale;
+    }
+
     void SimObject::ReadTransforms(float a_timeStep)
     {
         if (m_suspended)
@@ -507,13 +721,38 @@ namespace CBP
             e->UpdateWorldData();
     }*/
 
-    void SimObject::WriteTransforms()
+    void SimObject::SaveInterpolationSource()
     {
-        if (m_suspended)
+        // LOD interpolation spans several updates and keeps its own source
+        if (m_suspended || m_lodInterp)
             return;
 
         for (auto& e : m_nodes)
-            e->WriteTransforms();
+            e->SaveInterpolationSource();
+    }
+
+    void SimObject::WriteTransforms(btScalar a_alpha, bool a_interpolate)
+    {
+        if (m_suspended)
+            return;
+
+        if (m_lodInterp)
+        {
+            auto t = (static_cast<btScalar>(m_lodFrame) + a_alpha) / static_cast<btScalar>(1U << m_lod);
+
+            for (auto& e : m_nodes)
+                e->WriteTransforms(t);
+        }
+        else if (a_interpolate)
+        {
+            for (auto& e : m_nodes)
+                e->WriteTransforms(a_alpha);
+        }
+        else
+        {
+            for (auto& e : m_nodes)
+                e->WriteTransforms();
+        }
     }
 
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Config.h"
 #include "Common/BulletExtensions.h"
 #include "SimComponent.h"
+#include "Collision.h"
 
 namespace CBP
 {
@@ -62,9 +63,17 @@ namespace CBP
         SimObject& operator=(SimObject&&) = delete;
 
         void UpdateMotion(float a_timeStep);
+        std::uint32_t SelectSubSteps(std::uint32_t a_maxSteps, float a_invVelocity, float a_invViolation);
         void ReadTransforms(float a_timeStep);
         //void ReadWorldData();
-        void WriteTransforms();
+        void WriteTransforms(btScalar a_alpha, bool a_interpolate);
+        void SaveInterpolationSource();
+
+        void UpdateLOD(std::uint32_t a_lod, float a_distance, float a_interval, bool a_collisions);
+        void ClearLOD();
+
+        void SetVisible(bool a_visible, std::uint32_t a_offscreenLOD, bool a_freeze);
+        void GetCullBound(btVector3& a_center, btScalar& a_radius) const;
 
         void UpdateConfig(Actor* a_actor, bool a_collisions, const configComponents_t& a_config);
         bool HasNewNode(Actor* a_actor, const nodeMap_t& a_nodeMap);
@@ -113,10 +122,68 @@ namespace CBP
             return m_suspended;
         }
 
+        SKMP_FORCEINLINE void SetSubSteps(std::uint32_t a_steps) {
+            m_subSteps = a_steps;
+            m_pendingTime = 0.0f;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE auto GetSubSteps() const {
+            return m_subSteps;
+        }
+
+        // spreads this actor's substeps evenly over the frame's global steps, m_stepTime is 0 when skipping one
+        SKMP_FORCEINLINE void AdvanceSubStep(std::uint32_t a_step, std::uint32_t a_numSteps, float a_timeStep)
+        {
+            m_pendingTime += a_timeStep * m_timeScale;
+
+            if ((a_step + 1) * m_subSteps / a_numSteps != a_step * m_subSteps / a_numSteps)
+            {
+                m_stepTime = m_pendingTime;
+                m_pendingTime = 0.0f;
+            }
+            else
+            {
+                m_stepTime = 0.0f;
+            }
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE float GetStepTime() const {
+            return m_stepTime;
+        }
+
+        // frame time covered by this actor's steps relative to the controller's, > 1 after LOD skipped frames
+        [[nodiscard]] SKMP_FORCEINLINE float GetTimeScale() const {
+            return m_timeScale;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE bool IsLODSkipped() const {
+            return m_lodSkip;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE auto GetLOD() const {
+            return m_lod;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE float GetLODDistance() const {
+            return m_lodDistance;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE bool IsVisible() const {
+            return m_visible;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE bool IsFrozen() const {
+            return m_frozen;
+        }
+
         [[nodiscard]] SKMP_FORCEINLINE const auto& GetNodeList() const {
             return m_nodes;
         }
 
+        [[nodiscard]] SKMP_FORCEINLINE auto GetNumLevels() const {
+            return m_numLevels;
+        }
+
         [[nodiscard]] SKMP_FORCEINLINE auto GetActorHandle() const {
             return m_handle.get();
         }
@@ -133,23 +200,14 @@ namespace CBP
             return m_nodes.empty();
         }
 
-#if 0
-        SKMP_FORCEINLINE void SetTimeStep(float a_timeStep) {
-            m_currentTimeStep = a_timeStep;
-        }
-
-        SKMP_FORCEINLINE float GetTimeStep() const {
-            return m_currentTimeStep;
-        }
-
-        [[nodiscard]] SKMP_FORCEINLINE auto& GetTask() {
-            return m_task;
-        }
-#endif
         [[nodiscard]] SKMP_FORCEINLINE auto GetActor() const {
             return m_actor.get();
         }
 
+        [[nodiscard]] SKMP_FORCEINLINE auto& GetCollisionIsland() noexcept {
+            return m_collisionIsland;
+        }
+
     private:
 
         [[nodiscard]] static NiNode* GetParentNode(
@@ -165,46 +223,47 @@ namespace CBP
             bool a_firstPerson = false);
 
         void ClearSimComponentParent(SimComponent* a_sc);
+        void UpdateGroupIndex();
+        void UpdateLevels();
 
         nodeList_t m_nodes;
+        std::uint32_t m_numLevels{ 0 };
+        std::unordered_map<stl::fixed_string, std::vector<SimComponent*>> m_groups;
 
         Game::VMHandleRef m_handle;
 
         NiPointer<Actor> m_actor;
+        NiPointer<NiAVObject> m_objRoot;
         NiPointer<NiAVObject> m_objHead;
 
+        // culling sphere in NPC root space
+        Bullet::btBound m_cullBound;
+
+        CollisionIsland m_collisionIsland;
+
         ConfigGender m_sex;
 
         bool m_suspended;
         bool m_markedForDelete;
 
-#if 0
-        float m_currentTimeStep;
-
-        struct task_t
-        {
-
-            task_t(SimObject* a_ptr) : m_ptr(a_ptr) {}
+        std::uint32_t m_subSteps;
+        float m_pendingTime;
+        float m_stepTime;
+        float m_activity;
 
-            void operator()() const
-            {
-                auto daz = _MM_GET_DENORMALS_ZERO_MODE();
-                auto ftz = _MM_GET_FLUSH_ZERO_MODE();
-
-                _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-                _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
-
-                m_ptr->UpdateMotion(m_ptr->GetTimeStep());
+        std::uint32_t m_lod;
+        std::uint32_t m_lodFrame;
+        float m_lodTime;
+        float m_lodDistance;
+        float m_timeScale;
+        bool m_lodSkip;
+        bool m_lodInterp;
+        bool m_lodNoCollisions;
 
-                _MM_SET_DENORMALS_ZERO_MODE(daz);
-                _MM_SET_FLUSH_ZERO_MODE(ftz);
-            }
-
-            SimObject* m_ptr;
-        };
+        std::uint32_t m_cullLOD;
+        bool m_visible;
+        bool m_frozen;
 
-        concurrency::task_handle<task_t> m_task;
-#endif
 
 #ifdef _CBP_ENABLE_DEBUG
         std::string m_actorName;
@@ -0,0 +1,453 @@
+#include "pch.h"
+
+#include "SimRecorder.h"
+#include "SimObject.h"
+#include "SimComponent.h"
+
+#include "Common/Serialization.h"
+
+namespace CBP
+{
+    template <class Tf>
+    SKMP_FORCEINLINE static void VisitComponents(const simActorList_t& a_actors, Tf a_func)
+    {
+        for (auto e : a_actors.getvec())
+        {
+            if (e->IsSuspended())
+                continue;
+
+            for (auto& f : e->GetNodeList())
+                a_func(*e, f.get());
+        }
+    }
+
+    SKMP_FORCEINLINE static void Store(float*& a_out, const btVector3& a_in)
+    {
+        a_out[0] = a_in.x();
+        a_out[1] = a_in.y();
+        a_out[2] = a_in.z();
+        a_out += 3;
+    }
+
+    SKMP_FORCEINLINE static void Store(float*& a_out, const btMatrix3x3& a_in)
+    {
+        for (int i = 0; i < 3; i++)
+            Store(a_out, a_in[i]);
+    }
+
+    SKMP_FORCEINLINE static void Load(const float*& a_in, btVector3& a_out)
+    {
+        a_out.setValue(a_in[0], a_in[1], a_in[2]);
+        a_in += 3;
+    }
+
+    SKMP_FORCEINLINE static void Load(const float*& a_in, btMatrix3x3& a_out)
+    {
+        for (int i = 0; i < 3; i++)
+            Load(a_in, a_out[i]);
+    }
+
+    void SimRecorder::Begin(const simActorList_t& a_actors)
+    {
+        m_recording = std::make_unique<SimRecording>();
+        m_components.clear();
+
+        VisitComponents(a_actors, [&](const SimObject& a_obj, SimComponent* a_sc)
+            {
+                m_recording->components.emplace_back(SimRecording::component_t{
+                    a_obj.GetActorHandle().GetFormID().get(),
+                    a_sc->GetNodeName().get(),
+                    a_sc->GetConfig() });
+
+                m_components.emplace_back(a_sc);
+
+                // sleep state isn't part of the recording, start from all awake
+                a_sc->ResetSleepState();
+            });
+
+        CaptureState(a_actors, m_recording->initialState);
+
+        Debug("Recording %zu components", m_components.size());
+    }
+
+    std::unique_ptr<SimRecording> SimRecorder::End(const simActorList_t& a_actors)
+    {
+        if (!m_recording)
+            return nullptr;
+
+        std::unique_ptr<SimRecording> result;
+
+        if (Validate(a_actors))
+        {
+            CaptureState(a_actors, m_recording->finalState);
+            result = std::move(m_recording);
+        }
+        else
+        {
+            Warning("Actor set changed, discarding recording");
+        }
+
+        m_recording.reset();
+        m_components.clear();
+
+        return result;
+    }
+
+    void SimRecorder::RecordFrame(
+        const simActorList_t& a_actors,
+        float a_timeAccum,
+        float a_timeStep,
+        float a_timeTick,
+        float a_maxTime,
+        bool a_collisions,
+        std::uint32_t a_fixedSteps)
+    {
+        if (m_recording->frames.size() >= MAX_FRAMES)
+            return;
+
+        if (!Validate(a_actors))
+        {
+            Warning("Actor set changed, recording aborted after %zu frames", m_recording->frames.size());
+
+            m_recording.reset();
+            m_components.clear();
+
+            return;
+        }
+
+        auto& frame = m_recording->frames.emplace_back();
+
+        frame.timeAccum = a_timeAccum;
+        frame.timeStep = a_timeStep;
+        frame.timeTick = a_timeTick;
+        frame.maxTime = a_maxTime;
+        frame.collisions = a_collisions;
+        frame.fixedSteps = a_fixedSteps;
+
+        frame.transforms.resize(m_components.size() * SimRecording::TRANSFORM_STRIDE);
+
+        auto p = frame.transforms.data();
+
+        for (auto e : m_components)
+        {
+            Store(p, e->m_wdObject.m_position);
+            Store(p, e->m_wdObject.m_rotation);
+            Store(p, e->m_wdParent.m_position);
+            Store(p, e->m_wdParent.m_rotation);
+        }
+    }
+
+    bool SimRecorder::Validate(const simActorList_t& a_actors) const
+    {
+        std::size_t i(0);
+        bool result(true);
+
+        VisitComponents(a_actors, [&](const SimObject&, SimComponent* a_sc)
+            {
+                if (i >= m_components.size() || m_components[i] != a_sc)
+                    result = false;
+
+                i++;
+            });
+
+        return result && i == m_components.size();
+    }
+
+    bool SimRecorder::Match(
+        const simActorList_t& a_actors,
+        const SimRecording& a_recording,
+        std::uint32_t& a_configMismatches)
+    {
+        auto& components = a_recording.components;
+
+        std::size_t i(0);
+        bool result(true);
+
+        a_configMismatches = 0;
+
+        VisitComponents(a_actors, [&](const SimObject& a_obj, SimComponent* a_sc)
+            {
+                if (i < components.size())
+                {
+                    auto& e = components[i];
+
+                    if (e.formid != a_obj.GetActorHandle().GetFormID().get() ||
+                        e.nodeName != a_sc->GetNodeName().get())
+                    {
+                        result = false;
+                    }
+                    else
+                    {
+                        auto& conf = a_sc->GetConfig();
+
+                        if (std::memcmp(std::addressof(e.conf.fp.f32), std::addressof(conf.fp.f32), sizeof(conf.fp.f32)) != 0 ||
+                            e.conf.ex.colShape != conf.ex.colShape ||
+                            e.conf.ex.motionConstraints != conf.ex.motionConstraints ||
+                            e.conf.ex.integrator != conf.ex.integrator)
+                        {
+                            a_configMismatches++;
+                        }
+                    }
+                }
+
+                i++;
+            });
+
+        return result && i == components.size();
+    }
+
+    void SimRecorder::CaptureState(const simActorList_t& a_actors, std::vector<float>& a_out)
+    {
+        a_out.clear();
+
+        VisitComponents(a_actors, [&](const SimObject&, SimComponent* a_sc)
+            {
+                auto offset = a_out.size();
+                a_out.resize(offset + SimRecording::STATE_STRIDE);
+
+                auto p = a_out.data() + offset;
+
+                Store(p, a_sc->m_velocity);
+                Store(p, a_sc->m_virtld);
+                Store(p, a_sc->m_oldWorldPos);
+                Store(p, a_sc->m_ld);
+                Store(p, a_sc->m_ldObject.m_position);
+                Store(p, a_sc->m_ldObject.m_rotation);
+                Store(p, a_sc->m_wdObject.m_position);
+                Store(p, a_sc->m_wdObject.m_rotation);
+            });
+    }
+
+    void SimRecorder::RestoreState(const simActorList_t& a_actors, const std::vector<float>& a_in)
+    {
+        auto p = a_in.data();
+
+        VisitComponents(a_actors, [&](const SimObject&, SimComponent* a_sc)
+            {
+                Load(p, a_sc->m_velocity);
+                Load(p, a_sc->m_virtld);
+                Load(p, a_sc->m_oldWorldPos);
+                Load(p, a_sc->m_ld);
+                Load(p, a_sc->m_ldObject.m_position);
+                Load(p, a_sc->m_ldObject.m_rotation);
+                Load(p, a_sc->m_wdObject.m_position);
+                Load(p, a_sc->m_wdObject.m_rotation);
+
+                a_sc->m_ldObject.m_rotation.getRotation(a_sc->m_ldRotation);
+                IImpulseBuffer::Clear(a_sc->m_impulseSlot);
+                a_sc->ResetSleepState();
+            });
+    }
+
+    void SimRecorder::InjectTransforms(const simActorList_t& a_actors, const SimRecording::frame_t& a_frame)
+    {
+        auto p = a_frame.transforms.data();
+
+        VisitComponents(a_actors, [&](const SimObject&, SimComponent* a_sc)
+            {
+                Load(p, a_sc->m_wdObject.m_position);
+                Load(p, a_sc->m_wdObject.m_rotation);
+                Load(p, a_sc->m_wdParent.m_position);
+                Load(p, a_sc->m_wdParent.m_rotation);
+
+                a_sc->UpdateVelocity(a_frame.timeAccum);
+            });
+    }
+
+    void SimRecorder::CompareState(
+        const std::vector<float>& a_lhs,
+        const std::vector<float>& a_rhs,
+        std::uint32_t& a_mismatches,
+        float& a_maxError)
+    {
+        a_mismatches = 0;
+        a_maxError = 0.0f;
+
+        for (std::size_t i = 0; i < a_lhs.size(); i += SimRecording::STATE_STRIDE)
+        {
+            if (std::memcmp(
+                std::addressof(a_lhs[i]),
+                std::addressof(a_rhs[i]),
+                SimRecording::STATE_STRIDE * sizeof(float)) != 0)
+            {
+                a_mismatches++;
+            }
+
+            for (std::size_t j = i; j < i + SimRecording::STATE_STRIDE; j++)
+                a_maxError = std::max(a_maxError, std::fabs(a_lhs[j] - a_rhs[j]));
+        }
+    }
+
+    bool SimRecorder::Save(
+        const fs::path& a_path,
+        const SimRecording& a_in,
+        except::descriptor& a_error)
+    {
+        try
+        {
+            Serialization::CreateRootPath(a_path);
+
+            auto tmpPath(a_path);
+            tmpPath += ".tmp";
+
+            try
+            {
+                {
+                    std::ofstream ofs;
+
+                    ofs.open(
+                        tmpPath,
+                        std::ofstream::out |
+                        std::ofstream::binary |
+                        std::ofstream::trunc,
+                        _SH_DENYWR);
+
+                    if (!ofs.is_open())
+                        throw std::system_error(errno, std::system_category(), tmpPath.string());
+
+                    using namespace boost::iostreams;
+                    using namespace boost::archive;
+
+                    filtering_streambuf<output> out;
+                    out.push(gzip_compressor(gzip_params(zlib::best_speed), 1024 * 256));
+                    out.push(ofs);
+
+                    binary_oarchive oa(out);
+
+                    oa << a_in;
+                }
+
+                fs::rename(tmpPath, a_path);
+            }
+            catch (const std::exception& e)
+            {
+                Serialization::SafeCleanup(tmpPath);
+                throw e;
+            }
+
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            a_error = e;
+            return false;
+        }
+    }
+
+    bool SimRecorder::Load(
+        const fs::path& a_path,
+        SimRecording& a_out,
+        except::descriptor& a_error)
+    {
+        try
+        {
+            std::ifstream ifs;
+
+            ifs.open(a_path, std::ifstream::in | std::ifstream::binary);
+            if (!ifs.is_open())
+                throw std::system_error(errno, std::system_category(), a_path.string());
+
+            using namespace boost::iostreams;
+            using namespace boost::archive;
+
+            filtering_streambuf<input> in;
+            in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 256));
+            in.push(ifs);
+
+            binary_iarchive ia(in);
+
+            ia >> a_out;
+
+            auto numComponents = a_out.components.size();
+
+            if (a_out.initialState.size() != numComponents * SimRecording::STATE_STRIDE ||
+                a_out.finalState.size() != numComponents * SimRecording::STATE_STRIDE)
+            {
+                throw std::exception("bad state data");
+            }
+
+            for (auto& e : a_out.frames)
+            {
+                if (e.transforms.size() != numComponents * SimRecording::TRANSFORM_STRIDE)
+                    throw std::exception("bad frame data");
+            }
+
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            a_error = e;
+            return false;
+        }
+    }
+
+    bool SimRecorder::SaveReport(
+        const fs::path& a_path,
+        const SimRecording& a_recording,
+        const replayResult_t& a_result,
+        except::descriptor& a_error)
+    {
+        try
+        {
+            std::ofstream ofs;
+
+            ofs.open(a_path, std::ofstream::out | std::ofstream::trunc);
+            if (!ofs.is_open())
+                throw std::system_error(errno, std::system_category(), a_path.string());
+
+            char buffer[512];
+
+            _snprintf_s(buffer, _TRUNCATE,
+                "frames: %u\nsteps: %u\ncomponents: %u\nconfig mismatches: %u\nstate mismatches: %u\nmax error: %g\n"
+                "read: %lld us\nmotion: %lld us\ncollisions: %lld us\n\n",
+                a_result.numFrames,
+                a_result.numSteps,
+                a_result.numComponents,
+                a_result.numConfigMismatches,
+                a_result.numStateMismatches,
+                a_result.maxStateError,
+                a_result.readTime,
+                a_result.motionTime,
+                a_result.collisionTime);
+
+            ofs << buffer;
+
+            if (a_result.orderChecked)
+            {
+                _snprintf_s(buffer, _TRUNCATE,
+                    "serial order: %s\nserial order mismatches: %u\nserial order max error: %g\n\n",
+                    a_result.orderPassed ? "passed" : "FAILED",
+                    a_result.numOrderMismatches,
+                    a_result.maxOrderError);
+
+                ofs << buffer;
+            }
+
+            // final local transforms (replayed / recorded)
+            for (std::size_t i = 0; i < a_recording.components.size(); i++)
+            {
+                auto& e = a_recording.components[i];
+
+                auto offset = i * SimRecording::STATE_STRIDE + 12;
+
+                auto r = a_result.finalState.data() + offset;
+                auto s = a_recording.finalState.data() + offset;
+
+                _snprintf_s(buffer, _TRUNCATE,
+                    "%.8X %s: %.9g %.9g %.9g / %.9g %.9g %.9g\n",
+                    e.formid, e.nodeName.c_str(),
+                    r[0], r[1], r[2],
+                    s[0], s[1], s[2]);
+
+                ofs << buffer;
+            }
+
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            a_error = e;
+            return false;
+        }
+    }
+}
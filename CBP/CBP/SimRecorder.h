@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Data.h"
+#include "Config.h"
+
+namespace CBP
+{
+    class SimComponent;
+
+    struct SimRecording
+    {
+        friend class boost::serialization::access;
+
+    public:
+
+        enum Serialization : unsigned int
+        {
+            DataVersion1 = 1
+        };
+
+        // world transforms consumed by SimComponent::ReadTransforms (object + parent, pos + 3x3 rot)
+        static constexpr std::size_t TRANSFORM_STRIDE = 24;
+        // velocity, virtld, oldWorldPos, ld, ldObject (pos + rot), wdObject (pos + rot)
+        static constexpr std::size_t STATE_STRIDE = 36;
+
+        struct component_t
+        {
+            friend class boost::serialization::access;
+
+            std::uint32_t formid;
+            std::string nodeName;
+            configComponent_t conf;
+
+        private:
+            template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+            {
+                ar& formid;
+                ar& nodeName;
+                ar& conf;
+            }
+        };
+
+        struct frame_t
+        {
+            friend class boost::serialization::access;
+
+            float timeAccum;
+            float timeStep;
+            float timeTick;
+            float maxTime;
+            bool collisions;
+            std::uint32_t fixedSteps{ 0 };
+
+            std::vector<float> transforms;
+
+        private:
+            template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+            {
+                ar& timeAccum;
+                ar& timeStep;
+                ar& timeTick;
+                ar& maxTime;
+                ar& collisions;
+                ar& transforms;
+
+                if (version >= 1)
+                    ar& fixedSteps;
+            }
+        };
+
+        std::vector<component_t> components;
+        std::vector<float> initialState;
+        std::vector<float> finalState;
+        std::vector<frame_t> frames;
+
+    private:
+        template<class Archive>
+        void serialize(Archive& ar, const unsigned int version)
+        {
+            ar& components;
+            ar& initialState;
+            ar& finalState;
+            ar& frames;
+        }
+    };
+
+    struct replayResult_t
+    {
+        std::uint32_t numFrames;
+        std::uint32_t numSteps;
+        std::uint32_t numComponents;
+        std::uint32_t numConfigMismatches;
+        std::uint32_t numStateMismatches;
+        float maxStateError;
+
+        // level ordered replay compared against a serial replay, both scalar. Passes on an exact match only
+        bool orderChecked;
+        bool orderPassed;
+        std::uint32_t numOrderMismatches;
+        float maxOrderError;
+
+        long long readTime;
+        long long motionTime;
+        long long collisionTime;
+
+        std::vector<float> finalState;
+    };
+
+    class SimRecorder :
+        ILog
+    {
+    public:
+
+        static constexpr std::size_t MAX_FRAMES = 60 * 60 * 5;
+
+        SimRecorder() = default;
+
+        SimRecorder(const SimRecorder&) = delete;
+        SimRecorder(SimRecorder&&) = delete;
+        SimRecorder& operator=(const SimRecorder&) = delete;
+        SimRecorder& operator=(SimRecorder&&) = delete;
+
+        void Begin(const simActorList_t& a_actors);
+        [[nodiscard]] std::unique_ptr<SimRecording> End(const simActorList_t& a_actors);
+
+        void RecordFrame(
+            const simActorList_t& a_actors,
+            float a_timeAccum,
+            float a_timeStep,
+            float a_timeTick,
+            float a_maxTime,
+            bool a_collisions,
+            std::uint32_t a_fixedSteps);
+
+        [[nodiscard]] SKMP_FORCEINLINE bool IsRecording() const {
+            return m_recording.get() != nullptr;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::size_t GetNumFrames() const {
+            return m_recording ? m_recording->frames.size() : 0;
+        }
+
+        [[nodiscard]] static bool Match(
+            const simActorList_t& a_actors,
+            const SimRecording& a_recording,
+            std::uint32_t& a_configMismatches);
+
+        static void CaptureState(const simActorList_t& a_actors, std::vector<float>& a_out);
+        static void RestoreState(const simActorList_t& a_actors, const std::vector<float>& a_in);
+        static void InjectTransforms(const simActorList_t& a_actors, const SimRecording::frame_t& a_frame);
+
+        static void CompareState(
+            const std::vector<float>& a_lhs,
+            const std::vector<float>& a_rhs,
+            std::uint32_t& a_mismatches,
+            float& a_maxError);
+
+        static bool Save(const fs::path& a_path, const SimRecording& a_in, except::descriptor& a_error);
+        static bool Load(const fs::path& a_path, SimRecording& a_out, except::descriptor& a_error);
+        static bool SaveReport(const fs::path& a_path, const SimRecording& a_recording, const replayResult_t& a_result, except::descriptor& a_error);
+
+        FN_NAMEPROC("SimRecorder");
+
+    private:
+
+        [[nodiscard]] bool Validate(const simActorList_t& a_actors) const;
+
+        std::unique_ptr<SimRecording> m_recording;
+        std::vector<SimComponent*> m_components;
+    };
+}
+
+BOOST_CLASS_VERSION(CBP::SimRecording, CBP::SimRecording::Serialization::DataVersion1)
+BOOST_CLASS_VERSION(CBP::SimRecording::frame_t, 1)
@@ -0,0 +1,277 @@
+#include "pch.h"
+
+#include "ThreadPool.h"
+
+namespace CBP
+{
+    IThreadPool IThreadPool::m_Instance;
+    thread_local bool IThreadPool::m_isWorker = false;
+
+    std::uint32_t IThreadPool::GetPhysicalCoreCount()
+    {
+        std::uint32_t fallback = std::max(std::thread::hardware_concurrency(), 1U);
+
+        DWORD len = 0;
+        GetLogicalProcessorInformation(nullptr, std::addressof(len));
+
+        if (!len)
+            return fallback;
+
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(
+            len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+
+        if (!GetLogicalProcessorInformation(info.data(), std::addressof(len)))
+            return fallback;
+
+        std::uint32_t count(0);
+
+        for (auto& e : info)
+        {
+            if (e.Relationship == RelationProcessorCore)
+                count++;
+        }
+
+        return count ? count : fallback;
+    }
+
+    void IThreadPool::Initialize(std::uint32_t a_numThreads)
+    {
+        if (!m_Instance.m_threads.empty())
+            return;
+
+        std::uint32_t cores = GetPhysicalCoreCount();
+
+        // leave the calling thread's core out, it runs its share of the work
+        std::uint32_t numWorkers = a_numThreads ?
+            a_numThreads :
+            std::clamp(cores, 2U, 9U) - 1;
+
+        numWorkers = std::min(numWorkers, MAX_THREADS);
+
+        m_Instance.m_shutdown.store(false);
+        m_Instance.m_numWorkers = numWorkers;
+
+        for (std::uint32_t i = 0; i < numWorkers; i++) {
+            m_Instance.m_threads.emplace_back(&IThreadPool::WorkerProc, std::addressof(m_Instance), i + 1);
+        }
+
+        m_Instance.Message("%u worker thread(s) (%u physical cores)", numWorkers, cores);
+    }
+
+    void IThreadPool::Destroy()
+    {
+        if (m_Instance.m_threads.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Instance.m_mutex);
+            m_Instance.m_shutdown.store(true);
+        }
+
+        m_Instance.m_cond.notify_all();
+
+        for (auto& e : m_Instance.m_threads)
+            e.join();
+
+        m_Instance.m_threads.clear();
+        m_Instance.m_numWorkers = 0;
+    }
+
+    void IThreadPool::WorkerProc(std::uint32_t a_slot)
+    {
+        m_isWorker = true;
+
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+
+        std::uint64_t generation(0);
+
+        for (;;)
+        {
+            // substeps are dispatched back to back, spin for a bit before going to sleep
+            for (std::uint32_t i = 0; i < SPIN_COUNT; i++)
+            {
+                if (m_generation.load(std::memory_order_acquire) != generation ||
+                    m_shutdown.load(std::memory_order_relaxed))
+                {
+                    break;
+                }
+
+                _mm_pause();
+            }
+
+            if (m_generation.load(std::memory_order_acquire) == generation)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+
+                m_cond.wait(lock, [&] {
+                    return m_generation.load(std::memory_order_acquire) != generation ||
+                        m_shutdown.load(std::memory_order_relaxed);
+                });
+            }
+
+            if (m_shutdown.load(std::memory_order_relaxed))
+                return;
+
+            generation = m_generation.load(std::memory_order_acquire);
+
+            Run(a_slot);
+
+            m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void IThreadPool::Run(std::uint32_t a_slot)
+    {
+        auto& job = m_job;
+
+        // drain own slice first, then steal from the others
+        for (std::uint32_t i = 0; i < job.numSlices; i++)
+        {
+            auto& range = m_ranges[(a_slot + i) % job.numSlices];
+
+            for (;;)
+            {
+                auto begin = range.next.fetch_add(job.grain, std::memory_order_relaxed);
+                if (begin >= range.end)
+                    break;
+
+                job.func(job.context, begin, std::min(begin + job.grain, range.end));
+            }
+        }
+    }
+
+    void IThreadPool::Dispatch(
+        std::uint32_t a_count,
+        std::uint32_t a_grain,
+        rangeFunc_t a_func,
+        const void* a_context)
+    {
+        std::lock_guard<std::mutex> dispatchLock(m_dispatchMutex);
+
+        std::uint32_t numSlices = m_numWorkers + 1;
+        std::uint32_t sliceSize = a_count / numSlices;
+        std::uint32_t rem = a_count % numSlices;
+
+        for (std::uint32_t i = 0, begin = 0; i < numSlices; i++)
+        {
+            std::uint32_t size = sliceSize + (i < rem ? 1 : 0);
+
+            m_ranges[i].next.store(begin, std::memory_order_relaxed);
+            m_ranges[i].end = begin + size;
+
+            begin += size;
+        }
+
+        m_job.func = a_func;
+        m_job.context = a_context;
+        m_job.grain = a_grain;
+        m_job.numSlices = numSlices;
+
+        m_pending.store(m_numWorkers, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_generation.fetch_add(1, std::memory_order_release);
+        }
+
+        m_cond.notify_all();
+
+        Run(0);
+
+        for (std::uint32_t i = 0; m_pending.load(std::memory_order_acquire); i++)
+        {
+            if (i < SPIN_COUNT)
+                _mm_pause();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+#if BT_THREADSAFE
+
+    BulletTaskScheduler::BulletTaskScheduler() :
+        btITaskScheduler("CBP")
+    {
+    }
+
+    int BulletTaskScheduler::getMaxNumThreads() const
+    {
+        return BT_MAX_THREAD_COUNT;
+    }
+
+    /*
+        btCollisionDispatcherMt keeps one manifold list per btGetCurrentThreadIndex(). Indices are handed out to any
+        thread that asks, not just pool workers, so report the full range rather than the number of workers.
+    */
+    int BulletTaskScheduler::getNumThreads() const
+    {
+        return BT_MAX_THREAD_COUNT;
+    }
+
+    void BulletTaskScheduler::setNumThreads(int a_numThreads)
+    {
+        m_maxThreads = static_cast<std::uint32_t>(std::max(a_numThreads, 0));
+    }
+
+    std::uint32_t BulletTaskScheduler::GetGrain(std::uint32_t a_count, int a_grainSize) const
+    {
+        std::uint32_t threads = IThreadPool::GetNumThreads() + 1;
+
+        if (m_maxThreads)
+            threads = std::min(threads, m_maxThreads);
+
+        if (threads < 2 || a_count < m_minItems)
+            return a_count;
+
+        // never more chunks than threads allowed to take them
+        return std::max(static_cast<std::uint32_t>(std::max(a_grainSize, 1)), (a_count + threads - 1) / threads);
+    }
+
+    void BulletTaskScheduler::parallelFor(
+        int a_begin,
+        int a_end,
+        int a_grainSize,
+        const btIParallelForBody& a_body)
+    {
+        if (a_end <= a_begin)
+            return;
+
+        std::uint32_t count = a_end - a_begin;
+
+        IThreadPool::ParallelFor(count, GetGrain(count, a_grainSize),
+            [&](std::uint32_t a_first, std::uint32_t a_last)
+            {
+                a_body.forLoop(a_begin + static_cast<int>(a_first), a_begin + static_cast<int>(a_last));
+            });
+    }
+
+    btScalar BulletTaskScheduler::parallelSum(
+        int a_begin,
+        int a_end,
+        int a_grainSize,
+        const btIParallelSumBody& a_body)
+    {
+        if (a_end <= a_begin)
+            return 0.0f;
+
+        std::uint32_t count = a_end - a_begin;
+
+        btSpinMutex lock;
+        btScalar sum(0.0f);
+
+        IThreadPool::ParallelFor(count, GetGrain(count, a_grainSize),
+            [&](std::uint32_t a_first, std::uint32_t a_last)
+            {
+                auto v = a_body.sumLoop(a_begin + static_cast<int>(a_first), a_begin + static_cast<int>(a_last));
+
+                lock.lock();
+                sum += v;
+                lock.unlock();
+            });
+
+        return sum;
+    }
+
+#endif
+}
\ No newline at end of file
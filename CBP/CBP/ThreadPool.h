@@ -0,0 +1,149 @@
+#pragma once
+
+namespace CBP
+{
+    class IThreadPool :
+        ILog
+    {
+        typedef void (*rangeFunc_t)(const void* a_context, std::uint32_t a_begin, std::uint32_t a_end);
+
+        struct SKMP_ALIGN(64) range_t
+        {
+            std::atomic<std::uint32_t> next;
+            std::uint32_t end;
+        };
+
+        struct job_t
+        {
+            rangeFunc_t func;
+            const void* context;
+            std::uint32_t grain;
+            std::uint32_t numSlices;
+        };
+
+    public:
+
+        static constexpr std::uint32_t MAX_THREADS = 16;
+        static constexpr std::uint32_t SPIN_COUNT = 4000;
+
+        static void Initialize(std::uint32_t a_numThreads);
+        static void Destroy();
+
+        // calling thread participates, a_func(begin, end) is invoked on chunks of at most a_grain items
+        template <class T>
+        static void ParallelFor(std::uint32_t a_count, std::uint32_t a_grain, const T& a_func);
+
+        [[nodiscard]] SKMP_FORCEINLINE static std::uint32_t GetNumThreads() {
+            return m_Instance.m_numWorkers;
+        }
+
+        [[nodiscard]] static std::uint32_t GetPhysicalCoreCount();
+
+        IThreadPool(const IThreadPool&) = delete;
+        IThreadPool(IThreadPool&&) = delete;
+        IThreadPool& operator=(const IThreadPool&) = delete;
+        IThreadPool& operator=(IThreadPool&&) = delete;
+
+        FN_NAMEPROC("ThreadPool");
+
+    private:
+        IThreadPool() = default;
+
+        void WorkerProc(std::uint32_t a_slot);
+        void Run(std::uint32_t a_slot);
+        void Dispatch(std::uint32_t a_count, std::uint32_t a_grain, rangeFunc_t a_func, const void* a_context);
+
+        range_t m_ranges[MAX_THREADS + 1];
+        job_t m_job;
+
+        std::atomic<std::uint64_t> m_generation{ 0 };
+        std::atomic<std::uint32_t> m_pending{ 0 };
+        std::atomic<bool> m_shutdown{ false };
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+
+        // the pool runs one job at a time, callers on different threads take turns
+        std::mutex m_dispatchMutex;
+
+        std::vector<std::thread> m_threads;
+        std::uint32_t m_numWorkers{ 0 };
+
+        static thread_local bool m_isWorker;
+
+        static IThreadPool m_Instance;
+    };
+
+    template <class T>
+    void IThreadPool::ParallelFor(std::uint32_t a_count, std::uint32_t a_grain, const T& a_func)
+    {
+        if (!a_count)
+            return;
+
+        a_grain = std::max(a_grain, 1U);
+
+        if (!m_Instance.m_numWorkers || m_isWorker || a_count <= a_grain)
+        {
+            a_func(0, a_count);
+            return;
+        }
+
+        m_Instance.Dispatch(a_count, a_grain,
+            [](const void* a_context, std::uint32_t a_begin, std::uint32_t a_end)
+            {
+                (*static_cast<const T*>(a_context))(a_begin, a_end);
+            },
+            std::addressof(a_func));
+    }
+
+#if BT_THREADSAFE
+
+    // Bullet task scheduler running on IThreadPool, so the MT dispatcher shares workers with motion updates
+    class BulletTaskScheduler :
+        public btITaskScheduler
+    {
+    public:
+
+        BulletTaskScheduler();
+
+        virtual int getMaxNumThreads() const override;
+        virtual int getNumThreads() const override;
+        virtual void setNumThreads(int a_numThreads) override;
+
+        virtual void parallelFor(
+            int a_begin,
+            int a_end,
+            int a_grainSize,
+            const btIParallelForBody& a_body) override;
+
+        virtual btScalar parallelSum(
+            int a_begin,
+            int a_end,
+            int a_grainSize,
+            const btIParallelSumBody& a_body) override;
+
+        // ranges shorter than this run on the calling thread
+        SKMP_FORCEINLINE void SetMinItems(std::uint32_t a_value) {
+            m_minItems = a_value;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::uint32_t GetMinItems() const {
+            return m_minItems;
+        }
+
+        [[nodiscard]] SKMP_FORCEINLINE std::uint32_t GetMaxThreads() const {
+            return m_maxThreads;
+        }
+
+    private:
+
+        SKMP_FORCEINLINE std::uint32_t GetGrain(std::uint32_t a_count, int a_grainSize) const;
+
+        std::uint32_t m_minItems{ 0 };
+
+        // including the calling thread, 0 = all
+        std::uint32_t m_maxThreads{ 0 };
+    };
+
+#endif
+}
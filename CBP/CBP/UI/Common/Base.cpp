@@ -101,6 +101,21 @@ namespace CBP
         }
     }
 
+    const char* TranslateBroadphaseType(BroadphaseType a_type)
+    {
+        switch (a_type)
+        {
+        case BroadphaseType::Dbvt:
+            return "DBVT";
+        case BroadphaseType::SweepAndPrune:
+            return "Sweep and prune";
+        case BroadphaseType::SpatialHash:
+            return "Spatial hash";
+        default:
+            return "Auto";
+        }
+    }
+
     void UpdateRaceNodeData(
         Game::FormID a_formid,
         const stl::fixed_string& a_node,
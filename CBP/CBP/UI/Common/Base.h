@@ -49,7 +49,28 @@ namespace CBP
         frameTimer,
         timePerFrame,
         rotation,
-        controllerStats
+        controllerStats,
+        batchedMotion,
+        motionTime,
+        simRecorder,
+        adaptiveSubSteps,
+        subStepBudget,
+        simLOD,
+        nodeSleep,
+        fixedRate,
+        rotationBenchmark,
+        frustumCulling,
+        cullingTest,
+        constraintBenchmark,
+        nativeNarrowphase,
+        collisionIslands,
+        broadphase,
+        poolAutoGrow,
+        poolStats,
+        narrowphaseTest,
+        parallelResponse,
+        mtDispatch,
+        dispatchBenchmark
     };
 
     typedef std::pair<const stl::fixed_string, configComponentsGenderRoot_t> actorEntryPhysConf_t;
@@ -201,6 +222,7 @@ namespace CBP
     };
 
     const char* TranslateConfigClass(ConfigClass a_class);
+    const char* TranslateBroadphaseType(BroadphaseType a_type);
 
     void UpdateRaceNodeData(
         Game::FormID a_formid,
@@ -55,7 +55,7 @@ namespace CBP
                 data1.m_numVertices,
                 data2->m_numIndices,
                 data1.m_indices.size(),
-                it->second.m_size / std::size_t(1024));
+                it->second.m_data.GetSize() / std::size_t(1024));
 
         }
         else {
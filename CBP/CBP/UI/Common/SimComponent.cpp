@@ -345,6 +345,19 @@ namespace CBP
             });
     }
 
+    template <class T, UIEditorID ID>
+    void UISimComponent<T, ID>::DoIntegratorOnChangePropagation(
+        configComponents_t& a_data,
+        configComponents_t* a_dg,
+        configComponentsValue_t& a_pair,
+        const componentValueDescMap_t::vec_value_type& a_desc) const
+    {
+        Propagate(a_data, a_dg, a_pair,
+            [&](configComponent_t& a_v, const configPropagate_t&) {
+                a_v.ex.integrator = a_pair.second.ex.integrator;
+            });
+    }
+
     template <class T, UIEditorID ID>
     bool UISimComponent<T, ID>::DrawSlider(
         const componentValueDescMap_t::vec_value_type& a_entry,
@@ -532,12 +545,65 @@ namespace CBP
         ImGui::PopID();
     }
 
+    template <class T, UIEditorID ID>
+    void UISimComponent<T, ID>::DrawIntegratorCombo(
+        T a_handle,
+        configComponents_t& a_data,
+        configComponentsValue_t& a_pair,
+        const componentValueDescMap_t::vec_value_type& a_entry)
+    {
+        auto& desc = configComponent_t::integratorDescMap.at(a_pair.second.ex.integrator);
+
+        if (ImGui::BeginCombo("Integrator##itg", desc.name.c_str()))
+        {
+            for (auto& e : configComponent_t::integratorDescMap)
+            {
+                bool selected = a_pair.second.ex.integrator == e.first;
+                if (selected)
+                    if (ImGui::IsWindowAppearing()) ImGui::SetScrollHereY();
+
+                if (ImGui::Selectable(e.second.name.c_str(), selected))
+                {
+                    a_pair.second.ex.integrator = e.first;
+                    OnIntegratorChange(a_handle, a_data, a_pair, a_entry);
+                }
+            }
+
+            ImGui::EndCombo();
+        }
+
+        HelpMarker(desc.desc);
+
+        const auto& globalConfig = IConfig::GetGlobal();
+
+        float stableStep = a_pair.second.GetStableTimeStep();
+
+        if (stableStep == std::numeric_limits<float>::infinity())
+        {
+            ImGui::TextWrapped("Stable step: unbounded");
+        }
+        else
+        {
+            bool warn = stableStep < globalConfig.phys.timeTick;
+
+            if (warn)
+                ImGui::PushStyleColor(ImGuiCol_Text, s_colorWarning);
+
+            ImGui::TextWrapped("Stable step: %.2f ms (time tick %.2f ms)",
+                stableStep * 1000.0f, globalConfig.phys.timeTick * 1000.0f);
+
+            if (warn)
+                ImGui::PopStyleColor();
+        }
+    }
+
     template <class T, UIEditorID ID>
     UISimComponent<T, ID>::UISimComponent() :
         UIMainItemFilter<ID>(MiscHelpText::dataFilterPhys, true),
         m_eraseCurrent(false),
         m_cscStr("Collider shape"),
         m_csStr("Constraint shapes"),
+        m_itgStr("Integrator"),
         m_cicUISC("UISC"),
         m_cicGUISC("GUISC"),
         m_cicCSSID("UISC")
@@ -550,6 +616,7 @@ namespace CBP
         m_eraseCurrent(false),
         m_cscStr("Collider shape"),
         m_csStr("Constraint shapes"),
+        m_itgStr("Integrator"),
         m_cicUISC("UISC"),
         m_cicGUISC("GUISC"),
         m_cicCSSID("UISC")
@@ -624,6 +691,12 @@ namespace CBP
                                 DrawColliderShapeCombo(a_handle, a_data, a_pair, e, a_nodeList);
                             }
                         }
+                        else if (groupType == DescUIGroupType::Physics)
+                        {
+                            if (m_sliderFilter->Test(m_itgStr)) {
+                                DrawIntegratorCombo(a_handle, a_data, a_pair, e);
+                            }
+                        }
                         else if (groupType == DescUIGroupType::PhysicsMotionConstraints)
                         {
                             if (m_sliderFilter->Test(m_csStr)) {
@@ -52,6 +52,13 @@ namespace CBP
             const componentValueDescMap_t::vec_value_type& a_desc
         ) = 0;
 
+        virtual void OnIntegratorChange(
+            T a_handle,
+            configComponents_t& a_data,
+            configComponentsValue_t& a_pair,
+            const componentValueDescMap_t::vec_value_type& a_desc
+        ) = 0;
+
         virtual void OnComponentUpdate(
             T a_handle,
             configComponents_t& a_data,
@@ -119,6 +126,12 @@ namespace CBP
             configComponentsValue_t& a_pair,
             const componentValueDescMap_t::vec_value_type& a_desc) const;
 
+        void DoIntegratorOnChangePropagation(
+            configComponents_t& a_data,
+            configComponents_t* a_dg,
+            configComponentsValue_t& a_pair,
+            const componentValueDescMap_t::vec_value_type& a_desc) const;
+
     private:
 
         void DrawSliderContextMenu(
@@ -200,11 +213,18 @@ namespace CBP
             configComponentsValue_t& a_pair,
             const componentValueDescMap_t::vec_value_type& a_entry);
 
+        void DrawIntegratorCombo(
+            T a_handle,
+            configComponents_t& a_data,
+            configComponentsValue_t& a_pair,
+            const componentValueDescMap_t::vec_value_type& a_entry);
+
         char m_scBuffer1[64 + std::numeric_limits<float>::digits];
         bool m_eraseCurrent;
 
         stl::fixed_string m_cscStr;
         stl::fixed_string m_csStr;
+        stl::fixed_string m_itgStr;
 
         UICommon::UICollapsibleIDCache<Enum::Underlying(ID)> m_cicUISC;
         UICommon::UICollapsibleIDCache<Enum::Underlying(ID)> m_cicGUISC;
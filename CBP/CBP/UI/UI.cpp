@@ -289,6 +289,75 @@ namespace CBP
                         IBoneCast::Release();
                     }
 
+                    if (ImGui::MenuItem("Build bonecast pack"))
+                    {
+                        m_popup.push(
+                            UIPopupType::Confirm,
+                            "Build bonecast pack",
+                            "Pack all sampled bonecast geometry into a single file? This clears the bonecast cache."
+                        ).call([&](const auto&)
+                            {
+                                boneCastPackResult_t result;
+
+                                if (IBoneCast::BuildPack(result))
+                                {
+                                    m_popup.push(
+                                        UIPopupType::Message,
+                                        "Build bonecast pack",
+                                        "%u entries packed (%u from the previous pack), %u failed",
+                                        result.numEntries,
+                                        result.numCarried,
+                                        result.numFailed);
+                                }
+                                else
+                                {
+                                    m_popup.push(
+                                        UIPopupType::Message,
+                                        "Build bonecast pack",
+                                        "Failed to build the pack:\n\n%s",
+                                        IBoneCast::GetLastIOException().what());
+                                }
+                            }
+                        );
+                    }
+
+                    if (ImGui::MenuItem("Benchmark bonecast codecs"))
+                    {
+                        std::vector<boneCastCodecBenchmark_t> results;
+
+                        if (IBoneCast::RunCodecBenchmark(results))
+                        {
+                            std::string text;
+                            char buffer[256];
+
+                            for (auto& e : results)
+                            {
+                                // bytes per microsecond is MB/s
+                                _snprintf_s(buffer, _TRUNCATE, "%s: ratio %.2f, write %.1f MB/s, read %.1f MB/s\n",
+                                    e.name,
+                                    static_cast<double>(e.rawBytes) / static_cast<double>(std::max(e.storedBytes, 1ULL)),
+                                    static_cast<double>(e.rawBytes) / static_cast<double>(std::max(e.writeTime, 1LL)),
+                                    static_cast<double>(e.rawBytes) / static_cast<double>(std::max(e.readTime, 1LL)));
+
+                                text.append(buffer);
+                            }
+
+                            m_popup.push(
+                                UIPopupType::Message,
+                                "Bonecast codecs",
+                                "%s",
+                                text.c_str());
+                        }
+                        else
+                        {
+                            m_popup.push(
+                                UIPopupType::Message,
+                                "Bonecast codecs",
+                                "Benchmark failed:\n\n%s",
+                                IBoneCast::GetLastIOException().what());
+                        }
+                    }
+
                     ImGui::EndMenu();
                 }
 
@@ -35,6 +35,27 @@ namespace CBP
         case MiscHelpText::timePerFrame: return "Amount of time the physics simulation consumes per frame (in microseconds).";
         case MiscHelpText::rotation: return "Collider rotation in degrees around the Z, Y and Y axes respectively.";
         case MiscHelpText::controllerStats: return "Actor controller prints information to the log. Use this only for debugging.";
+        case MiscHelpText::batchedMotion: return "Integrate nodes in SIMD batches across all actors instead of one at a time. Nodes are grouped by how many simulated parents they have, each group is updated after the one its parents are in.";
+        case MiscHelpText::motionTime: return "Time spent integrating node motion per frame and the average cost of a single node step (excludes collision detection).";
+        case MiscHelpText::simRecorder: return "Records the transforms driving the simulation for the current set of actors. Replay re-runs the last recording on the same actors and writes per-phase timings and final node transforms next to it. With batched motion enabled the recording is replayed twice more with the scalar integrator, in level order and in serial node order; Serial order passes only if both end bit-exact. The actors must still be loaded with the same nodes; simulation resets afterwards.\n\nThe replay runs on the game thread while holding the simulation lock, the game freezes until it finishes (up to three times the recording length with batched motion).";
+        case MiscHelpText::adaptiveSubSteps: return "Each actor picks its own number of substeps per frame from node velocity and motion constraint violations. Actors at rest take a single step, ones moving at or above the full rate velocity (or violating constraints by the full rate distance) take all of them.";
+        case MiscHelpText::subStepBudget: return "Upper limit on node updates per frame across all actors. When exceeded every actor's substep count is scaled down evenly. 0 = unlimited.";
+        case MiscHelpText::simLOD: return "Simulate actors beyond the first, second and third distance from the camera at 1/2, 1/4 and 1/8 of the rate respectively, interpolating nodes in between. Collisions are off in the last band unless enabled below.";
+        case MiscHelpText::nodeSleep: return "Nodes whose velocity and target movement stay below the sleep velocity for the given number of steps stop being simulated and hold their pose. They wake when their parent moves them further than the wake distance, a force is applied or a collision pushes them.";
+        case MiscHelpText::fixedRate: return "Always step the simulation at exactly the time tick, carrying leftover time over to the next frame. Nodes are drawn interpolated between the last two steps, which adds up to one tick of latency. Steps beyond max. substeps per frame are dropped.";
+        case MiscHelpText::frustumCulling: return "Test each actor's bounding sphere against the camera frustum before stepping. Actors off screen are simulated at the off-screen rate or frozen in their current pose, and step back up to full rate one level per simulated frame once they come into view. The margin enlarges the sphere so nodes near the edge of the screen don't freeze.";
+        case MiscHelpText::cullingTest: return "Tests random spheres against synthetic camera frusta with both the scalar and the SIMD frustum test and compares the results. Zero radius spheres are also checked against projecting the point with the camera matrix. Any mismatch means the culling is wrong.";
+        case MiscHelpText::constraintBenchmark: return "Times the box and sphere motion constraints on synthetic nodes, once with nodes resting inside their limits and once with noisy motion crossing them: the old per-axis branches, the masked per-node path used by scalar updates and the branch-free SIMD path used by batched motion. Max error is the largest velocity difference against the branching version.";
+        case MiscHelpText::nativeNarrowphase: return "Sphere-sphere, sphere-capsule and capsule-capsule pairs are tested with closed form code instead of Bullet's collision algorithms and contact manifolds. Pairs involving any other shape still go through Bullet. Contacts are no longer cached across steps for these pairs.";
+        case MiscHelpText::collisionIslands: return "Colliders of each actor get a broadphase of their own while the actor's bounding sphere doesn't touch any other actor, so the shared broadphase only holds actors that are close to each other. Results are the same, only fewer pairs are tested. Actors with few colliders in an otherwise empty scene gain little.";
+        case MiscHelpText::broadphase: return "Algorithm used to find overlapping colliders in the shared collision world. DBVT and sweep and prune update incrementally and get slower the further colliders move per step, the spatial hash is rebuilt every step. Auto picks one from the collider count and how far colliders move relative to their size, re-evaluated every 120 steps. Switching drops cached contacts once. Cell size 0 = twice the average collider size. Per-algorithm timings are in the profiler.";
+        case MiscHelpText::poolAutoGrow: return "Bullet keeps contact manifolds and collision algorithms in fixed size pools (sized in the plugin ini) and allocates from the heap once they run out. With this enabled the pools are replaced with larger ones before the next step when demand exceeded them, which drops cached contacts once. Pool usage and overflow counts are in the profiler.";
+        case MiscHelpText::poolStats: return "Contact manifolds per frame, then used/size of Bullet's manifold and collision algorithm pools. Peak is the highest demand seen, overflows the total number of allocations that missed the pool and went to the heap instead.";
+        case MiscHelpText::narrowphaseTest: return "Tests random sphere and capsule pairs with the native contact code and with Bullet's own algorithms and compares the results. Mismatches count pairs where only one of them reports a penetration deeper than 0.05; error columns are the largest depth and normal (1 - cos) differences.";
+        case MiscHelpText::parallelResponse: return "Collision response runs on the motion thread pool once a step has at least this many colliding pairs. Pairs are split into batches that never share a node, applied in the same per-node order as the serial loop, so results are identical. Requires multithreaded motion updates to be enabled in the plugin ini. 0 = always serial.";
+        case MiscHelpText::mtDispatch: return "Run Bullet's narrowphase for overlapping pairs on the shared worker threads once there are at least the minimum number of pairs. Dispatch threads limits how many threads take part, including the calling one (0 = all).";
+        case MiscHelpText::dispatchBenchmark: return "Builds 10 to 200 synthetic actors with sphere and capsule colliders in a private collision world and times a detection step with the serial and the MT dispatcher. Both use Bullet's own algorithms, not the native sphere/capsule path. The MT run ignores the minimum pair count. MT needs a Bullet build with BT_THREADSAFE.";
+        case MiscHelpText::rotationBenchmark: return "Times the per-step node rotation update on synthetic data: the old matrix composition, the quaternion path used now and the quaternion path fed by the SIMD axis-angle kernel that batched motion updates use.";
         default: return "??";
         }
     }
@@ -3,6 +3,7 @@
 #include "UIOptions.h"
 
 #include "CBP/UI/UI.h"
+#include "CBP/ThreadPool.h"
 
 #include "Drivers/cbp.h"
 #include "Drivers/gui.h"
@@ -124,6 +125,66 @@ namespace CBP
                 if (Checkbox("Enable collisions", &globalConfig.phys.collision))
                     DCBP::ResetActors();
 
+                if (globalConfig.phys.collision)
+                {
+                    Checkbox("Native sphere/capsule contacts", &globalConfig.phys.nativeNarrowphase);
+                    HelpMarker(MiscHelpText::nativeNarrowphase);
+
+                    Checkbox("Per-actor collision islands", &globalConfig.phys.collisionIslands);
+                    HelpMarker(MiscHelpText::collisionIslands);
+
+                    if (ImGui::BeginCombo("Broadphase", TranslateBroadphaseType(globalConfig.phys.broadphase)))
+                    {
+                        for (std::uint32_t i = 0; i < 4; i++)
+                        {
+                            auto type = static_cast<BroadphaseType>(i);
+                            bool selected = globalConfig.phys.broadphase == type;
+
+                            if (selected)
+                                if (ImGui::IsWindowAppearing()) ImGui::SetScrollHereY();
+
+                            if (ImGui::Selectable(TranslateBroadphaseType(type), selected))
+                                SetGlobal(globalConfig.phys.broadphase, type);
+                        }
+
+                        ImGui::EndCombo();
+                    }
+
+                    HelpMarker(MiscHelpText::broadphase);
+
+                    if (globalConfig.phys.broadphase == BroadphaseType::Auto ||
+                        globalConfig.phys.broadphase == BroadphaseType::SpatialHash)
+                    {
+                        if (SliderFloat("Hash cell size", &globalConfig.phys.broadphaseCellSize, 0.0f, 200.0f, "%.1f"))
+                            globalConfig.phys.broadphaseCellSize = std::clamp(globalConfig.phys.broadphaseCellSize, 0.0f, 1000.0f);
+                    }
+
+                    Checkbox("Grow contact pools", &globalConfig.phys.poolAutoGrow);
+                    HelpMarker(MiscHelpText::poolAutoGrow);
+
+                    if (SliderInt("Parallel response min. pairs", &globalConfig.phys.parallelResponseMin, 0, 20000))
+                        globalConfig.phys.parallelResponseMin = std::clamp(globalConfig.phys.parallelResponseMin, 0, 100000);
+
+                    HelpMarker(MiscHelpText::parallelResponse);
+
+#if BT_THREADSAFE
+                    if (DCBP::GetDriverConfig().multiThreadedCollisionDetection)
+                    {
+                        Checkbox("MT collision dispatch", &globalConfig.phys.mtDispatch);
+                        HelpMarker(MiscHelpText::mtDispatch);
+
+                        if (globalConfig.phys.mtDispatch)
+                        {
+                            if (SliderInt("Dispatch threads", &globalConfig.phys.mtDispatchThreads, 0, IThreadPool::MAX_THREADS + 1))
+                                globalConfig.phys.mtDispatchThreads = std::clamp(globalConfig.phys.mtDispatchThreads, 0, 64);
+
+                            if (SliderInt("Dispatch min. pairs", &globalConfig.phys.mtDispatchMinPairs, 0, 5000))
+                                globalConfig.phys.mtDispatchMinPairs = std::clamp(globalConfig.phys.mtDispatchMinPairs, 0, 100000);
+                        }
+                    }
+#endif
+                }
+
                 ImGui::Spacing();
 
                 float timeTick = 1.0f / globalConfig.phys.timeTick;
@@ -137,6 +198,9 @@ namespace CBP
 
                 HelpMarker(MiscHelpText::maxSubSteps);
 
+                Checkbox("Fixed rate", &globalConfig.phys.fixedRate);
+                HelpMarker(MiscHelpText::fixedRate);
+
                 ImGui::Spacing();
 
                 if (SliderFloat("Max. diff", &globalConfig.phys.maxDiff, 200.0f, 2000.0f, "%.0f"))
@@ -144,6 +208,77 @@ namespace CBP
 
                 ImGui::Spacing();
 
+                Checkbox("Batched motion updates", &globalConfig.phys.batchedMotion);
+                HelpMarker(MiscHelpText::batchedMotion);
+
+                ImGui::Spacing();
+
+                Checkbox("Adaptive substeps", &globalConfig.phys.adaptiveSubSteps);
+                HelpMarker(MiscHelpText::adaptiveSubSteps);
+
+                if (globalConfig.phys.adaptiveSubSteps)
+                {
+                    if (SliderFloat("Full rate velocity", &globalConfig.phys.adaptiveVelocity, 10.0f, 2000.0f, "%.0f"))
+                        globalConfig.phys.adaptiveVelocity = std::clamp(globalConfig.phys.adaptiveVelocity, 10.0f, 2000.0f);
+
+                    if (SliderFloat("Full rate violation", &globalConfig.phys.adaptiveViolation, 0.1f, 50.0f, "%.1f"))
+                        globalConfig.phys.adaptiveViolation = std::clamp(globalConfig.phys.adaptiveViolation, 0.1f, 50.0f);
+
+                    if (SliderInt("Node step budget", &globalConfig.phys.subStepBudget, 0, 20000))
+                        globalConfig.phys.subStepBudget = std::clamp(globalConfig.phys.subStepBudget, 0, 100000);
+
+                    HelpMarker(MiscHelpText::subStepBudget);
+                }
+
+                ImGui::Spacing();
+
+                Checkbox("Node sleeping", &globalConfig.phys.sleep);
+                HelpMarker(MiscHelpText::nodeSleep);
+
+                if (globalConfig.phys.sleep)
+                {
+                    SliderFloat("Sleep velocity", &globalConfig.phys.sleepVelocity, 0.01f, 20.0f, "%.2f");
+                    SliderInt("Sleep delay (steps)", &globalConfig.phys.sleepSteps, 1, 1000);
+                    SliderFloat("Wake distance", &globalConfig.phys.wakeDistance, 0.01f, 20.0f, "%.2f");
+                }
+
+                ImGui::Spacing();
+
+                Checkbox("Distance LOD", &globalConfig.lod.enabled);
+                HelpMarker(MiscHelpText::simLOD);
+
+                if (globalConfig.lod.enabled)
+                {
+                    if (SliderFloat3("LOD distances", globalConfig.lod.distance, 500.0f, 20000.0f, "%.0f"))
+                    {
+                        for (int i = 1; i < 3; i++)
+                            globalConfig.lod.distance[i] = std::max(globalConfig.lod.distance[i], globalConfig.lod.distance[i - 1]);
+                    }
+
+                    Checkbox("Far LOD collisions", &globalConfig.lod.farCollisions);
+                }
+
+                ImGui::Spacing();
+
+                Checkbox("Frustum culling", &globalConfig.culling.enabled);
+                HelpMarker(MiscHelpText::frustumCulling);
+
+                if (globalConfig.culling.enabled)
+                {
+                    Checkbox("Freeze off-screen actors", &globalConfig.culling.freeze);
+
+                    if (!globalConfig.culling.freeze)
+                    {
+                        if (SliderInt("Off-screen rate (1/2^n)", &globalConfig.culling.offscreenLOD, 1, 3))
+                            globalConfig.culling.offscreenLOD = std::clamp(globalConfig.culling.offscreenLOD, 1, 3);
+                    }
+
+                    if (SliderFloat("Bound margin", &globalConfig.culling.margin, 0.0f, 500.0f, "%.0f"))
+                        globalConfig.culling.margin = std::clamp(globalConfig.culling.margin, 0.0f, 500.0f);
+                }
+
+                ImGui::Spacing();
+
                 ImGui::TreePop();
             }
 
@@ -176,6 +176,15 @@ namespace CBP
         DoMotionConstraintOnChangePropagation(a_data, nullptr, a_pair, a_desc);
     }
 
+    void UIProfileEditorPhysics::OnIntegratorChange(
+        int,
+        PhysicsProfile::base_type::config_type& a_data,
+        PhysicsProfile::base_type::value_type& a_pair,
+        const componentValueDescMap_t::vec_value_type& a_desc)
+    {
+        DoIntegratorOnChangePropagation(a_data, nullptr, a_pair, a_desc);
+    }
+
     void UIProfileEditorPhysics::OnComponentUpdate(
         int,
         PhysicsProfile::base_type::config_type& a_data,
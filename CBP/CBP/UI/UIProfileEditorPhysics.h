@@ -51,6 +51,12 @@ namespace CBP
             PhysicsProfile::base_type::value_type&,
             const componentValueDescMap_t::vec_value_type&) override;
 
+        virtual void OnIntegratorChange(
+            int,
+            PhysicsProfile::base_type::config_type&,
+            PhysicsProfile::base_type::value_type&,
+            const componentValueDescMap_t::vec_value_type&) override;
+
         virtual void OnComponentUpdate(
             int,
             PhysicsProfile::base_type::config_type& a_data,
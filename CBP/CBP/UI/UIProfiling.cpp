@@ -5,6 +5,7 @@
 #include "CBP/Profiling.h"
 #include "CBP/Renderer.h"
 #include "CBP/BoneCast.h"
+#include "CBP/SimObject.h"
 
 #include "Drivers/cbp.h"
 #include "Drivers/gui.h"
@@ -18,7 +19,15 @@ namespace CBP
         m_plotUpdateTime("Time/frame", ImVec2(0, 30.0f), false, 200),
         m_plotFramerate("Timer", ImVec2(0, 30.0f), false, 200),
         m_lastVMIUpdate(IPerfCounter::Query() - 1000000LL),
-        m_chKey("Stats#Settings")
+        m_chKey("Stats#Settings"),
+        m_chKeyRec("Stats#Recorder"),
+        m_chKeyLOD("Stats#LOD"),
+        m_chKeyBench("Stats#Bench"),
+        m_hasRotBench(false),
+        m_hasCullTest(false),
+        m_hasConBench(false),
+        m_hasNpTest(false),
+        m_hasDispatchBench(false)
     {
     }
 
@@ -67,6 +76,26 @@ namespace CBP
                 ImGui::TextWrapped("Timer:");
                 HelpMarker(MiscHelpText::frameTimer);
                 ImGui::TextWrapped("Actors:");
+                ImGui::TextWrapped("Motion:");
+                HelpMarker(MiscHelpText::motionTime);
+                ImGui::TextWrapped("Sleeping:");
+
+                bool showIslands(globalConfig.phys.collision && globalConfig.phys.collisionIslands);
+
+                if (showIslands)
+                    ImGui::TextWrapped("Islands:");
+
+                if (globalConfig.phys.collision)
+                {
+                    for (std::uint32_t i = 0; i < Profiler::NUM_BROADPHASES; i++)
+                        ImGui::TextWrapped("%s:", TranslateBroadphaseType(static_cast<BroadphaseType>(i + 1)));
+
+                    ImGui::TextWrapped("Manifolds:");
+                    HelpMarker(MiscHelpText::poolStats);
+                    ImGui::TextWrapped("Manifold pool:");
+                    ImGui::TextWrapped("Algorithm pool:");
+                }
+
                 ImGui::TextWrapped("UI:");
 
                 if (drEnabled)
@@ -76,6 +105,11 @@ namespace CBP
                 }
 
                 ImGui::TextWrapped("BoneCast cache:");
+                ImGui::TextWrapped("BoneCast lookups:");
+                ImGui::TextWrapped("BoneCast evictions:");
+                ImGui::TextWrapped("BoneCast shared:");
+                ImGui::TextWrapped("Impulse slots:");
+                ImGui::TextWrapped("Impulses dropped:");
                 ImGui::Spacing();
 
 #if defined(SKMP_MEMDBG)
@@ -99,6 +133,63 @@ namespace CBP
                     ? stats.avgStepRate / stats.avgStepsPerUpdate : 0.0);
                 ImGui::TextWrapped("%.4f", stats.avgFrameTime);
                 ImGui::TextWrapped("%u", stats.avgActorCount);
+                ImGui::TextWrapped("%lld \xC2\xB5s (%.1f ns/node)", stats.avgMotionTime, stats.avgComponentStepTime);
+                ImGui::TextWrapped("%u (%.2f/%.2f sleep/wake per frame)", stats.avgSleeping, stats.avgSleepsPerFrame, stats.avgWakesPerFrame);
+
+                if (showIslands)
+                {
+                    std::uint32_t numIslands, numShared;
+                    ICollision::GetIslandStats(numIslands, numShared);
+
+                    ImGui::TextWrapped("%u (%u shared)", numIslands, numShared);
+                }
+
+                if (globalConfig.phys.collision)
+                {
+                    auto active = static_cast<std::uint32_t>(ICollision::GetBroadphaseType()) - 1;
+
+                    for (std::uint32_t i = 0; i < Profiler::NUM_BROADPHASES; i++)
+                    {
+                        auto time = stats.avgBroadphaseTime[i];
+
+                        if (time < 0.0)
+                            ImGui::TextWrapped("-");
+                        else if (i != active)
+                            ImGui::TextWrapped("%.1f \xC2\xB5s/step", time);
+                        else if (ICollision::GetBroadphaseType() == BroadphaseType::SpatialHash)
+                            ImGui::TextWrapped("%.1f \xC2\xB5s/step (active, cell %.1f)", time, ICollision::GetBroadphaseCellSize());
+                        else
+                            ImGui::TextWrapped("%.1f \xC2\xB5s/step (active)", time);
+                    }
+
+                    poolStats_t poolStats;
+                    ICollision::GetPoolStats(poolStats);
+
+                    ImGui::TextWrapped("%.1f/frame (%u resizes)", stats.avgManifolds, poolStats.numResizes);
+
+                    bool mWarn(poolStats.manifoldOverflows > 0);
+
+                    if (mWarn)
+                        ImGui::PushStyleColor(ImGuiCol_Text, s_colorWarning);
+
+                    ImGui::TextWrapped("%u/%u (peak %u, overflows %u)",
+                        poolStats.manifoldsUsed, poolStats.manifoldPoolSize, poolStats.manifoldPeak, poolStats.manifoldOverflows);
+
+                    if (mWarn)
+                        ImGui::PopStyleColor();
+
+                    bool aWarn(poolStats.algorithmOverflows > 0);
+
+                    if (aWarn)
+                        ImGui::PushStyleColor(ImGuiCol_Text, s_colorWarning);
+
+                    ImGui::TextWrapped("%u/%u (peak %u, overflows %u)",
+                        poolStats.algorithmsUsed, poolStats.algorithmPoolSize, poolStats.algorithmPeak, poolStats.algorithmOverflows);
+
+                    if (aWarn)
+                        ImGui::PopStyleColor();
+                }
+
                 ImGui::TextWrapped("%lld \xC2\xB5s", DUI::GetPerf());
 
                 if (drEnabled)
@@ -107,7 +198,35 @@ namespace CBP
                     ImGui::TextWrapped("%lld \xC2\xB5s", dr->GetDrawTime());
                 }
 
-                ImGui::TextWrapped("%zu kb", IBoneCast::GetCacheSize() / std::size_t(1024));
+                if (IBoneCast::IsAsync())
+                    ImGui::TextWrapped("%zu kb, %zu entries (%zu pending)",
+                        IBoneCast::GetCacheSize() / std::size_t(1024), IBoneCast::GetCacheEntries(), IBoneCast::GetNumPending());
+                else
+                    ImGui::TextWrapped("%zu kb, %zu entries",
+                        IBoneCast::GetCacheSize() / std::size_t(1024), IBoneCast::GetCacheEntries());
+
+                auto& bcStats = IBoneCast::GetCacheStats();
+
+                ImGui::TextWrapped("%llu hits, %llu misses", bcStats.hits, bcStats.misses);
+                ImGui::TextWrapped("%llu (%llu kb)", bcStats.evictions, bcStats.evictedBytes / std::uint64_t(1024));
+
+                auto bcContent = IBoneCast::GetContentStats();
+
+                ImGui::TextWrapped("%llu vertex, %llu processed (%zu hashes)",
+                    bcContent.sharedVertices, bcContent.sharedProcessed, bcContent.numEntries);
+
+                ImGui::TextWrapped("%zu (%u each)", IImpulseBuffer::GetNumSlots(), IImpulseBuffer::GetSlotCapacity());
+
+                auto numDropped = IImpulseBuffer::GetNumDropped();
+
+                if (numDropped)
+                    ImGui::PushStyleColor(ImGuiCol_Text, s_colorWarning);
+
+                ImGui::TextWrapped("%llu", numDropped);
+
+                if (numDropped)
+                    ImGui::PopStyleColor();
+
                 ImGui::Spacing();
 
 #if defined(SKMP_MEMDBG)
@@ -191,6 +310,358 @@ namespace CBP
 
                 ImGui::PopItemWidth();
             }
+
+            if (CollapsingHeader(m_chKeyRec, "Recorder"))
+            {
+                auto& recorder = DCBP::GetRecorder();
+                auto& replay = DCBP::GetReplayStatus();
+
+                if (recorder.IsRecording())
+                {
+                    if (ImGui::Button("Stop"))
+                        DCBP::StopRecording();
+
+                    ImGui::SameLine();
+                    ImGui::Text("%zu/%zu frames", recorder.GetNumFrames(), SimRecorder::MAX_FRAMES);
+                }
+                else
+                {
+                    if (ImGui::Button("Record"))
+                        DCBP::StartRecording();
+
+                    ImGui::SameLine();
+
+                    if (replay.running)
+                        ImGui::TextWrapped("Replaying, the game is paused until it finishes..");
+                    else if (ImGui::Button("Replay"))
+                        DCBP::ReplayRecording();
+                }
+
+                HelpMarker(MiscHelpText::simRecorder);
+
+                if (!replay.message.empty())
+                    ImGui::TextWrapped("%s", replay.message.c_str());
+
+                if (replay.hasResult)
+                {
+                    auto& result = replay.result;
+
+                    ImGui::Spacing();
+                    ImGui::Columns(2, nullptr, false);
+
+                    ImGui::TextWrapped("Frames:");
+                    ImGui::TextWrapped("Read:");
+                    ImGui::TextWrapped("Motion:");
+                    ImGui::TextWrapped("Collisions:");
+                    ImGui::TextWrapped("Mismatches:");
+                    if (result.orderChecked)
+                        ImGui::TextWrapped("Serial order:");
+
+                    ImGui::NextColumn();
+
+                    ImGui::TextWrapped("%u (%u steps)", result.numFrames, result.numSteps);
+                    ImGui::TextWrapped("%lld \xC2\xB5s", result.readTime);
+                    ImGui::TextWrapped("%lld \xC2\xB5s", result.motionTime);
+                    ImGui::TextWrapped("%lld \xC2\xB5s", result.collisionTime);
+                    ImGui::TextWrapped("%u/%u (%g)", result.numStateMismatches, result.numComponents, result.maxStateError);
+                    if (result.orderChecked)
+                    {
+                        if (result.orderPassed)
+                            ImGui::TextWrapped("Passed");
+                        else
+                        {
+                            ImGui::PushStyleColor(ImGuiCol_Text, s_colorWarning);
+                            ImGui::TextWrapped("FAILED %u/%u (%g)", result.numOrderMismatches, result.numComponents, result.maxOrderError);
+                            ImGui::PopStyleColor();
+                        }
+                    }
+
+                    ImGui::Columns(1);
+
+                    if (result.numConfigMismatches)
+                    {
+                        ImGui::PushStyleColor(ImGuiCol_Text, s_colorWarning);
+                        ImGui::TextWrapped("WARNING: %u node(s) have a different config than recorded", result.numConfigMismatches);
+                        ImGui::PopStyleColor();
+                    }
+                }
+            }
+
+            if (CollapsingHeader(m_chKeyLOD, "Level of detail"))
+            {
+                auto& lodConf = globalConfig.lod;
+
+                if (lodConf.enabled)
+                {
+                    ImGui::TextWrapped("Bands: %.0f / %.0f / %.0f%s",
+                        lodConf.distance[0], lodConf.distance[1], lodConf.distance[2],
+                        lodConf.farCollisions ? "" : " (no collisions)");
+                }
+                else
+                {
+                    ImGui::TextWrapped("Disabled");
+                }
+
+                HelpMarker(MiscHelpText::simLOD);
+
+                auto& actors = DCBP::GetSimActorList();
+
+                std::uint32_t counts[4]{ 0 };
+
+                for (auto e : actors.getvec())
+                {
+                    if (!e->IsSuspended())
+                        counts[std::min(e->GetLOD(), 3U)]++;
+                }
+
+                ImGui::TextWrapped("Full: %u, 1/2: %u, 1/4: %u, 1/8: %u",
+                    counts[0], counts[1], counts[2], counts[3]);
+
+                if (globalConfig.culling.enabled)
+                {
+                    std::uint32_t offscreen(0), frozen(0);
+
+                    for (auto e : actors.getvec())
+                    {
+                        if (e->IsSuspended() || e->IsVisible())
+                            continue;
+
+                        offscreen++;
+
+                        if (e->IsFrozen())
+                            frozen++;
+                    }
+
+                    ImGui::TextWrapped("Off-screen: %u (%u frozen)", offscreen, frozen);
+                }
+
+                ImGui::Spacing();
+
+                ImGui::Columns(3, nullptr, false);
+
+                ImGui::TextWrapped("Actor");
+                ImGui::NextColumn();
+                ImGui::TextWrapped("Distance");
+                ImGui::NextColumn();
+                ImGui::TextWrapped("Rate");
+                ImGui::NextColumn();
+
+                ImGui::Separator();
+
+                for (auto e : actors.getvec())
+                {
+                    if (e->IsSuspended())
+                        continue;
+
+                    auto actor = e->GetActor();
+
+                    ImGui::TextWrapped("%s", actor ? actor->GetReferenceName() : "");
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("%.0f", e->GetLODDistance());
+                    ImGui::NextColumn();
+                    if (e->IsFrozen())
+                        ImGui::TextWrapped("Frozen");
+                    else if (auto lod = e->GetLOD(); lod > 0)
+                        ImGui::TextWrapped("1/%u", 1U << lod);
+                    else
+                        ImGui::TextWrapped("Full");
+                    ImGui::NextColumn();
+                }
+
+                ImGui::Columns(1);
+            }
+
+            if (CollapsingHeader(m_chKeyBench, "Benchmarks"))
+            {
+                if (ImGui::Button("Rotation"))
+                {
+                    Rotation::RunBenchmark(100000, m_rotBench);
+                    m_hasRotBench = true;
+                }
+
+                HelpMarker(MiscHelpText::rotationBenchmark);
+
+                if (m_hasRotBench)
+                {
+                    ImGui::Spacing();
+                    ImGui::Columns(2, nullptr, false);
+
+                    ImGui::TextWrapped("Matrix:");
+                    ImGui::TextWrapped("Quaternion:");
+                    ImGui::TextWrapped("Quaternion (SIMD):");
+
+                    ImGui::NextColumn();
+
+                    ImGui::TextWrapped("%lld \xC2\xB5s", m_rotBench.matrixTime);
+                    ImGui::TextWrapped("%lld \xC2\xB5s", m_rotBench.quatTime);
+                    ImGui::TextWrapped("%lld \xC2\xB5s", m_rotBench.quatSIMDTime);
+
+                    ImGui::Columns(1);
+
+                    ImGui::TextWrapped("%u rotations", m_rotBench.count);
+                }
+
+                ImGui::Spacing();
+
+                if (ImGui::Button("Frustum culling"))
+                {
+                    Culling::RunSelfTest(100000, m_cullTest);
+                    m_hasCullTest = true;
+                }
+
+                HelpMarker(MiscHelpText::cullingTest);
+
+                if (m_hasCullTest)
+                {
+                    ImGui::Spacing();
+                    ImGui::Columns(2, nullptr, false);
+
+                    ImGui::TextWrapped("Scalar:");
+                    ImGui::TextWrapped("SIMD:");
+                    ImGui::TextWrapped("Mismatches:");
+                    ImGui::TextWrapped("Projection:");
+
+                    ImGui::NextColumn();
+
+                    ImGui::TextWrapped("%lld \xC2\xB5s", m_cullTest.scalarTime);
+                    ImGui::TextWrapped("%lld \xC2\xB5s", m_cullTest.simdTime);
+                    ImGui::TextWrapped("%u", m_cullTest.numMismatches);
+                    ImGui::TextWrapped("%u", m_cullTest.numPointMismatches);
+
+                    ImGui::Columns(1);
+
+                    ImGui::TextWrapped("%u spheres, %u frusta, %u visible",
+                        m_cullTest.numSpheres, m_cullTest.numFrusta, m_cullTest.numVisible);
+                }
+
+                ImGui::Spacing();
+
+                if (ImGui::Button("Motion constraints"))
+                {
+                    Constraints::RunBenchmark(100000, m_conBench);
+                    m_hasConBench = true;
+                }
+
+                HelpMarker(MiscHelpText::constraintBenchmark);
+
+                if (m_hasConBench)
+                {
+                    ImGui::Spacing();
+                    ImGui::Columns(3, nullptr, false);
+
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("Settled");
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("Noisy");
+                    ImGui::NextColumn();
+
+                    ImGui::TextWrapped("Branching:");
+                    ImGui::TextWrapped("Masked:");
+                    ImGui::TextWrapped("Batched:");
+                    ImGui::TextWrapped("Violations:");
+                    ImGui::TextWrapped("Max error:");
+
+                    for (int i = 0; i < 2; i++)
+                    {
+                        ImGui::NextColumn();
+
+                        ImGui::TextWrapped("%lld \xC2\xB5s", m_conBench.branchTime[i]);
+                        ImGui::TextWrapped("%lld \xC2\xB5s", m_conBench.maskedTime[i]);
+                        ImGui::TextWrapped("%lld \xC2\xB5s", m_conBench.batchedTime[i]);
+                        ImGui::TextWrapped("%u", m_conBench.numViolations[i]);
+                        ImGui::TextWrapped("%.6f", m_conBench.maxError[i]);
+                    }
+
+                    ImGui::Columns(1);
+
+                    ImGui::TextWrapped("%u nodes", m_conBench.count);
+                }
+
+                ImGui::Spacing();
+
+                if (ImGui::Button("Narrowphase"))
+                {
+                    Narrowphase::RunSelfTest(20000, m_npTest);
+                    m_hasNpTest = true;
+                }
+
+                HelpMarker(MiscHelpText::narrowphaseTest);
+
+                if (m_hasNpTest)
+                {
+                    ImGui::Spacing();
+                    ImGui::Columns(2, nullptr, false);
+
+                    ImGui::TextWrapped("Native:");
+                    ImGui::TextWrapped("Bullet:");
+                    ImGui::TextWrapped("Mismatches:");
+                    ImGui::TextWrapped("Depth error:");
+                    ImGui::TextWrapped("Normal error:");
+
+                    ImGui::NextColumn();
+
+                    ImGui::TextWrapped("%lld \xC2\xB5s (%u contacts)", m_npTest.nativeTime, m_npTest.numContacts);
+                    ImGui::TextWrapped("%lld \xC2\xB5s (%u contacts)", m_npTest.bulletTime, m_npTest.numBulletContacts);
+                    ImGui::TextWrapped("%u", m_npTest.numMismatches);
+                    ImGui::TextWrapped("%.4f", m_npTest.maxDepthError);
+                    ImGui::TextWrapped("%.6f", m_npTest.maxNormalError);
+
+                    ImGui::Columns(1);
+
+                    ImGui::TextWrapped("%u pairs", m_npTest.numPairs);
+                }
+
+                ImGui::Spacing();
+
+                if (ImGui::Button("Collision dispatch"))
+                {
+                    ICollision::RunDispatchBenchmark(m_dispatchBench);
+                    m_hasDispatchBench = true;
+                }
+
+                HelpMarker(MiscHelpText::dispatchBenchmark);
+
+                if (m_hasDispatchBench)
+                {
+                    ImGui::Spacing();
+                    ImGui::Columns(5, nullptr, false);
+
+                    ImGui::TextWrapped("Actors");
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("Colliders");
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("Pairs");
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("Serial");
+                    ImGui::NextColumn();
+                    ImGui::TextWrapped("MT");
+                    ImGui::NextColumn();
+
+                    for (auto& e : m_dispatchBench.runs)
+                    {
+                        ImGui::TextWrapped("%u", e.numActors);
+                        ImGui::NextColumn();
+                        ImGui::TextWrapped("%u", e.numObjects);
+                        ImGui::NextColumn();
+                        ImGui::TextWrapped("%u", e.numPairs);
+                        ImGui::NextColumn();
+                        ImGui::TextWrapped("%lld \xC2\xB5s", e.serialTime);
+                        ImGui::NextColumn();
+
+                        if (m_dispatchBench.mt)
+                            ImGui::TextWrapped("%lld \xC2\xB5s", e.mtTime);
+                        else
+                            ImGui::TextWrapped("n/a");
+
+                        ImGui::NextColumn();
+                    }
+
+                    ImGui::Columns(1);
+
+                    ImGui::TextWrapped("Per step, %u steps, %u thread(s)",
+                        m_dispatchBench.numSteps, m_dispatchBench.numThreads);
+                }
+            }
         }
 
         ImGui::End();
@@ -3,6 +3,12 @@
 #include "Common/Base.h"
 #include "Common/Plot.h"
 
+#include "CBP/Rotation.h"
+#include "CBP/Culling.h"
+#include "CBP/Constraints.h"
+#include "CBP/Narrowphase.h"
+#include "CBP/Collision.h"
+
 namespace CBP
 {
     class UIContext;
@@ -27,6 +33,24 @@ namespace CBP
         long long m_lastVMIUpdate;
 
         stl::fixed_string m_chKey;
+        stl::fixed_string m_chKeyRec;
+        stl::fixed_string m_chKeyLOD;
+        stl::fixed_string m_chKeyBench;
+
+        Rotation::benchmarkResult_t m_rotBench;
+        bool m_hasRotBench;
+
+        Culling::selfTestResult_t m_cullTest;
+        bool m_hasCullTest;
+
+        Constraints::benchmarkResult_t m_conBench;
+        bool m_hasConBench;
+
+        Narrowphase::selfTestResult_t m_npTest;
+        bool m_hasNpTest;
+
+        dispatchBenchmarkResult_t m_dispatchBench;
+        bool m_hasDispatchBench;
     };
 
 
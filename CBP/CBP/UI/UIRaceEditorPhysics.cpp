@@ -234,6 +234,24 @@ namespace CBP
         DCBP::UpdateConfigOnAllActors();
     }
 
+    void UIRaceEditorPhysics::OnIntegratorChange(
+        Game::FormID a_formid,
+        configComponents_t& a_data,
+        configComponentsValue_t& a_pair,
+        const componentValueDescMap_t::vec_value_type& a_desc)
+    {
+        const auto& globalConfig = IConfig::GetGlobal();
+        auto& raceConf = IConfig::GetOrCreateRacePhysics(a_formid, globalConfig.ui.commonSettings.physics.race.selectedGender);
+        auto& entry = raceConf[a_pair.first];
+
+        entry.ex.integrator = a_pair.second.ex.integrator;
+
+        DoIntegratorOnChangePropagation(a_data, std::addressof(raceConf), a_pair, a_desc);
+
+        MarkChanged();
+        DCBP::UpdateConfigOnAllActors();
+    }
+
     void UIRaceEditorPhysics::OnComponentUpdate(
         Game::FormID a_formid,
         configComponents_t& a_data,
@@ -52,6 +52,13 @@ namespace CBP
             const componentValueDescMap_t::vec_value_type& a_desc
         ) override;
 
+        virtual void OnIntegratorChange(
+            Game::FormID a_handle,
+            configComponents_t& a_data,
+            configComponentsValue_t& a_pair,
+            const componentValueDescMap_t::vec_value_type& a_desc
+        ) override;
+
         virtual void OnComponentUpdate(
             Game::FormID a_formid,
             configComponents_t& a_data,
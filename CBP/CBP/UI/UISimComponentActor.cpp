@@ -103,6 +103,25 @@ namespace CBP
             a_handle, ControllerInstruction::Action::UpdateConfig);
     }
 
+    void UISimComponentActor::OnIntegratorChange(
+        Game::VMHandle a_handle,
+        configComponents_t& a_data,
+        configComponentsValue_t& a_pair,
+        const componentValueDescMap_t::vec_value_type& a_desc)
+    {
+        const auto& globalConfig = IConfig::GetGlobal();
+
+        auto& actorConf = IConfig::GetOrCreateActorPhysics(a_handle, globalConfig.ui.commonSettings.physics.actor.selectedGender);
+        auto& entry = actorConf[a_pair.first];
+
+        entry.ex.integrator = a_pair.second.ex.integrator;
+
+        DoIntegratorOnChangePropagation(a_data, std::addressof(actorConf), a_pair, a_desc);
+
+        DCBP::DispatchActorTask(
+            a_handle, ControllerInstruction::Action::UpdateConfig);
+    }
+
     void UISimComponentActor::OnComponentUpdate(
         Game::VMHandle a_handle,
         configComponents_t& a_data,
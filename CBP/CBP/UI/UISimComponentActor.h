@@ -40,6 +40,12 @@ namespace CBP
             configComponentsValue_t& a_pair,
             const componentValueDescMap_t::vec_value_type& a_desc) override;
 
+        virtual void OnIntegratorChange(
+            Game::VMHandle a_handle,
+            configComponents_t& a_data,
+            configComponentsValue_t& a_pair,
+            const componentValueDescMap_t::vec_value_type& a_desc) override;
+
         virtual void OnComponentUpdate(
             Game::VMHandle a_handle,
             configComponents_t& a_data,
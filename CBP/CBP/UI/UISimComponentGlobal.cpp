@@ -100,6 +100,24 @@ namespace CBP
         DCBP::UpdateConfigOnAllActors();
     }
 
+    void UISimComponentGlobal::OnIntegratorChange(
+        Game::VMHandle a_handle,
+        configComponents_t& a_data,
+        configComponentsValue_t& a_pair,
+        const componentValueDescMap_t::vec_value_type& a_desc)
+    {
+        const auto& globalConfig = IConfig::GetGlobal();
+
+        auto& conf = IConfig::GetGlobalPhysics()(globalConfig.ui.commonSettings.physics.global.selectedGender);
+        auto& entry = conf[a_pair.first];
+
+        entry.ex.integrator = a_pair.second.ex.integrator;
+
+        DoIntegratorOnChangePropagation(a_data, std::addressof(conf), a_pair, a_desc);
+
+        DCBP::UpdateConfigOnAllActors();
+    }
+
     void UISimComponentGlobal::OnComponentUpdate(
         Game::VMHandle,
         configComponents_t& a_data,
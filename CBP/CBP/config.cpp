@@ -106,6 +106,55 @@ namespace CBP
         }
     }
 
+    float configComponent_t::GetStableTimeStep() const
+    {
+        auto& f = fp.f32;
+
+        if (ex.integrator == IntegratorType::Implicit)
+            return std::numeric_limits<float>::infinity();
+
+        // linearize the quadratic term at the largest allowed displacement
+        float maxDisp(f.maxOffsetSphereRadius);
+
+        for (int i = 0; i < 3; i++)
+            maxDisp = std::max(maxDisp, std::max(f.maxOffsetP[i], -f.maxOffsetN[i]));
+
+        float k = std::clamp(f.stiffness, 0.0f, 20000.0f) +
+            2.0f * std::clamp(f.stiffness2, 0.0f, 20000.0f) * maxDisp;
+
+        float w2 = k / std::clamp(f.mass, 0.001f, 10000.0f);
+        float c = std::max(f.damping, 0.0f);
+
+        switch (ex.integrator)
+        {
+        case IntegratorType::Legacy:
+        {
+            // explicit damping, resistance can scale it up to (1 + resistance)
+            c *= 1.0f + std::clamp(f.resistance, 0.0f, 250.0f);
+
+            float r = c > _EPSILON ? 2.0f / c : std::numeric_limits<float>::infinity();
+
+            if (w2 <= _EPSILON)
+                return r;
+
+            return std::min(r, (std::sqrtf(c * c + 4.0f * w2) - c) / w2);
+        }
+        case IntegratorType::SemiImplicit:
+
+            if (w2 <= _EPSILON)
+                return std::numeric_limits<float>::infinity();
+
+            return (std::sqrtf(c * c + 4.0f * w2) + c) / w2;
+
+        default:
+
+            if (w2 <= _EPSILON)
+                return std::numeric_limits<float>::infinity();
+
+            return 2.0f / std::sqrtf(w2);
+        }
+    }
+
     bool IConfig::LoadNodeMap(nodeMap_t& a_out)
     {
         try
@@ -57,6 +57,14 @@ namespace CBP
     typedef stl::unordered_map_simd<stl::fixed_string, configForce_t> configForceMap_t;
     typedef std::unordered_map<stl::fixed_string, bool> collapsibleStates_t;
 
+    enum class BroadphaseType : std::uint32_t
+    {
+        Auto = 0,
+        Dbvt = 1,
+        SweepAndPrune = 2,
+        SpatialHash = 3
+    };
+
     struct configGlobalRace_t
     {
         bool playableOnly{ true };
@@ -124,9 +132,43 @@ namespace CBP
             float timeTick{ 1.0f / 60.0f };
             float maxSubSteps{ 10.0f };
             float maxDiff{ 360.0f };
+            bool fixedRate{ false };
             bool collision{ true };
+            bool nativeNarrowphase{ true };
+            bool collisionIslands{ false };
+            BroadphaseType broadphase{ BroadphaseType::Dbvt };
+            bool poolAutoGrow{ true };
+            float broadphaseCellSize{ 0.0f };
+            int parallelResponseMin{ 1024 };
+            bool mtDispatch{ true };
+            int mtDispatchThreads{ 0 };
+            int mtDispatchMinPairs{ 256 };
+            bool batchedMotion{ false };
+            bool adaptiveSubSteps{ false };
+            float adaptiveVelocity{ 200.0f };
+            float adaptiveViolation{ 2.0f };
+            int subStepBudget{ 0 };
+            bool sleep{ false };
+            float sleepVelocity{ 1.0f };
+            int sleepSteps{ 30 };
+            float wakeDistance{ 0.5f };
         } phys;
 
+        struct
+        {
+            bool enabled{ false };
+            float distance[3]{ 1500.0f, 3000.0f, 5000.0f };
+            bool farCollisions{ false };
+        } lod;
+
+        struct
+        {
+            bool enabled{ false };
+            bool freeze{ false };
+            int offscreenLOD{ 2 };
+            float margin{ 50.0f };
+        } culling;
+
         struct SKMP_ALIGN(16)
         {
             bool lockControls{ true };
@@ -307,6 +349,14 @@ namespace CBP
 
     DEFINE_ENUM_CLASS_BITWISE(MotionConstraints);
 
+    enum class IntegratorType : std::uint32_t
+    {
+        Legacy = 0,
+        SemiImplicit = 1,
+        Verlet = 2,
+        Implicit = 3
+    };
+
     enum class ComponentConfigSection
     {
         kPhysics,
@@ -342,6 +392,7 @@ namespace CBP
 
     typedef KVStorage<stl::fixed_string, const componentValueDesc_t> componentValueDescMap_t;
     typedef KVStorage<ColliderShapeType, const colliderDesc_t> colliderDescMap_t;
+    typedef KVStorage<IntegratorType, const colliderDesc_t> integratorDescMap_t;
 
     template <class T>
     struct infoValueAddr_t
@@ -668,13 +719,15 @@ namespace CBP
     {
         SKMP_FORCEINLINE physicsDataExtra_t() :
             colShape(ColliderShapeType::Sphere),
-            motionConstraints(MotionConstraints::Box)
+            motionConstraints(MotionConstraints::Box),
+            integrator(IntegratorType::Legacy)
         {
         }
 
         SKMP_FORCEINLINE physicsDataExtra_t(const physicsDataExtra_t& a_rhs) :
             colShape(a_rhs.colShape),
             motionConstraints(a_rhs.motionConstraints),
+            integrator(a_rhs.integrator),
             colMesh(a_rhs.colMesh)
         {
         }
@@ -682,6 +735,7 @@ namespace CBP
         SKMP_FORCEINLINE physicsDataExtra_t(physicsDataExtra_t&& a_rhs) :
             colShape(a_rhs.colShape),
             motionConstraints(a_rhs.motionConstraints),
+            integrator(a_rhs.integrator),
             colMesh(std::move(a_rhs.colMesh))
         {
         }
@@ -690,6 +744,7 @@ namespace CBP
         {
             colShape = a_rhs.colShape;
             motionConstraints = a_rhs.motionConstraints;
+            integrator = a_rhs.integrator;
             colMesh = a_rhs.colMesh;
 
             return *this;
@@ -699,6 +754,7 @@ namespace CBP
         {
             colShape = a_rhs.colShape;
             motionConstraints = a_rhs.motionConstraints;
+            integrator = a_rhs.integrator;
             colMesh = std::move(a_rhs.colMesh);
 
             return *this;
@@ -706,6 +762,7 @@ namespace CBP
 
         ColliderShapeType colShape;
         MotionConstraints motionConstraints;
+        IntegratorType integrator;
         stl::fixed_string colMesh;
     };
 
@@ -727,7 +784,8 @@ namespace CBP
             DataVersion7 = 7,
             DataVersion8 = 8,
             DataVersion9 = 9,
-            DataVersion10 = 10
+            DataVersion10 = 10,
+            DataVersion11 = 11
         };
 
         template <class T>
@@ -762,6 +820,9 @@ namespace CBP
             case ConfigValueType::kMotionConstraint:
                 a_value = Enum::Underlying(*GetAddress<MotionConstraints>(a_info));
                 break;
+            case ConfigValueType::kIntegrator:
+                a_value = Enum::Underlying(*GetAddress<IntegratorType>(a_info));
+                break;
             default:
                 ASSERT_STR(false, "FIXME");
             }
@@ -811,6 +872,17 @@ namespace CBP
                 case ConfigValueType::kMotionConstraint:
                     *GetAddress<MotionConstraints>(a_info) = static_cast<MotionConstraints>(a_value.asUInt());
                     break;
+                case ConfigValueType::kIntegrator:
+                {
+                    std::uint32_t t = a_value.asUInt();
+
+                    if (!IsValidIntegrator(t))
+                        return false;
+
+                    *GetAddress<IntegratorType>(a_info) = static_cast<IntegratorType>(t);
+
+                    break;
+                }
                 default:
                     ASSERT_STR(false, "FIXME");
                 }
@@ -929,6 +1001,9 @@ namespace CBP
             ex.colShape = a_shape;
         }
 
+        // largest time step the selected integrator stays stable at, +inf if unconditionally stable
+        [[nodiscard]] float GetStableTimeStep() const;
+
         configComponent_t() = default;
 
         physicsData_t fp;
@@ -936,6 +1011,7 @@ namespace CBP
 
         static const componentValueDescMap_t descMap;
         static const colliderDescMap_t colDescMap;
+        static const integratorDescMap_t integratorDescMap;
         static const addrInfoMap_t<ComponentConfigSection> addrInfoMap;
         static const std::unordered_map<stl::fixed_string, stl::fixed_string> oldKeyMap;
 
@@ -991,6 +1067,11 @@ namespace CBP
                 if (a_desc.type == ConfigValueType::kColliderShape)
                     return true;
             }
+            else if constexpr (std::is_same_v<T, IntegratorType>)
+            {
+                if (a_desc.type == ConfigValueType::kIntegrator)
+                    return true;
+            }
 
             return false;
         }
@@ -1013,6 +1094,20 @@ namespace CBP
             return false;
         }
 
+        [[nodiscard]] SKMP_FORCEINLINE static bool IsValidIntegrator(std::uint32_t a_type)
+        {
+            switch (a_type)
+            {
+            case Enum::Underlying(IntegratorType::Legacy):
+            case Enum::Underlying(IntegratorType::SemiImplicit):
+            case Enum::Underlying(IntegratorType::Verlet):
+            case Enum::Underlying(IntegratorType::Implicit):
+                return true;
+            }
+
+            return false;
+        }
+
         template<class Archive>
         void save(Archive& ar, const unsigned int version) const
         {
@@ -1064,6 +1159,8 @@ namespace CBP
 
             ar& fp.f32.maxOffsetParamsSphere[3];
             ar& fp.f32.maxOffsetParamsBox;
+
+            ar& ex.integrator;
         }
 
         template<class Archive>
@@ -1138,6 +1235,11 @@ namespace CBP
                                             {
                                                 ar& fp.f32.maxOffsetParamsSphere[3];
                                                 ar& fp.f32.maxOffsetParamsBox;
+
+                                                if (version >= DataVersion11)
+                                                {
+                                                    ar& ex.integrator;
+                                                }
                                             }
                                         }
                                     }
@@ -2149,7 +2251,7 @@ namespace CBP
     };
 }
 
-BOOST_CLASS_VERSION(CBP::configComponent_t, CBP::configComponent_t::Serialization::DataVersion10)
+BOOST_CLASS_VERSION(CBP::configComponent_t, CBP::configComponent_t::Serialization::DataVersion11)
 BOOST_CLASS_VERSION(CBP::configNode_t, CBP::configNode_t::Serialization::DataVersion7)
 BOOST_CLASS_VERSION(CBP::configGenderRoot_t<CBP::configComponents_t>, CBP::configGenderRoot_t< CBP::configComponents_t>::Serialization::DataVersion1)
 BOOST_CLASS_VERSION(CBP::configGenderRoot_t<CBP::configNodes_t>, CBP::configGenderRoot_t< CBP::configNodes_t>::Serialization::DataVersion1)
@@ -9,6 +9,8 @@
 #include "CBP/Papyrus.h"
 #include "CBP/Template.h"
 #include "CBP/BoneCast.h"
+#include "CBP/ThreadPool.h"
+#include "CBP/ImpulseBuffer.h"
 #include "CBP/UI/UI.h"
 #include "CBP/StringHolder.h"
 
@@ -44,6 +46,11 @@ namespace CBP
     constexpr const char* CKEY_TPOFFLOAD = "TaskpoolOffload";
     constexpr const char* CKEY_MTDISPATCHER = "MultiThreadedCollisionDetection";
     constexpr const char* CKEY_MTMOTION = "MultiThreadedMotionUpdates";
+    constexpr const char* CKEY_MTMOTIONMINACTORS = "MultiThreadedMotionMinActors";
+    constexpr const char* CKEY_MOTIONTHREADS = "MotionThreads";
+    constexpr const char* CKEY_BONECASTTHREADS = "BoneCastThreads";
+    constexpr const char* CKEY_BONECASTCODEC = "BoneCastCodec";
+    constexpr const char* CKEY_IMPULSEQUEUESIZE = "ImpulseQueueSize";
     constexpr const char* CKEY_RELCBTHRESH = "UseRelativeContactBreakingThreshold";
 
     constexpr const char* CKEY_BTEPA = "UseEpaPenetrationAlgorithm";
@@ -124,7 +131,7 @@ namespace CBP
         SetDebugRendererEnabled(globalConf.debugRenderer.enabled);
     }
 
-    const auto& DCBP::GetSimActorList() {
+    const simActorList_t& DCBP::GetSimActorList() {
         return m_Instance.m_controller->GetSimActorList();
     }
 
@@ -198,6 +205,167 @@ namespace CBP
             });
     }
 
+    void DCBP::ApplyForces(std::vector<CBP::impulseRequest_t>&& a_requests)
+    {
+        if (a_requests.empty())
+            return;
+
+        ITaskPool::AddTask([r = std::move(a_requests)]()
+            {
+                IScopedLock _(GetLock());
+
+                GetController()->ApplyForces(r);
+            });
+    }
+
+    const CBP::SimRecorder& DCBP::GetRecorder()
+    {
+        return m_Instance.m_controller->GetRecorder();
+    }
+
+    void DCBP::StartRecording()
+    {
+        m_Instance.m_replay.message.clear();
+
+        GetController()->StartRecording();
+    }
+
+    void DCBP::StopRecording()
+    {
+        std::shared_ptr<CBP::SimRecording> recording = GetController()->StopRecording();
+        if (!recording)
+        {
+            m_Instance.m_replay.message = "Actor set changed, recording discarded";
+            return;
+        }
+
+        auto t = std::time(nullptr);
+
+        std::tm tm;
+        localtime_s(std::addressof(tm), std::addressof(t));
+
+        char name[64];
+        std::strftime(name, sizeof(name), "%Y%m%d_%H%M%S.cbr", std::addressof(tm));
+
+        auto path = GetDriverConfig().paths.recordings / name;
+
+        ITaskPool::AddTask([=]()
+            {
+                except::descriptor error;
+
+                bool result = CBP::SimRecorder::Save(path, *recording, error);
+
+                IScopedLock _(GetLock());
+
+                auto& replay = m_Instance.m_replay;
+
+                if (result)
+                {
+                    replay.lastRecording = path;
+                    replay.message = "Saved " + path.filename().string();
+                }
+                else
+                {
+                    m_Instance.Error("%s: %s", __FUNCTION__, error.what());
+                    replay.message = error.what();
+                }
+            });
+    }
+
+    void DCBP::ReplayRecording()
+    {
+        auto& replay = m_Instance.m_replay;
+
+        if (replay.running)
+            return;
+
+        replay.running = true;
+        replay.message.clear();
+
+        ITaskPool::AddTask([path = replay.lastRecording]() mutable
+            {
+                except::descriptor error;
+
+                auto recording = std::make_unique<CBP::SimRecording>();
+                auto result = std::make_unique<CBP::replayResult_t>();
+
+                bool ok(false);
+
+                try
+                {
+                    // fall back to the newest file from a previous session
+                    if (path.empty())
+                    {
+                        auto& dir = GetDriverConfig().paths.recordings;
+
+                        if (fs::is_directory(dir))
+                        {
+                            for (auto& e : fs::directory_iterator(dir))
+                            {
+                                if (e.is_regular_file() && e.path().extension() == ".cbr" &&
+                                    (path.empty() || e.path().filename() > path.filename()))
+                                {
+                                    path = e.path();
+                                }
+                            }
+                        }
+
+                        if (path.empty())
+                            throw std::exception("no recordings found");
+                    }
+
+                    if (!CBP::SimRecorder::Load(path, *recording, error))
+                        throw std::exception(error.what());
+
+                    {
+                        // the replay drives the live actors, the game thread is blocked until it's done
+                        IScopedLock _(GetLock());
+
+                        if (!GetController()->Replay(*recording, *result))
+                            throw std::exception("recording doesn't match the loaded actors");
+                    }
+
+                    auto reportPath(path);
+                    reportPath += ".txt";
+
+                    if (!CBP::SimRecorder::SaveReport(reportPath, *recording, *result, error))
+                        throw std::exception(error.what());
+
+                    ok = true;
+                }
+                catch (const std::exception& e)
+                {
+                    error = e;
+                }
+
+                IScopedLock _(GetLock());
+
+                auto& replay = m_Instance.m_replay;
+
+                replay.running = false;
+
+                if (ok)
+                {
+                    replay.result = std::move(*result);
+                    replay.hasResult = true;
+                    replay.message = "Replayed " + path.filename().string();
+
+                    m_Instance.Message("Replay [%s]: %u frames, motion %lld us, collisions %lld us, %u mismatches (max error %g)",
+                        path.filename().string().c_str(),
+                        replay.result.numFrames,
+                        replay.result.motionTime,
+                        replay.result.collisionTime,
+                        replay.result.numStateMismatches,
+                        replay.result.maxStateError);
+                }
+                else
+                {
+                    m_Instance.Warning("Replay failed: %s", error.what());
+                    replay.message = error.what();
+                }
+            });
+    }
+
     void DCBP::BoneCastSample(Game::VMHandle a_handle, const stl::fixed_string& a_nodeName)
     {
         DTasks::SKSEAddTask([=, n = a_nodeName]() mutable
@@ -348,8 +516,17 @@ namespace CBP
 
 #if BT_THREADSAFE
         m_conf.multiThreadedCollisionDetection = GetConfigValue(CKEY_MTDISPATCHER, false);
-        m_conf.multiThreadedMotionUpdates = GetConfigValue(CKEY_MTMOTION, false);
 #endif
+        m_conf.multiThreadedMotionUpdates = GetConfigValue(CKEY_MTMOTION, false);
+        m_conf.multiThreadedMotionMinActors = std::max(GetConfigValue<UInt32>(CKEY_MTMOTIONMINACTORS, 8), 2U);
+        m_conf.motionThreads = std::min(GetConfigValue<UInt32>(CKEY_MOTIONTHREADS, 0), IThreadPool::MAX_THREADS);
+        m_conf.boneCastThreads = std::min(GetConfigValue<UInt32>(CKEY_BONECASTTHREADS, 1), IBoneCast::MAX_WORKERS);
+        m_conf.boneCastCodec = static_cast<BoneCastCodec>(std::min(
+            GetConfigValue<UInt32>(CKEY_BONECASTCODEC, 1),
+            UInt32(BoneCastCodec::Max) - 1));
+        m_conf.impulseQueueSize = std::clamp(
+            GetConfigValue<UInt32>(CKEY_IMPULSEQUEUESIZE, IImpulseBuffer::DEFAULT_SLOT_CAPACITY),
+            1U, IImpulseBuffer::MAX_SLOT_CAPACITY);
 
         m_conf.use_epa = GetConfigValue(CKEY_BTEPA, true);
         m_conf.useRelativeContactBreakingThreshold = GetConfigValue(CKEY_RELCBTHRESH, true);
@@ -366,9 +543,11 @@ namespace CBP
         if (m_conf.multiThreadedCollisionDetection)
             m_conf.taskpool_offload = false;
 
-        Message("MT collision detection: %d, MT motion: %d",
-            m_conf.multiThreadedCollisionDetection, m_conf.multiThreadedMotionUpdates);
+        Message("MT collision detection: %d", m_conf.multiThreadedCollisionDetection);
 #endif
+
+        Message("MT motion: %d (min. actors: %u)",
+            m_conf.multiThreadedMotionUpdates, m_conf.multiThreadedMotionMinActors);
     }
 
     bool DCBP::LoadPaths()
@@ -397,6 +576,7 @@ namespace CBP
             paths.templatePlugins = paths.root / PLUGIN_CBP_TEMP_PLUG_R;
             paths.colliderData = paths.root / PLUGIN_CBP_COLLIDER_DATA_R;
             paths.boneCastData = paths.root / PLUGIN_CBP_BONECAST_DATA_R;
+            paths.recordings = paths.root / PLUGIN_CBP_RECORDINGS_R;
 
             return true;
         }
@@ -558,6 +738,16 @@ namespace CBP
     {
         auto& driverConf = GetDriverConfig();
 
+        bool useThreadPool = driverConf.multiThreadedMotionUpdates;
+
+#if BT_THREADSAFE
+        // the MT dispatcher runs on the same workers
+        useThreadPool |= driverConf.multiThreadedCollisionDetection;
+#endif
+
+        if (useThreadPool)
+            IThreadPool::Initialize(driverConf.motionThreads);
+
         ICollision::Initialize(
 #if BT_THREADSAFE
             driverConf.multiThreadedCollisionDetection,
@@ -568,6 +758,11 @@ namespace CBP
             driverConf.maxCollisionAlgorithmPoolSize
         );
 
+        IBoneCast::LoadPack();
+        IBoneCast::StartWorkers(driverConf.boneCastThreads);
+
+        IImpulseBuffer::SetSlotCapacity(driverConf.impulseQueueSize);
+
         IConfig::Initialize();
 
         m_Instance.LoadProfiles();
@@ -661,7 +856,9 @@ namespace CBP
         m_Instance.m_controller.reset();
         m_Instance.m_uiContext.reset();
 
+        CBP::IBoneCast::StopWorkers();
         CBP::ICollision::Destroy();
+        CBP::IThreadPool::Destroy();
     }
 
     void DCBP::MessageHandler(Event, void* args)
@@ -3,6 +3,9 @@
 #include "CBP/Data.h"
 #include "CBP/Serialization.h"
 #include "CBP/ControllerInstruction.h"
+#include "CBP/SimRecorder.h"
+#include "CBP/ImpulseBuffer.h"
+#include "CBP/BoneCastContainer.h"
 
 #include "GUI/Tasks.h"
 #include "Input/Handlers.h"
@@ -123,7 +126,7 @@ namespace CBP
         static void DispatchActorTask(Actor* a_actor, CBP::ControllerInstruction::Action a_action);
         static void DispatchActorTask(Game::VMHandle handle, CBP::ControllerInstruction::Action action);
 
-        [[nodiscard]] static const auto& GetSimActorList();
+        [[nodiscard]] static const simActorList_t& GetSimActorList();
 
         [[nodiscard]] SKMP_FORCEINLINE static auto& GetSerializationInterface() {
             return m_Instance.m_serialization;
@@ -146,6 +149,18 @@ namespace CBP
         static void UpdateDebugRendererSettings();
         static void UpdateProfilerSettings();
         static void ApplyForce(Game::VMHandle a_handle, uint32_t a_steps, const stl::fixed_string& a_component, const btVector3& a_force);
+        static void ApplyForces(std::vector<CBP::impulseRequest_t>&& a_requests);
+
+        // caller must hold the lock
+        static void StartRecording();
+        static void StopRecording();
+        static void ReplayRecording();
+
+        [[nodiscard]] static const CBP::SimRecorder& GetRecorder();
+
+        [[nodiscard]] SKMP_FORCEINLINE static const auto& GetReplayStatus() {
+            return m_Instance.m_replay;
+        }
 
         static void BoneCastSample(Game::VMHandle a_handle, const stl::fixed_string& a_nodeName);
         static void BoneCastSample2(Game::VMHandle a_handle, const stl::fixed_string& a_nodeName);
@@ -300,8 +315,13 @@ namespace CBP
 
 #if BT_THREADSAFE
             bool multiThreadedCollisionDetection;
-            bool multiThreadedMotionUpdates;
 #endif
+            bool multiThreadedMotionUpdates;
+            std::uint32_t multiThreadedMotionMinActors;
+            std::uint32_t motionThreads;
+            std::uint32_t boneCastThreads;
+            CBP::BoneCastCodec boneCastCodec;
+            std::uint32_t impulseQueueSize;
 
             bool use_epa;
             bool useRelativeContactBreakingThreshold;
@@ -326,6 +346,7 @@ namespace CBP
                 fs::path templatePlugins;
                 fs::path colliderData;
                 fs::path boneCastData;
+                fs::path recordings;
                 //fs::path imguiSettings;
             } paths;
 
@@ -353,6 +374,15 @@ namespace CBP
         bool m_resetUI;
         std::atomic<bool> m_drEnabled;
 
+        struct
+        {
+            bool running{ false };
+            bool hasResult{ false };
+            CBP::replayResult_t result;
+            fs::path lastRecording;
+            std::string message;
+        } m_replay;
+
         static DCBP m_Instance;
     };
 
@@ -40,6 +40,9 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -48,6 +51,7 @@
 #include <algorithm>
 #include <regex>
 #include <bitset>
+#include <bit>
 #include <functional>
 #include <numbers>
 #include <queue>